@@ -36,12 +36,14 @@
 
 #include "samplv1_pshifter.h"
 
-#include "samplv1_config.h"
+#include "samplv1_ini.h"
 #include "samplv1_controls.h"
 #include "samplv1_programs.h"
+#include "samplv1_zones.h"
 #include "samplv1_tuning.h"
 
 #include "samplv1_sched.h"
+#include "samplv1_epoch.h"
 
 
 #ifdef CONFIG_DEBUG_0
@@ -49,6 +51,11 @@
 #endif
 
 #include <string.h>
+#include <sched.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
 
 
 //-------------------------------------------------------------------------
@@ -71,6 +78,10 @@ const float PITCH_SCALE   = 0.5f;
 
 const uint8_t MAX_DIRECT_NOTES = (MAX_VOICES >> 2);
 
+const uint32_t MAX_COMMANDS   = 256;	// command queue size (power of 2)
+
+const uint32_t MAX_MOD_FRAMES = 64;		// modulation bus block size
+
 
 // maximum helper
 
@@ -310,6 +321,29 @@ struct samplv1_env
 			return value;
 		}
 
+		// block render (closed form, same as tick() nframes times)
+		void render(float *out, uint32_t nframes)
+		{
+			uint32_t j = 0;
+
+			if (running && frames > 0) {
+				uint32_t nstage = frames;
+				if (nstage > nframes)
+					nstage = nframes;
+				const float phase0 = phase;
+				for ( ; j < nstage; ++j) {
+					const float phase1 = phase0 + float(j + 1) * delta;
+					out[j] = c1 * phase1 * (2.0f - phase1) + c0;
+				}
+				phase = phase0 + float(nstage) * delta;
+				value = out[nstage - 1];
+				frames -= nstage;
+			}
+
+			for ( ; j < nframes; ++j)
+				out[j] = value;
+		}
+
 		// state
 		bool running;
 		Stage stage;
@@ -841,6 +875,26 @@ struct samplv1_glide
 		return m_freq;
 	}
 
+	// block render (closed form, same as tick() nframes times)
+	void render(float *out, uint32_t nframes)
+	{
+		uint32_t j = 0;
+
+		if (m_frames > 0) {
+			uint32_t nglide = m_frames;
+			if (nglide > nframes)
+				nglide = nframes;
+			const float freq0 = m_freq;
+			for ( ; j < nglide; ++j)
+				out[j] = freq0 - float(j + 1) * m_step;
+			m_freq = freq0 - float(nglide) * m_step;
+			m_frames -= nglide;
+		}
+
+		for ( ; j < nframes; ++j)
+			out[j] = m_freq;
+	}
+
 private:
 
 	uint32_t m_frames;
@@ -942,6 +996,50 @@ private:
 };
 
 
+// modulation bus (per voice block buffers, shared by all voices)
+
+struct samplv1_mod
+{
+	// sources
+	float lfo1[MAX_MOD_FRAMES];
+	float lfo1_env[MAX_MOD_FRAMES];
+	float dcf1_env[MAX_MOD_FRAMES];
+	float dca1_env[MAX_MOD_FRAMES];
+	float dca1_pre[MAX_MOD_FRAMES];
+	float gen1_glide[MAX_MOD_FRAMES];
+
+	// ramps (per voice and global)
+	float out1_vol[MAX_MOD_FRAMES];
+	float out1_pan[2][MAX_MOD_FRAMES];
+	float vol1[MAX_MOD_FRAMES];
+	float pan1[2][MAX_MOD_FRAMES];
+	float wid1[MAX_MOD_FRAMES];
+
+	// destinations
+	float pitch[MAX_MOD_FRAMES];
+	float cutoff[MAX_MOD_FRAMES];
+	float reso[MAX_MOD_FRAMES];
+
+	// generator outputs (filtered in-place)
+	float gen1[MAX_MOD_FRAMES];
+	float gen2[MAX_MOD_FRAMES];
+
+	// voice outputs
+	float out1[MAX_MOD_FRAMES];
+	float out2[MAX_MOD_FRAMES];
+
+	// filters (per slope type)
+	template <typename F>
+	void filter(F& dcf1, F& dcf2, uint32_t nframes)
+	{
+		for (uint32_t j = 0; j < nframes; ++j) {
+			gen1[j] = dcf1.output(gen1[j], cutoff[j], reso[j]);
+			gen2[j] = dcf2.output(gen2[j], cutoff[j], reso[j]);
+		}
+	}
+};
+
+
 // forward decl.
 
 class samplv1_impl;
@@ -968,7 +1066,7 @@ struct samplv1_voice : public samplv1_list<samplv1_voice>
 	samplv1_filter1 dcf11, dcf12;				// filters
 	samplv1_filter2 dcf13, dcf14;
 	samplv1_filter3 dcf15, dcf16;
-	samplv1_formant dcf17, dcf18;
+	samplv1_formant2 dcf17;
 
 	samplv1_env::State dca1_env;				// envelope states
 	samplv1_env::State dcf1_env;
@@ -988,6 +1086,81 @@ struct samplv1_voice : public samplv1_list<samplv1_voice>
 };
 
 
+// UI/worker to audio thread command queue (bounded, lock-free;
+// many producers, one wait-free consumer: the audio thread).
+
+class samplv1_cmd_queue
+{
+public:
+
+	enum Type { ParamValue = 0, SampleUpdate, NoteOn, NoteOff };
+
+	struct Command
+	{
+		Command() : type(0), note(0), vel(0), index(0) {}
+
+		uint8_t  type;
+		uint8_t  note;
+		uint8_t  vel;
+		uint16_t index;
+	};
+
+	samplv1_cmd_queue() : m_write(0), m_read(0)
+	{
+		for (uint32_t i = 0; i < MAX_COMMANDS; ++i)
+			m_slots[i].seq.store(i, std::memory_order_relaxed);
+	}
+
+	// producer side (any non real-time thread).
+	bool push(const Command& cmd)
+	{
+		uint32_t w = m_write.load(std::memory_order_relaxed);
+		for (;;) {
+			Slot& slot = m_slots[w & (MAX_COMMANDS - 1)];
+			const uint32_t seq = slot.seq.load(std::memory_order_acquire);
+			const int32_t diff = int32_t(seq - w);
+			if (diff == 0) {
+				if (m_write.compare_exchange_weak(w, w + 1,
+						std::memory_order_relaxed)) {
+					slot.cmd = cmd;
+					slot.seq.store(w + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false; // full.
+			else
+				w = m_write.load(std::memory_order_relaxed);
+		}
+	}
+
+	// consumer side (audio thread only).
+	bool pop(Command& cmd)
+	{
+		Slot& slot = m_slots[m_read & (MAX_COMMANDS - 1)];
+		if (slot.seq.load(std::memory_order_acquire) != m_read + 1)
+			return false; // empty (or not yet published).
+		cmd = slot.cmd;
+		slot.seq.store(m_read + MAX_COMMANDS, std::memory_order_release);
+		++m_read;
+		return true;
+	}
+
+private:
+
+	struct Slot
+	{
+		std::atomic<uint32_t> seq;
+		Command cmd;
+	};
+
+	Slot m_slots[MAX_COMMANDS];
+
+	std::atomic<uint32_t> m_write;
+	uint32_t m_read;
+};
+
+
 // MIDI input asynchronous status notification
 
 class samplv1_midi_in : public samplv1_sched
@@ -1030,11 +1203,11 @@ public:
 
 	samplv1_tun() : enabled(false), refPitch(440.0f), refNote(69) {}
 
-	bool    enabled;
-	float   refPitch;
-	int     refNote;
-	QString scaleFile;
-	QString keyMapFile;
+	bool        enabled;
+	float       refPitch;
+	int         refNote;
+	std::string scaleFile;
+	std::string keyMapFile;
 };
 
 
@@ -1058,6 +1231,8 @@ public:
 	const char *sampleFile() const;
 	uint16_t octaves() const;
 
+	void setSample(samplv1_sample *sample);
+
 	void setBufferSize(uint32_t nsize);
 	uint32_t bufferSize() const;
 
@@ -1070,10 +1245,15 @@ public:
 	void setParamValue(samplv1::ParamIndex index, float fValue);
 	float paramValue(samplv1::ParamIndex index);
 
+	void queueParamValue(samplv1::ParamIndex index, float fValue);
+
 	void updateEnvTimes();
 
 	samplv1_controls *controls();
 	samplv1_programs *programs();
+	samplv1_zones *zones();
+
+	samplv1_epoch *epoch();
 
 	void setTuningEnabled(bool enabled);
 	bool isTuningEnabled() const;
@@ -1109,6 +1289,12 @@ public:
 	void sampleLoopSync();
 	void sampleLoopRangeSync();
 
+	void sampleUpdate();
+	void sampleUpdateSync();
+
+	samplv1_sample *sampleEdit();
+	samplv1_sample *sampleView();
+
 	void midiInEnabled(bool on);
 	uint32_t midiInCount();
 
@@ -1116,7 +1302,8 @@ public:
 
 	bool running(bool on);
 
-	samplv1_sample  gen1_sample;
+	samplv1_sample  gen1_sample0;
+	samplv1_sample *gen1_sample;
 	samplv1_wave_lf lfo1_wave;
 
 	float gen1_last;
@@ -1130,6 +1317,19 @@ protected:
 	void allNotesOff();
 	void allSustainOff();
 
+	void applyPreload(samplv1_programs::Preload *preload);
+
+	void sampleDetach();
+
+	void zonesSync();
+
+	void tuningPublish(const float *freqs);
+	void tuningSync();
+
+	void process_commands();
+
+	void directNotesOff();
+
 	float get_bpm ( float bpm ) const
 		{ return (bpm > 0.0f ? bpm : m_bpm); }
 
@@ -1158,9 +1358,12 @@ protected:
 
 private:
 
-	samplv1_config   m_config;
+	samplv1_epoch    m_epoch;
+
+	samplv1_ini     *m_ini;
 	samplv1_controls m_controls;
 	samplv1_programs m_programs;
+	samplv1_zones    m_zones;
 	samplv1_midi_in  m_midi_in;
 	samplv1_tun      m_tun;
 
@@ -1170,8 +1373,17 @@ private:
 
 	float    m_freqs[MAX_NOTES];
 
+	// off-thread prepared tuning table (swapped in at cycle start)...
+	enum { TuningIdle = 0, TuningReady, TuningBusy };
+
+	float    m_freqs1[MAX_NOTES];
+	std::atomic<int> m_freqs1_state;
+	std::mutex m_freqs1_mutex;
+
 	samplv1_ctl m_ctl1;
 
+	samplv1_mod m_mod;
+
 	samplv1_gen m_gen1;
 	samplv1_dcf m_dcf1;
 	samplv1_lfo m_lfo1;
@@ -1210,12 +1422,31 @@ private:
 
 	samplv1_reverb m_reverb;
 
-	// process direct note on/off...
-	volatile uint16_t m_direct_note;
+	// effects enabled on the last cycle (audio thread)...
+	bool m_cho_enabled;
+	bool m_fla_enabled;
+	bool m_pha_enabled;
+	bool m_del_enabled;
+	bool m_rev_enabled;
+	bool m_fxs_enabled;
+
+	// queued commands (coalesced param values and sample updates)...
+	samplv1_cmd_queue m_commands;
+
+	std::atomic<float> m_params_value[samplv1::NUM_PARAMS];
+	std::atomic<bool>  m_params_dirty[samplv1::NUM_PARAMS];
 
-	struct direct_note {
-		uint8_t status, note, vel;
-	} m_direct_notes[MAX_DIRECT_NOTES];
+	std::atomic<bool>  m_sample_dirty;
+	std::atomic<bool>  m_commands_resync;
+
+	// copy-on-edit of a shared (preloaded program) sample...
+	std::atomic<samplv1_sample *> m_sample_detach;
+	std::mutex m_sample_mutex;
+
+	// direct note on/off (audio thread bookkeeping)...
+	bool m_direct_keys[MAX_NOTES];
+
+	std::atomic<bool>  m_direct_notes_off;
 
 	volatile int  m_nvoices;
 
@@ -1229,12 +1460,11 @@ samplv1_voice::samplv1_voice ( samplv1_impl *pImpl ) :
 	note(-1),
 	vel(0.0f),
 	pre(0.0f),
-	gen1(&pImpl->gen1_sample),
+	gen1(pImpl->gen1_sample),
 	lfo1(&pImpl->lfo1_wave),
 	gen1_freq(0.0f),
 	lfo1_sample(0.0f),
 	dcf17(&pImpl->dcf1_formant),
-	dcf18(&pImpl->dcf1_formant),
 	gen1_glide(pImpl->gen1_last),
 	sustain(false)
 {
@@ -1245,8 +1475,8 @@ samplv1_voice::samplv1_voice ( samplv1_impl *pImpl ) :
 
 samplv1_impl::samplv1_impl (
 	samplv1 *pSampl, uint16_t nchannels, float srate )
-		: gen1_sample(srate), m_controls(pSampl), m_programs(pSampl),
-			m_midi_in(pSampl), m_bpm(180.0f), m_gen1(pSampl),
+		: gen1_sample0(srate, &m_epoch), gen1_sample(&gen1_sample0),
+			m_controls(pSampl), m_programs(pSampl), m_zones(srate, &m_epoch), m_midi_in(pSampl), m_bpm(180.0f), m_gen1(pSampl),
 			m_nvoices(0), m_running(false)
 {
 	// null sample.
@@ -1266,8 +1496,32 @@ samplv1_impl::samplv1_impl (
 		m_free_list.append(m_voices[i]);
 	}
 
-	for (int note = 0; note < MAX_NOTES; ++note)
+	for (int note = 0; note < MAX_NOTES; ++note) {
 		m_notes[note] = nullptr;
+		m_direct_keys[note] = false;
+	}
+
+	// queued commands none yet
+	for (int i = 0; i < samplv1::NUM_PARAMS; ++i) {
+		m_params_value[i].store(0.0f);
+		m_params_dirty[i].store(false);
+	}
+
+	m_sample_dirty.store(false);
+	m_commands_resync.store(false);
+	m_sample_detach.store(nullptr);
+
+	// no prepared tuning yet
+	m_freqs1_state.store(TuningIdle);
+
+	// effects all off, as far as the audio thread knows
+	m_cho_enabled = false;
+	m_fla_enabled = false;
+	m_pha_enabled = false;
+	m_del_enabled = false;
+	m_rev_enabled = false;
+	m_fxs_enabled = false;
+	m_direct_notes_off.store(false);
 
 	// local buffers none yet
 	m_sfxs = nullptr;
@@ -1285,16 +1539,29 @@ samplv1_impl::samplv1_impl (
 	// compressors none yet
 	m_comp = nullptr;
 
+	// Default settings (shared read-only snapshot)...
+	m_ini = samplv1_ini::acquire();
+
 	// Pitch-shifting support...
 	samplv1_pshifter::setDefaultType(
-		samplv1_pshifter::Type(m_config.iPitchShiftType));
+		samplv1_pshifter::Type(m_ini->iPitchShiftType));
+
+	// Pitch-shifting FFT wisdom (persisted along the configuration)...
+	const std::string& sWisdomFile = m_ini->filePath(SAMPLV1_TITLE ".fftw");
+	samplv1_pshifter::setWisdomFile(sWisdomFile.c_str());
+
+	// Sample interpolation mode...
+	samplv1_sample::setDefaultInterp(
+		samplv1_sample::Interp(m_ini->iSampleInterpType));
+	samplv1_sample::setDefaultStorage(
+		samplv1_sample::Storage(m_ini->iSampleStorageType));
 
 	// Micro-tuning support, if any...
 	resetTuning();
 
 	// load controllers & programs database...
-	m_config.loadControls(&m_controls);
-	m_config.loadPrograms(&m_programs);
+	m_ini->loadControls(&m_controls);
+	m_ini->loadPrograms(&m_programs);
 
 	// number of channels
 	setChannels(nchannels);
@@ -1314,11 +1581,8 @@ samplv1_impl::samplv1_impl (
 
 samplv1_impl::~samplv1_impl (void)
 {
-#if 0
-	// DO NOT save programs database here:
-	// prevent multi-instance clash...
-	m_config.savePrograms(&m_programs);
-#endif
+	// nb. programs database is never saved here:
+	// prevent multi-instance clash (read-only settings)...
 
 	// deallocate sample filenames
 	setSampleFile(nullptr, 0);
@@ -1334,6 +1598,9 @@ samplv1_impl::~samplv1_impl (void)
 
 	// deallocate channels
 	setChannels(0);
+
+	// release settings snapshot
+	samplv1_ini::release(m_ini);
 }
 
 
@@ -1379,7 +1646,10 @@ void samplv1_impl::setSampleRate ( float srate )
 	m_srate = srate;
 
 	// update waves sample rate
-	gen1_sample.setSampleRate(m_srate);
+	gen1_sample0.setSampleRate(m_srate);
+	gen1_sample->setSampleRate(m_srate);
+	m_programs.setSampleRate(m_srate);
+	m_zones.setSampleRate(m_srate);
 	lfo1_wave.setSampleRate(m_srate);
 
 	updateEnvTimes();
@@ -1448,7 +1718,7 @@ void samplv1_impl::updateEnvTimes (void)
 	float envtime_msecs = 10000.0f * m_gen1.envtime0;
 	if (envtime_msecs < MIN_ENV_MSECS) {
 		const uint32_t envtime_frames
-			= (gen1_sample.offsetEnd() - gen1_sample.offsetStart()) >> 1;
+			= (gen1_sample->offsetEnd() - gen1_sample->offsetStart()) >> 1;
 		envtime_msecs = envtime_frames / srate_ms;
 	}
 	if (envtime_msecs < MIN_ENV_MSECS)
@@ -1476,26 +1746,47 @@ void samplv1_impl::setSampleFile ( const char *pszSampleFile, uint16_t otabs )
 {
 	reset();
 
+	std::lock_guard<std::mutex> lock(m_sample_mutex);
+
+	// detach from any preloaded program (or restored) sample...
+	m_sample_detach.store(nullptr);
+	gen1_sample = &gen1_sample0;
+
 	if (pszSampleFile) {
 		m_gen1.sample0 = *m_gen1.sample;
-		gen1_sample.open(pszSampleFile, samplv1_freq(m_gen1.sample0), otabs);
+		gen1_sample->open(pszSampleFile, samplv1_freq(m_gen1.sample0), otabs);
 	} else {
-		gen1_sample.close();
+		gen1_sample->close();
 	}
 
 	updateEnvTimes();
 }
 
 
+// ready-made sample swap (audio thread)
+
+void samplv1_impl::setSample ( samplv1_sample *sample )
+{
+	allNotesOff();
+
+	gen1_sample = (sample ? sample : &gen1_sample0);
+
+	m_gen1.sample0 = *m_gen1.sample;
+	gen1_sample->reset(samplv1_freq(m_gen1.sample0));
+
+	sampleUpdateSync();
+}
+
+
 const char *samplv1_impl::sampleFile (void) const
 {
-	return gen1_sample.filename();
+	return gen1_sample->filename();
 }
 
 
 uint16_t samplv1_impl::octaves (void) const
 {
-	return gen1_sample.otabs();
+	return gen1_sample->otabs();
 }
 
 
@@ -1641,11 +1932,39 @@ void samplv1_impl::setParamValue ( samplv1::ParamIndex index, float fValue )
 
 float samplv1_impl::paramValue ( samplv1::ParamIndex index )
 {
+	if (index >= 0 && index < samplv1::NUM_PARAMS
+		&& m_params_dirty[index].load(std::memory_order_acquire))
+		return m_params_value[index].load(std::memory_order_relaxed);
+
 	samplv1_port *pParamPort = paramPort(index);
 	return (pParamPort ? pParamPort->value() : 0.0f);
 }
 
 
+// parameter value change, deferred to the audio thread (coalesced).
+void samplv1_impl::queueParamValue ( samplv1::ParamIndex index, float fValue )
+{
+	if (index < 0 || index >= samplv1::NUM_PARAMS)
+		return;
+
+	if (!m_running) {
+		m_params_dirty[index].store(false, std::memory_order_release);
+		setParamValue(index, fValue);
+		return;
+	}
+
+	m_params_value[index].store(fValue, std::memory_order_relaxed);
+
+	if (!m_params_dirty[index].exchange(true, std::memory_order_acq_rel)) {
+		samplv1_cmd_queue::Command cmd;
+		cmd.type  = samplv1_cmd_queue::ParamValue;
+		cmd.index = uint16_t(index);
+		if (!m_commands.push(cmd))
+			m_commands_resync.store(true, std::memory_order_release);
+	}
+}
+
+
 // handle midi input
 
 void samplv1_impl::process_midi ( uint8_t *data, uint32_t size )
@@ -1745,7 +2064,12 @@ void samplv1_impl::process_midi ( uint8_t *data, uint32_t size )
 					= *m_gen1.octave * OCTAVE_SCALE
 					+ *m_gen1.tuning * TUNING_SCALE;
 				pv->gen1_freq = m_freqs[key] * samplv1_freq2(gen1_tuning);
-				// generator
+				// generator (key/velocity zone sample, if any)
+				samplv1_sample *sample = m_zones.find(key, value);
+				if (sample == nullptr)
+					sample = gen1_sample;
+				if (pv->gen1.sample() != sample)
+					pv->gen1.reset(sample);
 				pv->gen1.start(pv->gen1_freq);
 				// filters
 				const int dcf1_type = int(*m_dcf1.type);
@@ -1759,7 +2083,6 @@ void samplv1_impl::process_midi ( uint8_t *data, uint32_t size )
 				const float dcf1_cutoff = *m_dcf1.cutoff;
 				const float dcf1_reso = *m_dcf1.reso;
 				pv->dcf17.reset_filters(dcf1_cutoff, dcf1_reso);
-				pv->dcf18.reset_filters(dcf1_cutoff, dcf1_reso);
 				// envelopes
 				if (*m_dcf1.enabled > 0.0f)
 					m_dcf1.env.start(&pv->dcf1_env);
@@ -1773,7 +2096,7 @@ void samplv1_impl::process_midi ( uint8_t *data, uint32_t size )
 					m_dca1.env.start(&pv->dca1_env);
 				else
 					m_dca1.env.idle(&pv->dca1_env);
-				if (gen1_sample.isLoop())
+				if (sample->isLoop())
 					pv->gen1.setLoop(*m_dca1.enabled > 0.0f);
 				// lfos
 				const float lfo1_pshift
@@ -1945,7 +2268,8 @@ void samplv1_impl::allNotesOff (void)
 
 	m_lfo1.psync = nullptr;
 
-	m_direct_note = 0;
+	for (int note = 0; note < MAX_NOTES; ++note)
+		m_direct_keys[note] = false;
 }
 
 
@@ -1971,21 +2295,41 @@ void samplv1_impl::allSustainOff (void)
 }
 
 
-// direct note-on triggered on next cycle...
+// direct note-on/off triggered on next cycle...
 void samplv1_impl::directNoteOn ( int note, int vel )
 {
+	if (!m_running || note < 0 || note >= MAX_NOTES)
+		return;
+
 	if (vel > 0 && m_nvoices >= MAX_DIRECT_NOTES)
 		return;
 
-	const uint32_t i = m_direct_note;
-	if (i < MAX_DIRECT_NOTES) {
-		const int ch1 = int(*m_def.channel);
-		const int chan = (ch1 > 0 ? ch1 - 1 : 0) & 0x0f;
-		direct_note& data = m_direct_notes[i];
-		data.status = (vel > 0 ? 0x90 : 0x80) | chan;
-		data.note = note;
-		data.vel = vel;
-		++m_direct_note;
+	samplv1_cmd_queue::Command cmd;
+	cmd.type = (vel > 0 ? samplv1_cmd_queue::NoteOn : samplv1_cmd_queue::NoteOff);
+	cmd.note = uint8_t(note);
+	cmd.vel  = uint8_t(vel);
+
+	// a note-off must never get lost: release them all instead...
+	if (!m_commands.push(cmd) && vel == 0)
+		m_direct_notes_off.store(true, std::memory_order_release);
+}
+
+
+// direct notes release (audio thread).
+void samplv1_impl::directNotesOff (void)
+{
+	const int ch1 = int(*m_def.channel);
+	const int chan = (ch1 > 0 ? ch1 - 1 : 0) & 0x0f;
+
+	for (int note = 0; note < MAX_NOTES; ++note) {
+		if (m_direct_keys[note]) {
+			uint8_t data[3];
+			data[0] = 0x80 | chan;
+			data[1] = uint8_t(note);
+			data[2] = 0;
+			process_midi(data, sizeof(data));
+			m_direct_keys[note] = false;
+		}
 	}
 }
 
@@ -2006,6 +2350,22 @@ samplv1_programs *samplv1_impl::programs (void)
 }
 
 
+// key/velocity zones accessor
+
+samplv1_zones *samplv1_impl::zones (void)
+{
+	return &m_zones;
+}
+
+
+// audio cycle counter (deferred reclamation).
+
+samplv1_epoch *samplv1_impl::epoch (void)
+{
+	return &m_epoch;
+}
+
+
 // Micro-tuning support
 
 void samplv1_impl::setTuningEnabled ( bool enabled )
@@ -2043,61 +2403,97 @@ int samplv1_impl::tuningRefNote (void) const
 
 void samplv1_impl::setTuningScaleFile ( const char *pszScaleFile )
 {
-	m_tun.scaleFile = QString::fromUtf8(pszScaleFile);
+	m_tun.scaleFile = (pszScaleFile ? pszScaleFile : "");
 }
 
 const char *samplv1_impl::tuningScaleFile (void) const
 {
-	return m_tun.scaleFile.toUtf8().constData();
+	return m_tun.scaleFile.c_str();
 }
 
 
 void samplv1_impl::setTuningKeyMapFile ( const char *pszKeyMapFile )
 {
-	m_tun.keyMapFile = QString::fromUtf8(pszKeyMapFile);
+	m_tun.keyMapFile = (pszKeyMapFile ? pszKeyMapFile : "");
 }
 
 const char *samplv1_impl::tuningKeyMapFile (void) const
 {
-	return m_tun.keyMapFile.toUtf8().constData();
+	return m_tun.keyMapFile.c_str();
 }
 
 
 void samplv1_impl::resetTuning (void)
 {
+	// Prepared right here, off the audio thread...
+	float freqs[MAX_NOTES];
+
 	if (m_tun.enabled) {
 		// Instance micro-tuning, possibly from Scala keymap and scale files...
 		samplv1_tuning tuning(
 			m_tun.refPitch,
 			m_tun.refNote);
-		if (m_tun.keyMapFile.isEmpty())
-		if (!m_tun.keyMapFile.isEmpty())
+		if (!m_tun.keyMapFile.empty())
 			tuning.loadKeyMapFile(m_tun.keyMapFile);
-		if (!m_tun.scaleFile.isEmpty())
+		if (!m_tun.scaleFile.empty())
 			tuning.loadScaleFile(m_tun.scaleFile);
 		for (int note = 0; note < MAX_NOTES; ++note)
-			m_freqs[note] = tuning.noteToPitch(note);
+			freqs[note] = tuning.noteToPitch(note);
 		// Done instance tuning.
+		tuningPublish(freqs);
+		return;
 	}
-	else
-	if (m_config.bTuningEnabled) {
+
+	// Global/config settings, as last saved (refresh snapshot)...
+	samplv1_ini *ini = samplv1_ini::acquire();
+	samplv1_ini::release(m_ini);
+	m_ini = ini;
+
+	if (ini->bTuningEnabled) {
 		// Global/config micro-tuning, possibly from Scala keymap and scale files...
 		samplv1_tuning tuning(
-			m_config.fTuningRefPitch,
-			m_config.iTuningRefNote);
-		if (!m_config.sTuningKeyMapFile.isEmpty())
-			tuning.loadKeyMapFile(m_config.sTuningKeyMapFile);
-		if (!m_config.sTuningScaleFile.isEmpty())
-			tuning.loadScaleFile(m_config.sTuningScaleFile);
+			ini->fTuningRefPitch,
+			ini->iTuningRefNote);
+		if (!ini->sTuningKeyMapFile.empty())
+			tuning.loadKeyMapFile(ini->sTuningKeyMapFile);
+		if (!ini->sTuningScaleFile.empty())
+			tuning.loadScaleFile(ini->sTuningScaleFile);
 		for (int note = 0; note < MAX_NOTES; ++note)
-			m_freqs[note] = tuning.noteToPitch(note);
+			freqs[note] = tuning.noteToPitch(note);
 		// Done global/config tuning.
 	} else {
 		// Native/default tuning, 12-tone equal temperament western standard...
 		for (int note = 0; note < MAX_NOTES; ++note)
-			m_freqs[note] = samplv1_freq(note);
+			freqs[note] = samplv1_freq(note);
 		// Done native/default tuning.
 	}
+
+	tuningPublish(freqs);
+}
+
+
+// prepared tuning hand-over (non real-time)
+
+void samplv1_impl::tuningPublish ( const float *freqs )
+{
+	std::lock_guard<std::mutex> lock(m_freqs1_mutex);
+
+	// wait while the audio thread might be copying the former one...
+	for (;;) {
+		int state = m_freqs1_state.load(std::memory_order_acquire);
+		if (state != TuningBusy && m_freqs1_state.compare_exchange_weak(
+				state, TuningBusy, std::memory_order_acq_rel))
+			break;
+		::sched_yield();
+	}
+
+	::memcpy(m_freqs1, freqs, MAX_NOTES * sizeof(float));
+
+	m_freqs1_state.store(TuningReady, std::memory_order_release);
+
+	// not running? apply it right away...
+	if (!m_running)
+		tuningSync();
 }
 
 
@@ -2155,6 +2551,154 @@ void samplv1_impl::reset (void)
 }
 
 
+// preloaded program change (audio thread)
+
+void samplv1_impl::applyPreload ( samplv1_programs::Preload *preload )
+{
+	allNotesOff();
+
+	// swap in the ready-made sample tables...
+	if (preload->sample)
+		gen1_sample = preload->sample;
+
+	const samplv1_param::Preset& preset = preload->preset;
+	for (int i = 0; i < samplv1::NUM_PARAMS; ++i) {
+		if (preset.paramsSet[i])
+			setParamValue(samplv1::ParamIndex(i), preset.params[i]);
+	}
+
+	stabilize();
+
+	m_gen1.sample0 = *m_gen1.sample;
+	gen1_sample->reset(samplv1_freq(m_gen1.sample0));
+
+	updateEnvTimes();
+
+	// tuning and notifications are left to the worker...
+	m_programs.preload_applied(preload);
+}
+
+
+// copy-on-edit swap (audio thread)
+
+void samplv1_impl::sampleDetach (void)
+{
+	samplv1_sample *sample = m_sample_detach.load(std::memory_order_acquire);
+	if (sample == nullptr)
+		return;
+
+	// still current? (otherwise it's stale, a program change took over)
+	if (sample == gen1_sample) {
+		// playing voices go on with the very same tables, privately owned...
+		samplv1_voice *pv = m_play_list.next();
+		while (pv) {
+			if (pv->gen1.sample() == sample)
+				pv->gen1.rebind(&gen1_sample0);
+			pv = pv->next();
+		}
+		gen1_sample = &gen1_sample0;
+	}
+
+	// done; ready for the next edit...
+	m_sample_detach.store(nullptr, std::memory_order_release);
+}
+
+
+// key/velocity zone map changes (audio thread)
+
+void samplv1_impl::zonesSync (void)
+{
+	const uint32_t serial = m_zones.serial();
+	if (m_zones.isAcknowledged(serial))
+		return;
+
+	// stop voices still playing retired zone samples...
+	samplv1_voice *pv = m_play_list.next();
+	while (pv) {
+		samplv1_voice *pv_next = pv->next();
+		const samplv1_sample *sample = pv->gen1.sample();
+		if (sample != gen1_sample && !m_zones.contains(sample)) {
+			if (pv->note >= 0 && m_notes[pv->note] == pv)
+				m_notes[pv->note] = nullptr;
+			free_voice(pv);
+		}
+		pv = pv_next;
+	}
+
+	// old maps are out of sight now, retired samples may go...
+	m_zones.acknowledge(serial);
+}
+
+
+// prepared tuning swap (audio thread)
+
+void samplv1_impl::tuningSync (void)
+{
+	int state = TuningReady;
+	if (!m_freqs1_state.compare_exchange_strong(
+			state, TuningBusy, std::memory_order_acq_rel))
+		return;
+
+	::memcpy(m_freqs, m_freqs1, MAX_NOTES * sizeof(float));
+
+	m_freqs1_state.store(TuningIdle, std::memory_order_release);
+}
+
+
+// queued commands (audio thread, at the start of each cycle)
+
+void samplv1_impl::process_commands (void)
+{
+	samplv1_cmd_queue::Command cmd;
+
+	while (m_commands.pop(cmd)) {
+		switch (cmd.type) {
+		case samplv1_cmd_queue::ParamValue: {
+			const samplv1::ParamIndex index = samplv1::ParamIndex(cmd.index);
+			if (m_params_dirty[index].exchange(false, std::memory_order_acq_rel))
+				setParamValue(index,
+					m_params_value[index].load(std::memory_order_relaxed));
+			break;
+		}
+		case samplv1_cmd_queue::SampleUpdate:
+			if (m_sample_dirty.exchange(false, std::memory_order_acq_rel))
+				sampleUpdateSync();
+			break;
+		case samplv1_cmd_queue::NoteOn:
+		case samplv1_cmd_queue::NoteOff: {
+			const bool on = (cmd.type == samplv1_cmd_queue::NoteOn);
+			const int ch1 = int(*m_def.channel);
+			const int chan = (ch1 > 0 ? ch1 - 1 : 0) & 0x0f;
+			uint8_t data[3];
+			data[0] = (on ? 0x90 : 0x80) | chan;
+			data[1] = cmd.note;
+			data[2] = cmd.vel;
+			process_midi(data, sizeof(data));
+			m_direct_keys[cmd.note] = on;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// queue overflow fallback: catch up on everything pending...
+	if (m_commands_resync.exchange(false, std::memory_order_acq_rel)) {
+		for (int i = 0; i < samplv1::NUM_PARAMS; ++i) {
+			const samplv1::ParamIndex index = samplv1::ParamIndex(i);
+			if (m_params_dirty[i].exchange(false, std::memory_order_acq_rel))
+				setParamValue(index,
+					m_params_value[i].load(std::memory_order_relaxed));
+		}
+		if (m_sample_dirty.exchange(false, std::memory_order_acq_rel))
+			sampleUpdateSync();
+	}
+
+	if (m_direct_notes_off.exchange(false, std::memory_order_acq_rel))
+		directNotesOff();
+}
+
+
 // MIDI input asynchronous status notification accessors
 
 void samplv1_impl::midiInEnabled ( bool on )
@@ -2173,6 +2717,8 @@ uint32_t samplv1_impl::midiInCount (void)
 
 void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 {
+	m_epoch.tick();
+
 	if (!m_running) return;
 
 	float *v_outs[m_nchannels];
@@ -2183,22 +2729,70 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 
 	uint16_t k;
 
+	// effects (per effect enable, dry ones cost nothing)
+
+	const float fxsend1 = *m_out1.fxsend * *m_out1.fxsend;
+
+	const bool cho_enabled = (m_nchannels > 1 && *m_cho.wet > 0.0f);
+	const bool fla_enabled = (*m_fla.wet > 0.0f);
+	const bool pha_enabled = (*m_pha.wet > 0.0f);
+	const bool del_enabled = (*m_del.wet > 0.0f);
+	const bool rev_enabled = (m_nchannels > 1 && *m_rev.wet > 0.0f);
+
+	// fx-send bus is silent when nothing is sent nor wet
+	const bool fxs_enabled = (fxsend1 > 0.0f
+		|| cho_enabled || fla_enabled || pha_enabled
+		|| del_enabled || rev_enabled);
+
+	// skipped effects kept stale state; start over when back on...
+	if (cho_enabled && !m_cho_enabled)
+		m_chorus.reset();
 	for (k = 0; k < m_nchannels; ++k) {
-		::memset(m_sfxs[k], 0, nframes * sizeof(float));
-		::memcpy(outs[k], ins[k], nframes * sizeof(float));
+		if (fla_enabled && !m_fla_enabled)
+			m_flanger[k].reset();
+		if (pha_enabled && !m_pha_enabled)
+			m_phaser[k].reset();
+		if (del_enabled && !m_del_enabled)
+			m_delay[k].reset();
+		if (fxs_enabled && !m_fxs_enabled)
+			m_comp[k].reset();
 	}
+	if (rev_enabled && !m_rev_enabled)
+		m_reverb.reset();
+
+	m_cho_enabled = cho_enabled;
+	m_fla_enabled = fla_enabled;
+	m_pha_enabled = pha_enabled;
+	m_del_enabled = del_enabled;
+	m_rev_enabled = rev_enabled;
+	m_fxs_enabled = fxs_enabled;
 
-	// process direct note on/off...
-	while (m_direct_note > 0) {
-		const direct_note& data
-			= m_direct_notes[--m_direct_note];
-		process_midi((uint8_t *) &data, sizeof(data));
+	for (k = 0; k < m_nchannels; ++k) {
+		if (fxs_enabled)
+			::memset(m_sfxs[k], 0, nframes * sizeof(float));
+		::memcpy(outs[k], ins[k], nframes * sizeof(float));
 	}
 
+	// process preloaded program change...
+	samplv1_programs::Preload *preload = m_programs.preload_pending();
+	if (preload)
+		applyPreload(preload);
+
+	// process copy-on-edit sample swap...
+	sampleDetach();
+
+	// process key/velocity zone map changes...
+	zonesSync();
+
+	// process prepared tuning changes...
+	tuningSync();
+
+	// process queued commands (param values, sample points, direct notes)...
+	process_commands();
+
 	// channel indexes
 
 	const uint16_t k11 = 0;
-	const uint16_t k12 = (gen1_sample.channels() > 1 ? 1 : 0);
 
 	// controls
 
@@ -2212,11 +2806,9 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 
 	const bool dcf1_enabled = (*m_dcf1.enabled > 0.0f);
 
-	const float fxsend1 = *m_out1.fxsend * *m_out1.fxsend;
-
 	if (m_gen1.sample0 != *m_gen1.sample) {
 		m_gen1.sample0  = *m_gen1.sample;
-		gen1_sample.reset(samplv1_freq(m_gen1.sample0));
+		gen1_sample->reset(samplv1_freq(m_gen1.sample0));
 	}
 
 	if (m_gen1.envtime0 != *m_gen1.envtime) {
@@ -2237,6 +2829,11 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 
 		samplv1_voice *pv_next = pv->next();
 
+		// channel indexes (per voice sample)
+
+		const samplv1_sample *gen1_sample1 = pv->gen1.sample();
+		const uint16_t k12 = (gen1_sample1->channels() > 1 ? 1 : 0);
+
 		// output buffers
 
 		for (k = 0; k < m_nchannels; ++k) {
@@ -2245,11 +2842,17 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 		}
 
 		uint32_t nblock = nframes;
+		uint32_t noffset = 0;
 
 		while (nblock > 0) {
 
 			uint32_t ngen = nblock;
 
+			// modulation bus block size
+
+			if (ngen > MAX_MOD_FRAMES)
+				ngen = MAX_MOD_FRAMES;
+
 			// process envelope stages
 
 			if (pv->dca1_env.running && pv->dca1_env.frames < ngen)
@@ -2259,94 +2862,131 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 			if (pv->lfo1_env.running && pv->lfo1_env.frames < ngen)
 				ngen = pv->lfo1_env.frames;
 
-			for (uint32_t j = 0; j < ngen; ++j) {
-
-				// velocities
+			uint32_t j;
 
-				const float vel1
-					= (pv->vel + (1.0f - pv->vel) * pv->dca1_pre.value(j));
+			// modulation sources
 
-				// generators
+			pv->dca1_env.render(m_mod.dca1_env, ngen);
+			pv->dca1_pre.render(m_mod.dca1_pre, 0, ngen);
+			pv->gen1_glide.render(m_mod.gen1_glide, ngen);
 
-				const float lfo1_env
-					= (lfo1_enabled ? pv->lfo1_env.tick() : 0.0f);
-				const float lfo1
-					= (lfo1_enabled ? pv->lfo1_sample * lfo1_env : 0.0f);
+			pv->out1_vol.render(m_mod.out1_vol, 0, ngen);
+			pv->out1_pan.render(m_mod.out1_pan[0], 0, ngen, 0);
+			pv->out1_pan.render(m_mod.out1_pan[1], 0, ngen, 1);
 
-				pv->gen1.next(pv->gen1_freq
-					* (m_ctl1.pitchbend + modwheel1 * lfo1)
-					+ pv->gen1_glide.tick());
+			m_vol1.render(m_mod.vol1, noffset, ngen);
+			m_pan1.render(m_mod.pan1[0], noffset, ngen, 0);
+			m_pan1.render(m_mod.pan1[1], noffset, ngen, 1);
+			m_wid1.render(m_mod.wid1, noffset, ngen);
 
-				float gen1 = pv->gen1.value(k11);
-				float gen2 = pv->gen1.value(k12);
-
-				if (lfo1_enabled) {
+			if (lfo1_enabled) {
+				pv->lfo1_env.render(m_mod.lfo1_env, ngen);
+				for (j = 0; j < ngen; ++j) {
+					const float lfo1_env = m_mod.lfo1_env[j];
+					m_mod.lfo1[j] = pv->lfo1_sample * lfo1_env;
 					pv->lfo1_sample = pv->lfo1.sample(lfo1_freq
 						* (1.0f + SWEEP_SCALE * *m_lfo1.sweep * lfo1_env));
 				}
+			} else {
+				::memset(m_mod.lfo1, 0, ngen * sizeof(float));
+			}
 
-				// filters
+			pv->out1_panning = m_mod.lfo1[0] * *m_lfo1.panning;
+			pv->out1_volume  = m_mod.lfo1[0] * *m_lfo1.volume + 1.0f;
+
+			// modulation destinations: pitch
+
+			const float pitchbend1 = m_ctl1.pitchbend;
+			const float gen1_freq1 = pv->gen1_freq;
+			for (j = 0; j < ngen; ++j) {
+				m_mod.pitch[j] = gen1_freq1
+					* (pitchbend1 + modwheel1 * m_mod.lfo1[j])
+					+ m_mod.gen1_glide[j];
+			}
 
-				if (dcf1_enabled) {
+			// generators
+
+			for (j = 0; j < ngen; ++j) {
+				pv->gen1.next(m_mod.pitch[j]);
+				m_mod.gen1[j] = pv->gen1.value(k11);
+				m_mod.gen2[j] = pv->gen1.value(k12);
+			}
+
+			// filters (modulation destinations: cutoff, reso)
+
+			if (dcf1_enabled) {
+				pv->dcf1_env.render(m_mod.dcf1_env, ngen);
+				for (j = 0; j < ngen; ++j) {
 					const float env1 = 0.5f
-						* (1.0f + *m_dcf1.envelope * pv->dcf1_env.tick());
-					const float cutoff1 = samplv1_sigmoid_1(*m_dcf1.cutoff
+						* (1.0f + *m_dcf1.envelope * m_mod.dcf1_env[j]);
+					const float lfo1 = m_mod.lfo1[j];
+					m_mod.cutoff[j] = samplv1_sigmoid_1(*m_dcf1.cutoff
 						* env1 * (1.0f + *m_lfo1.cutoff * lfo1));
-					const float reso1 = samplv1_sigmoid_1(*m_dcf1.reso
+					m_mod.reso[j] = samplv1_sigmoid_1(*m_dcf1.reso
 						* env1 * (1.0f + *m_lfo1.reso * lfo1));
-					switch (int(*m_dcf1.slope)) {
-					case 3: // Formant
-						gen1 = pv->dcf17.output(gen1, cutoff1, reso1);
-						gen2 = pv->dcf18.output(gen2, cutoff1, reso1);
-						break;
-					case 2: // Biquad
-						gen1 = pv->dcf15.output(gen1, cutoff1, reso1);
-						gen2 = pv->dcf16.output(gen2, cutoff1, reso1);
-						break;
-					case 1: // 24db/octave
-						gen1 = pv->dcf13.output(gen1, cutoff1, reso1);
-						gen2 = pv->dcf14.output(gen2, cutoff1, reso1);
-						break;
-					case 0: // 12db/octave
-					default:
-						gen1 = pv->dcf11.output(gen1, cutoff1, reso1);
-						gen2 = pv->dcf12.output(gen2, cutoff1, reso1);
-						break;
-					}
 				}
+				switch (int(*m_dcf1.slope)) {
+				case 3: // Formant
+					pv->dcf17.process(m_mod.gen1, m_mod.gen2,
+						m_mod.cutoff, m_mod.reso, ngen);
+					break;
+				case 2: // Biquad
+					m_mod.filter(pv->dcf15, pv->dcf16, ngen);
+					break;
+				case 1: // 24db/octave
+					m_mod.filter(pv->dcf13, pv->dcf14, ngen);
+					break;
+				case 0: // 12db/octave
+				default:
+					m_mod.filter(pv->dcf11, pv->dcf12, ngen);
+					break;
+				}
+			}
 
-				// volumes
+			// volumes (modulation destinations: volume, panning)
 
-				const float wid1 = m_wid1.value(j);
+			const float vel0 = pv->vel;
+			for (j = 0; j < ngen; ++j) {
+				const float vel1
+					= (vel0 + (1.0f - vel0) * m_mod.dca1_pre[j]);
+				const float gen1 = m_mod.gen1[j];
+				const float gen2 = m_mod.gen2[j];
+				const float wid1 = m_mod.wid1[j];
 				const float mid1 = 0.5f * (gen1 + gen2);
 				const float sid1 = 0.5f * (gen1 - gen2);
-				const float vol1 = vel1 * m_vol1.value(j)
-					* pv->dca1_env.tick()
-					* pv->out1_vol.value(j);
-
-				// outputs
-
-				const float out1 = vol1 * (mid1 + sid1 * wid1)
-					* pv->out1_pan.value(j, 0)
-					* m_pan1.value(j, 0);
-				const float out2 = vol1 * (mid1 - sid1 * wid1)
-					* pv->out1_pan.value(j, 1)
-					* m_pan1.value(j, 1);
-
-				for (k = 0; k < m_nchannels; ++k) {
-					const float dry = (k & 1 ? out2 : out1);
-					const float wet = fxsend1 * dry;
-					*v_outs[k]++ += dry - wet;
-					*v_sfxs[k]++ += wet;
-				}
+				const float vol1 = vel1 * m_mod.vol1[j]
+					* m_mod.dca1_env[j]
+					* m_mod.out1_vol[j];
+				m_mod.out1[j] = vol1 * (mid1 + sid1 * wid1)
+					* m_mod.out1_pan[0][j]
+					* m_mod.pan1[0][j];
+				m_mod.out2[j] = vol1 * (mid1 - sid1 * wid1)
+					* m_mod.out1_pan[1][j]
+					* m_mod.pan1[1][j];
+			}
 
-				if (j == 0) {
-					pv->out1_panning = lfo1 * *m_lfo1.panning;
-					pv->out1_volume  = lfo1 * *m_lfo1.volume + 1.0f;
+			// outputs
+
+			for (k = 0; k < m_nchannels; ++k) {
+				const float *dry = (k & 1 ? m_mod.out2 : m_mod.out1);
+				float *out = v_outs[k];
+				if (fxs_enabled) {
+					float *sfx = v_sfxs[k];
+					for (j = 0; j < ngen; ++j) {
+						const float wet = fxsend1 * dry[j];
+						out[j] += dry[j] - wet;
+						sfx[j] += wet;
+					}
+				} else {
+					for (j = 0; j < ngen; ++j)
+						out[j] += dry[j];
 				}
+				v_outs[k] += ngen;
+				v_sfxs[k] += ngen;
 			}
 
 			nblock -= ngen;
+			noffset += ngen;
 
 			// voice ramps countdown
 
@@ -2378,7 +3018,7 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 	}
 
 	// chorus
-	if (m_nchannels > 1) {
+	if (cho_enabled) {
 		m_chorus.process(m_sfxs[0], m_sfxs[1], nframes, *m_cho.wet,
 			*m_cho.delay, *m_cho.feedb, *m_cho.rate, *m_cho.mod);
 	}
@@ -2387,24 +3027,30 @@ void samplv1_impl::process ( float **ins, float **outs, uint32_t nframes )
 	for (k = 0; k < m_nchannels; ++k) {
 		float *in = m_sfxs[k];
 		// flanger
-		m_flanger[k].process(in, nframes, *m_fla.wet,
-			*m_fla.delay, *m_fla.feedb, *m_fla.daft * float(k));
+		if (fla_enabled) {
+			m_flanger[k].process(in, nframes, *m_fla.wet,
+				*m_fla.delay, *m_fla.feedb, *m_fla.daft * float(k));
+		}
 		// phaser
-		m_phaser[k].process(in, nframes, *m_pha.wet,
-			*m_pha.rate, *m_pha.feedb, *m_pha.depth, *m_pha.daft * float(k));
+		if (pha_enabled) {
+			m_phaser[k].process(in, nframes, *m_pha.wet,
+				*m_pha.rate, *m_pha.feedb, *m_pha.depth, *m_pha.daft * float(k));
+		}
 		// delay
-		m_delay[k].process(in, nframes, *m_del.wet,
-			*m_del.delay, *m_del.feedb, get_bpm(*m_del.bpm));
+		if (del_enabled) {
+			m_delay[k].process(in, nframes, *m_del.wet,
+				*m_del.delay, *m_del.feedb, get_bpm(*m_del.bpm));
+		}
 	}
 
 	// reverb
-	if (m_nchannels > 1) {
+	if (rev_enabled) {
 		m_reverb.process(m_sfxs[0], m_sfxs[1], nframes, *m_rev.wet,
 			*m_rev.feedb, *m_rev.room, *m_rev.damp, *m_rev.width);
 	}
 
 	// output mix-down
-	for (k = 0; k < m_nchannels; ++k) {
+	for (k = 0; fxs_enabled && k < m_nchannels; ++k) {
 		uint32_t n;
 		float *sfx = m_sfxs[k];
 		// compressor
@@ -2447,7 +3093,7 @@ void samplv1_impl::sampleReverseTest (void)
 void samplv1_impl::sampleReverseSync (void)
 {
 	const bool bReverse
-		= gen1_sample.isReverse();
+		= sampleView()->isReverse();
 
 	m_gen1.reverse.set_value_sync(bReverse ? 1.0f : 0.0f);
 }
@@ -2466,7 +3112,7 @@ void samplv1_impl::sampleOffsetTest (void)
 void samplv1_impl::sampleOffsetSync (void)
 {
 	const bool bOffset
-		= gen1_sample.isOffset();
+		= gen1_sample->isOffset();
 
 	m_gen1.offset.set_value_sync(bOffset ? 1.0f : 0.0f);
 }
@@ -2475,11 +3121,11 @@ void samplv1_impl::sampleOffsetSync (void)
 void samplv1_impl::sampleOffsetRangeSync (void)
 {
 	const uint32_t iSampleLength
-		= gen1_sample.length();
+		= gen1_sample->length();
 	const uint32_t iOffsetStart
-		= gen1_sample.offsetStart();
+		= gen1_sample->offsetStart();
 	const uint32_t iOffsetEnd
-		= gen1_sample.offsetEnd();
+		= gen1_sample->offsetEnd();
 
 	const float offset_1 = (iSampleLength > 0
 		? float(iOffsetStart) / float(iSampleLength)
@@ -2506,7 +3152,7 @@ void samplv1_impl::sampleLoopTest (void)
 void samplv1_impl::sampleLoopSync (void)
 {
 	const bool bLoop
-		= gen1_sample.isLoop();
+		= gen1_sample->isLoop();
 
 	m_gen1.loop.set_value_sync(bLoop ? 1.0f : 0.0f);
 }
@@ -2515,11 +3161,11 @@ void samplv1_impl::sampleLoopSync (void)
 void samplv1_impl::sampleLoopRangeSync (void)
 {
 	const uint32_t iSampleLength
-		= gen1_sample.length();
+		= gen1_sample->length();
 	const uint32_t iLoopStart
-		= gen1_sample.loopStart();
+		= gen1_sample->loopStart();
 	const uint32_t iLoopEnd
-		= gen1_sample.loopEnd();
+		= gen1_sample->loopEnd();
 
 	const float loop_1 = (iSampleLength > 0
 		? float(iLoopStart) / float(iSampleLength)
@@ -2533,6 +3179,71 @@ void samplv1_impl::sampleLoopRangeSync (void)
 }
 
 
+// sample offset/loop points changed: phases and ports sync deferred
+// to the audio thread (coalesced), or right away when not running.
+void samplv1_impl::sampleUpdate (void)
+{
+	if (!m_running) {
+		m_sample_dirty.store(false, std::memory_order_release);
+		sampleUpdateSync();
+		return;
+	}
+
+	if (!m_sample_dirty.exchange(true, std::memory_order_acq_rel)) {
+		samplv1_cmd_queue::Command cmd;
+		cmd.type = samplv1_cmd_queue::SampleUpdate;
+		if (!m_commands.push(cmd))
+			m_commands_resync.store(true, std::memory_order_release);
+	}
+}
+
+
+// copy-on-edit: preloaded program samples are shared, so edits go
+// to a private copy, swapped in on the audio thread (non real-time).
+samplv1_sample *samplv1_impl::sampleEdit (void)
+{
+	std::lock_guard<std::mutex> lock(m_sample_mutex);
+
+	// pending swap? keep on editing the private copy...
+	if (m_sample_detach.load(std::memory_order_acquire))
+		return &gen1_sample0;
+
+	samplv1_sample *sample = gen1_sample;
+	if (sample == &gen1_sample0
+		|| !m_programs.preload_copy(&gen1_sample0, sample))
+		return sample;
+
+	m_sample_detach.store(sample, std::memory_order_release);
+
+	if (!m_running)
+		sampleDetach();
+
+	return &gen1_sample0;
+}
+
+
+// current sample as edited (private copy, while pending swap).
+samplv1_sample *samplv1_impl::sampleView (void)
+{
+	return (m_sample_detach.load(std::memory_order_acquire)
+		? &gen1_sample0 : gen1_sample);
+}
+
+
+void samplv1_impl::sampleUpdateSync (void)
+{
+	gen1_sample->updateOffsetPhases();
+	gen1_sample->updateLoopPhases();
+
+	sampleOffsetSync();
+	sampleOffsetRangeSync();
+	sampleLoopSync();
+	sampleLoopRangeSync();
+
+	updateEnvTimes();
+}
+
+
 // process running state...
 bool samplv1_impl::running ( bool on )
 {
@@ -2604,13 +3315,19 @@ uint16_t samplv1::octaves (void) const
 
 samplv1_sample *samplv1::sample (void) const
 {
-	return &(m_pImpl->gen1_sample);
+	return m_pImpl->gen1_sample;
+}
+
+
+void samplv1::setSample ( samplv1_sample *pSample )
+{
+	m_pImpl->setSample(pSample);
 }
 
 
 void samplv1::setReverse ( bool bReverse, bool bSync )
 {
-	m_pImpl->gen1_sample.setReverse(bReverse);
+	m_pImpl->sampleEdit()->setReverse(bReverse);
 	m_pImpl->sampleReverseSync();
 
 	if (bSync) updateSample();
@@ -2618,100 +3335,101 @@ void samplv1::setReverse ( bool bReverse, bool bSync )
 
 bool samplv1::isReverse (void) const
 {
-	return m_pImpl->gen1_sample.isReverse();
+	return m_pImpl->sampleView()->isReverse();
 }
 
 
 void samplv1::setOffset ( bool bOffset, bool bSync )
 {
-	m_pImpl->gen1_sample.setOffset(bOffset);
-	m_pImpl->sampleOffsetSync();
+	m_pImpl->sampleEdit()->setOffset(bOffset, false);
+	m_pImpl->sampleUpdate();
 
 	if (bSync) updateOffsetRange();
 }
 
 bool samplv1::isOffset (void) const
 {
-	return m_pImpl->gen1_sample.isOffset();
+	return m_pImpl->sampleView()->isOffset();
 }
 
 
 void samplv1::setOffsetRange ( uint32_t iOffsetStart, uint32_t iOffsetEnd, bool bSync )
 {
-	m_pImpl->gen1_sample.setOffsetRange(iOffsetStart, iOffsetEnd);
-	m_pImpl->sampleOffsetRangeSync();
-	m_pImpl->updateEnvTimes();
+	m_pImpl->sampleEdit()->setOffsetRange(iOffsetStart, iOffsetEnd, false);
+	m_pImpl->sampleUpdate();
 
 	if (bSync) updateOffsetRange();
 }
 
 uint32_t samplv1::offsetStart (void) const
 {
-	return m_pImpl->gen1_sample.offsetStart();
+	return m_pImpl->sampleView()->offsetStart();
 }
 
 uint32_t samplv1::offsetEnd (void) const
 {
-	return m_pImpl->gen1_sample.offsetEnd();
+	return m_pImpl->sampleView()->offsetEnd();
 }
 
 
 void samplv1::setLoop ( bool bLoop, bool bSync )
 {
-	m_pImpl->gen1_sample.setLoop(bLoop);
-	m_pImpl->sampleLoopSync();
+	m_pImpl->sampleEdit()->setLoop(bLoop, false);
+	m_pImpl->sampleUpdate();
 
 	if (bSync) updateLoopRange();
 }
 
 bool samplv1::isLoop (void) const
 {
-	return m_pImpl->gen1_sample.isLoop();
+	return m_pImpl->sampleView()->isLoop();
 }
 
 
 void samplv1::setLoopRange ( uint32_t iLoopStart, uint32_t iLoopEnd, bool bSync )
 {
-	m_pImpl->gen1_sample.setLoopRange(iLoopStart, iLoopEnd);
-	m_pImpl->sampleLoopRangeSync();
+	m_pImpl->sampleEdit()->setLoopRange(iLoopStart, iLoopEnd, false);
+	m_pImpl->sampleUpdate();
 
 	if (bSync) updateLoopRange();
 }
 
 uint32_t samplv1::loopStart (void) const
 {
-	return m_pImpl->gen1_sample.loopStart();
+	return m_pImpl->sampleView()->loopStart();
 }
 
 uint32_t samplv1::loopEnd (void) const
 {
-	return m_pImpl->gen1_sample.loopEnd();
+	return m_pImpl->sampleView()->loopEnd();
 }
 
 
 void samplv1::setLoopFade ( uint32_t iLoopFade, bool bSync )
 {
-	m_pImpl->gen1_sample.setLoopCrossFade(iLoopFade);
+	m_pImpl->sampleEdit()->setLoopCrossFade(iLoopFade);
+	m_pImpl->sampleUpdate();
 
 	if (bSync) updateLoopFade();
 }
 
 uint32_t samplv1::loopFade (void) const
 {
-	return uint32_t(m_pImpl->gen1_sample.loopCrossFade());
+	return uint32_t(m_pImpl->sampleView()->loopCrossFade());
 }
 
 
 void samplv1::setLoopZero ( bool bLoopZero, bool bSync )
 {
-	m_pImpl->gen1_sample.setLoopZeroCrossing(bLoopZero);
+	m_pImpl->sampleEdit()->setLoopZeroCrossing(bLoopZero);
+	m_pImpl->sampleUpdate();
 
 	if (bSync) updateLoopZero();
 }
 
 bool samplv1::isLoopZero (void) const
 {
-	return m_pImpl->gen1_sample.isLoopZeroCrossing();
+	return m_pImpl->sampleView()->isLoopZeroCrossing();
 }
 
 
@@ -2750,7 +3468,7 @@ samplv1_port *samplv1::paramPort ( ParamIndex index ) const
 
 void samplv1::setParamValue ( ParamIndex index, float fValue )
 {
-	m_pImpl->setParamValue(index, fValue);
+	m_pImpl->queueParamValue(index, fValue);
 }
 
 float samplv1::paramValue ( ParamIndex index ) const
@@ -2796,6 +3514,22 @@ samplv1_programs *samplv1::programs (void) const
 }
 
 
+// key/velocity zones accessor
+
+samplv1_zones *samplv1::zones (void) const
+{
+	return m_pImpl->zones();
+}
+
+
+// audio cycle counter accessor
+
+samplv1_epoch *samplv1::epoch (void) const
+{
+	return m_pImpl->epoch();
+}
+
+
 // process state
 
 bool samplv1::running ( bool on )
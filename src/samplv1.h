@@ -32,6 +32,8 @@ class samplv1_port;
 class samplv1_sample;
 class samplv1_controls;
 class samplv1_programs;
+class samplv1_zones;
+class samplv1_epoch;
 
 
 //-------------------------------------------------------------------------
@@ -58,6 +60,9 @@ public:
 
 	samplv1_sample *sample() const;
 
+	// ready-made sample swap (audio thread, not owned).
+	void setSample(samplv1_sample *pSample);
+
 	void setReverse(bool bReverse, bool bSync = false);
 	bool isReverse() const;
 
@@ -190,6 +195,9 @@ public:
 
 	samplv1_controls *controls() const;
 	samplv1_programs *programs() const;
+	samplv1_zones *zones() const;
+
+	samplv1_epoch *epoch() const;
 
 	void process_midi(uint8_t *data, uint32_t size);
 	void process(float **ins, float **outs, uint32_t nframes);
@@ -122,63 +122,31 @@ QString samplv1_config::bankPrefix (void) const
 }
 
 
-void samplv1_config::loadPrograms ( samplv1_programs *pPrograms )
-{
-	pPrograms->clear_banks();
-
-	QSettings::beginGroup(programsGroup());
-
-	const QStringList& bank_keys = QSettings::childKeys();
-	QStringListIterator bank_iter(bank_keys);
-	while (bank_iter.hasNext()) {
-		const QString& bank_key = bank_iter.next();
-		uint16_t bank_id = bank_key.toInt();
-		const QString& bank_name
-			= QSettings::value(bank_key).toString();
-		samplv1_programs::Bank *pBank = pPrograms->add_bank(bank_id, bank_name);
-		QSettings::beginGroup(bankPrefix() + bank_key);
-		const QStringList& prog_keys = QSettings::childKeys();
-		QStringListIterator prog_iter(prog_keys);
-		while (prog_iter.hasNext()) {
-			const QString& prog_key = prog_iter.next();
-			uint16_t prog_id = prog_key.toInt();
-			const QString& prog_name
-				= QSettings::value(prog_key).toString();
-			pBank->add_prog(prog_id, prog_name);
-		}
-		QSettings::endGroup();
-	}
-
-	QSettings::endGroup();
-
-	pPrograms->enabled(bProgramsEnabled);
-}
-
-
 void samplv1_config::savePrograms ( samplv1_programs *pPrograms )
 {
 	bProgramsEnabled = pPrograms->enabled();
+	bProgramsPreload = pPrograms->preload();
 
 	clearPrograms();
 
 	QSettings::beginGroup(programsGroup());
 
 	const samplv1_programs::Banks& banks = pPrograms->banks();
-	samplv1_programs::Banks::ConstIterator bank_iter = banks.constBegin();
-	const samplv1_programs::Banks::ConstIterator& bank_end = banks.constEnd();
+	samplv1_programs::Banks::const_iterator bank_iter = banks.begin();
+	const samplv1_programs::Banks::const_iterator& bank_end = banks.end();
 	for ( ; bank_iter != bank_end; ++bank_iter) {
-		samplv1_programs::Bank *pBank = bank_iter.value();
+		samplv1_programs::Bank *pBank = bank_iter->second;
 		const QString& bank_key = QString::number(pBank->id());
-		const QString& bank_name = pBank->name();
+		const QString& bank_name = QString::fromUtf8(pBank->name().c_str());
 		QSettings::setValue(bank_key, bank_name);
 		QSettings::beginGroup(bankPrefix() + bank_key);
 		const samplv1_programs::Progs& progs = pBank->progs();
-		samplv1_programs::Progs::ConstIterator prog_iter = progs.constBegin();
-		const samplv1_programs::Progs::ConstIterator& prog_end = progs.constEnd();
+		samplv1_programs::Progs::const_iterator prog_iter = progs.begin();
+		const samplv1_programs::Progs::const_iterator& prog_end = progs.end();
 		for ( ; prog_iter != prog_end; ++prog_iter) {
-			samplv1_programs::Prog *pProg = prog_iter.value();
+			samplv1_programs::Prog *pProg = prog_iter->second;
 			const QString& prog_key = QString::number(pProg->id());
-			const QString& prog_name = pProg->name();
+			const QString& prog_name = QString::fromUtf8(pProg->name().c_str());
 			QSettings::setValue(prog_key, prog_name);
 		}
 		QSettings::endGroup();
@@ -224,41 +192,6 @@ QString samplv1_config::controlPrefix (void) const
 }
 
 
-void samplv1_config::loadControls ( samplv1_controls *pControls )
-{
-	pControls->clear();
-
-	QSettings::beginGroup(controlsGroup());
-
-	const QStringList& keys = QSettings::childKeys();
-	QStringListIterator iter(keys);
-	while (iter.hasNext()) {
-		const QString& sKey = '/' + iter.next();
-		const QStringList& clist = sKey.split('_');
-		if (clist.at(0) == controlPrefix()) {
-			const unsigned short channel
-				= clist.at(1).toInt();
-			const samplv1_controls::Type ctype
-				= samplv1_controls::typeFromText(clist.at(2));
-			samplv1_controls::Key key;
-			key.status = ctype | (channel & 0x1f);
-			key.param = clist.at(3).toInt();
-			const QStringList& vlist
-				= QSettings::value(sKey).toStringList();
-			samplv1_controls::Data data;
-			data.index = vlist.at(0).toInt();
-			if (vlist.count() > 1)
-				data.flags = vlist.at(1).toInt();
-			pControls->add_control(key, data);
-		}
-	}
-
-	QSettings::endGroup();
-
-	pControls->enabled(bControlsEnabled);
-}
-
-
 void samplv1_config::saveControls ( samplv1_controls *pControls )
 {
 	bControlsEnabled = pControls->enabled();
@@ -268,15 +201,15 @@ void samplv1_config::saveControls ( samplv1_controls *pControls )
 	QSettings::beginGroup(controlsGroup());
 
 	const samplv1_controls::Map& map = pControls->map();
-	samplv1_controls::Map::ConstIterator iter = map.constBegin();
-	const samplv1_controls::Map::ConstIterator& iter_end = map.constEnd();
+	samplv1_controls::Map::const_iterator iter = map.begin();
+	const samplv1_controls::Map::const_iterator& iter_end = map.end();
 	for ( ; iter != iter_end; ++iter) {
-		const samplv1_controls::Key& key = iter.key();
+		const samplv1_controls::Key& key = iter->first;
 		QString sKey = controlPrefix();
 		sKey += '_' + QString::number(key.channel());
-		sKey += '_' + samplv1_controls::textFromType(key.type());
+		sKey += '_' + QString(samplv1_controls::textFromType(key.type()));
 		sKey += '_' + QString::number(key.param);
-		const samplv1_controls::Data& data = iter.value();
+		const samplv1_controls::Data& data = iter->second;
 		QStringList vlist;
 		vlist.append(QString::number(data.index));
 		vlist.append(QString::number(data.flags));
@@ -315,8 +248,11 @@ void samplv1_config::load (void)
 	iFrameTimeFormat = QSettings::value("/FrameTimeFormat", 0).toInt();
 	fRandomizePercent = QSettings::value("/RandomizePercent", 20.0f).toFloat();
 	iPitchShiftType  = QSettings::value("/PitchShiftType", 0).toInt();
+	iSampleInterpType = QSettings::value("/SampleInterpType", 0).toInt();
+	iSampleStorageType = QSettings::value("/SampleStorageType", 0).toInt();
 	bControlsEnabled = QSettings::value("/ControlsEnabled", false).toBool();
 	bProgramsEnabled = QSettings::value("/ProgramsEnabled", false).toBool();
+	bProgramsPreload = QSettings::value("/ProgramsPreload", false).toBool();
 	QSettings::endGroup();
 
 	QSettings::beginGroup("/Dialogs");
@@ -359,8 +295,11 @@ void samplv1_config::save (void)
 	QSettings::setValue("/FrameTimeFormat", iFrameTimeFormat);
 	QSettings::setValue("/RandomizePercent", fRandomizePercent);
 	QSettings::setValue("/PitchShiftType", iPitchShiftType);
+	QSettings::setValue("/SampleInterpType", iSampleInterpType);
+	QSettings::setValue("/SampleStorageType", iSampleStorageType);
 	QSettings::setValue("/ControlsEnabled", bControlsEnabled);
 	QSettings::setValue("/ProgramsEnabled", bProgramsEnabled);
+	QSettings::setValue("/ProgramsPreload", bProgramsPreload);
 	QSettings::endGroup();
 
 	QSettings::beginGroup("/Dialogs");
@@ -22,16 +22,12 @@
 #ifndef __samplv1_config_h
 #define __samplv1_config_h
 
-#include "config.h"
-
-#define SAMPLV1_TITLE       PACKAGE_NAME
+#include "samplv1_ini.h"
 
 #define SAMPLV1_SUBTITLE    "an old-school polyphonic sampler."
 #define SAMPLV1_WEBSITE     "https://samplv1.sourceforge.io"
 #define SAMPLV1_COPYRIGHT   "Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved."
 
-#define SAMPLV1_DOMAIN      "rncbc.org"
-
 
 //-------------------------------------------------------------------------
 // samplv1_config - Prototype settings class (singleton).
@@ -73,6 +69,7 @@ public:
 	// Special persistent options.
 	bool bControlsEnabled;
 	bool bProgramsEnabled;
+	bool bProgramsPreload;
 	bool bProgramsPreview;
 	bool bUseNativeDialogs;
 	// Run-time special non-persistent options.
@@ -85,6 +82,12 @@ public:
 	// Pitch-shit algorithm.
 	int iPitchShiftType;
 
+	// Sample interpolation mode.
+	int iSampleInterpType;
+
+	// Sample storage format.
+	int iSampleStorageType;
+
 	// Micro-tuning options.
 	bool    bTuningEnabled;
 	float   fTuningRefPitch;
@@ -104,13 +107,15 @@ public:
 	QStringList presetList();
 
 	// Programs utility methods.
-	void loadPrograms(samplv1_programs *pPrograms);
 	void savePrograms(samplv1_programs *pPrograms);
 
 	// Controllers utility methods.
-	void loadControls(samplv1_controls *pControls);
 	void saveControls(samplv1_controls *pControls);
 
+	// Explicit I/O methods.
+	void load();
+	void save();
+
 protected:
 
 	// Preset group path.
@@ -128,10 +133,6 @@ protected:
 
 	void clearControls();
 
-	// Explicit I/O methods.
-	void load();
-	void save();
-
 private:
 
 	// The singleton instance.
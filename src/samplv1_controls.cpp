@@ -21,7 +21,7 @@
 
 #include "samplv1_controls.h"
 
-#include <QHash>
+#include <string.h>
 
 
 #define RPN_MSB   0x65
@@ -188,7 +188,31 @@ private:
 	xrpn_data14    m_value;
 };
 
-typedef QHash<unsigned int, xrpn_item> xrpn_cache;
+//---------------------------------------------------------------------
+// xrpn_cache - decl. (flat, preallocated, by channel)
+//
+class xrpn_cache
+{
+public:
+
+	static const unsigned int MAX_CHANNELS = 0x20;
+
+	xrpn_item& item ( unsigned short channel )
+		{ return m_items[channel & (MAX_CHANNELS - 1)]; }
+
+	xrpn_item& at ( unsigned int i )
+		{ return m_items[i]; }
+
+	void clear ()
+	{
+		for (unsigned int i = 0; i < MAX_CHANNELS; ++i)
+			m_items[i].clear();
+	}
+
+private:
+
+	xrpn_item m_items[MAX_CHANNELS];
+};
 
 
 //---------------------------------------------------------------------
@@ -262,8 +286,7 @@ public:
 
 	bool push ( const samplv1_controls::Event& event )
 	{
-		if (count() >= m_mask)
-			resize(m_size + 4);
+		// never reallocate here: real-time thread!
 		const unsigned int w = (m_write + 1) & m_mask;
 		if (w == m_read)
 			return false;
@@ -312,7 +335,7 @@ class samplv1_controls::Impl
 {
 public:
 
-	Impl() : m_count(0) {}
+	Impl() : m_count(0), m_queue(1024) {}
 
 	bool is_pending () const
 		{ return m_queue.is_pending(); }
@@ -323,10 +346,8 @@ public:
 	void flush()
 	{
 		if (m_count > 0) {
-			xrpn_cache::Iterator iter = m_cache.begin();
-			const xrpn_cache::Iterator& iter_end = m_cache.end();
-			for ( ; iter != iter_end; ++iter)
-				enqueue(iter.value());
+			for (unsigned int i = 0; i < xrpn_cache::MAX_CHANNELS; ++i)
+				enqueue(m_cache.at(i));
 			m_cache.clear();
 		//	m_count = 0;
 		}
@@ -502,7 +523,7 @@ public:
 protected:
 
 	xrpn_item& get_item ( unsigned short channel )
-		{ return m_cache[channel]; }
+		{ return m_cache.item(channel); }
 
 	void enqueue ( xrpn_item& item )
 	{
@@ -566,6 +587,151 @@ private:
 };
 
 
+//---------------------------------------------------------------------
+// samplv1_controls::Table - decl.
+//
+// Flat dispatch table, built off the real-time thread and never
+// changed once published (catch-up state is kept aside, per param).
+// CC and CC14 entries are directly indexed by channel (0=Auto) and
+// parameter number; RPN and NRPN entries, being 14-bit wide, are
+// kept in a sorted array, looked up by binary search.
+//
+
+class samplv1_controls::Table
+{
+public:
+
+	static const unsigned short MAX_CHANNELS = 17; // 0=Auto, 1..16.
+
+	// ctor.
+	Table ( const samplv1_controls::Map& map )
+		: m_nitems(0), m_items(nullptr), m_nxkeys(0), m_xkeys(nullptr)
+	{
+		::memset(m_cc,   0xff, sizeof(m_cc));
+		::memset(m_cc14, 0xff, sizeof(m_cc14));
+
+		const int nitems = map.size();
+		if (nitems > 0) {
+			m_items = new samplv1_controls::Data [nitems];
+			m_xkeys = new XKey [nitems];
+		}
+
+		// std::map iterates in key order, thus the xkeys are sorted...
+		samplv1_controls::Map::const_iterator iter = map.begin();
+		const samplv1_controls::Map::const_iterator& iter_end = map.end();
+		for ( ; iter != iter_end; ++iter) {
+			const samplv1_controls::Key& key = iter->first;
+			const unsigned short channel = key.channel();
+			if (channel >= MAX_CHANNELS)
+				continue;
+			const int16_t i = m_nitems;
+			const samplv1_controls::Type ctype = key.type();
+			if (ctype == samplv1_controls::CC) {
+				if (key.param >= 0x80)
+					continue;
+				m_cc[channel][key.param] = i;
+			}
+			else
+			if (ctype == samplv1_controls::CC14) {
+				if (key.param >= CC14_MSB_MAX)
+					continue;
+				m_cc14[channel][key.param] = i;
+			}
+			else
+			if (ctype == samplv1_controls::RPN ||
+				ctype == samplv1_controls::NRPN) {
+				XKey& xkey = m_xkeys[m_nxkeys++];
+				xkey.key  = xkey_hash(key);
+				xkey.item = i;
+			}
+			else continue;
+			m_items[m_nitems++] = iter->second;
+		}
+	}
+
+	// dtor.
+	~Table ()
+	{
+		if (m_xkeys) delete [] m_xkeys;
+		if (m_items) delete [] m_items;
+	}
+
+	// real-time lookup.
+	samplv1_controls::Data *find ( const samplv1_controls::Key& key ) const
+	{
+		const unsigned short channel = key.channel();
+		if (channel >= MAX_CHANNELS)
+			return nullptr;
+
+		int16_t i = -1;
+
+		switch (key.type()) {
+		case samplv1_controls::CC:
+			if (key.param < 0x80)
+				i = m_cc[channel][key.param];
+			break;
+		case samplv1_controls::CC14:
+			if (key.param < CC14_MSB_MAX)
+				i = m_cc14[channel][key.param];
+			break;
+		case samplv1_controls::RPN:
+		case samplv1_controls::NRPN: {
+			const uint32_t h = xkey_hash(key);
+			int lo = 0;
+			int hi = int(m_nxkeys) - 1;
+			while (lo <= hi) {
+				const int mid = (lo + hi) >> 1;
+				const uint32_t k = m_xkeys[mid].key;
+				if (k < h)
+					lo = mid + 1;
+				else
+				if (k > h)
+					hi = mid - 1;
+				else {
+					i = m_xkeys[mid].item;
+					break;
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+
+		return (i >= 0 ? &m_items[i] : nullptr);
+	}
+
+	// all entries accessors.
+	int count () const
+		{ return m_nitems; }
+	samplv1_controls::Data& at ( int i ) const
+		{ return m_items[i]; }
+
+protected:
+
+	// sorted RPN/NRPN key (same order as samplv1_controls::Key).
+	static uint32_t xkey_hash ( const samplv1_controls::Key& key )
+		{ return (uint32_t(key.status) << 16) | key.param; }
+
+private:
+
+	struct XKey
+	{
+		uint32_t key;
+		int16_t  item;
+	};
+
+	int16_t m_cc[MAX_CHANNELS][0x80];
+	int16_t m_cc14[MAX_CHANNELS][CC14_MSB_MAX];
+
+	int16_t m_nitems;
+	samplv1_controls::Data *m_items;
+
+	uint16_t m_nxkeys;
+	XKey *m_xkeys;
+};
+
+
 //---------------------------------------------------------------------
 // samplv1_controls - impl.
 //
@@ -574,17 +740,147 @@ private:
 samplv1_controls::samplv1_controls ( samplv1 *pSampl )
 	: m_pImpl(new samplv1_controls::Impl()), m_enabled(false),
 		m_sched_in(pSampl), m_sched_out(pSampl),
+		m_table(nullptr), m_table_hazard(nullptr),
 		m_timeout(0), m_timein(0)
 {
+	for (int i = 0; i < samplv1::NUM_PARAMS; ++i) {
+		m_sync_val[i].store(0.0f);
+		m_sync[i].store(false);
+	}
+
+	update();
 }
 
 
 samplv1_controls::~samplv1_controls (void)
 {
+	table_cleanup(true);
+
 	delete m_pImpl;
 }
 
 
+// controller map methods (non real-time, serialized).
+samplv1_controls::Map samplv1_controls::map (void) const
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	return m_map;
+}
+
+
+int samplv1_controls::find_control ( const Key& key ) const
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	const Map::const_iterator iter = m_map.find(key);
+	return (iter != m_map.end() ? iter->second.index : -1);
+}
+
+
+void samplv1_controls::add_control ( const Key& key, const Data& data )
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	m_map[key] = data;
+	table_update();
+}
+
+
+void samplv1_controls::remove_control ( const Key& key )
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	m_map.erase(key);
+	table_update();
+}
+
+
+void samplv1_controls::clear (void)
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	m_map.clear();
+	table_update();
+}
+
+
+void samplv1_controls::set_map ( const Map& map )
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	m_map = map;
+	table_update();
+}
+
+
+// (re)build and publish the real-time dispatch table.
+void samplv1_controls::update (void)
+{
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	table_update();
+}
+
+
+// (re)build and publish the real-time dispatch table (locked).
+void samplv1_controls::table_update (void)
+{
+	Table *table = new Table(m_map);
+
+	Table *old_table = m_table.exchange(table);
+	if (old_table)
+		m_tables_gc.push_back(old_table);
+
+	table_cleanup();
+}
+
+
+// acquire current dispatch table (real-time safe).
+samplv1_controls::Table *samplv1_controls::table_acquire (void)
+{
+	Table *table = m_table.load();
+	for (;;) {
+		m_table_hazard.store(table);
+		Table *table2 = m_table.load();
+		if (table2 == table)
+			break;
+		table = table2;
+	}
+	return table;
+}
+
+
+// release current dispatch table (real-time safe).
+void samplv1_controls::table_release (void)
+{
+	m_table_hazard.store(nullptr);
+}
+
+
+// dispose all tables no longer in use.
+void samplv1_controls::table_cleanup ( bool force )
+{
+	Table *hazard = (force ? nullptr : m_table_hazard.load());
+
+	std::vector<Table *>::iterator iter = m_tables_gc.begin();
+	while (iter != m_tables_gc.end()) {
+		Table *table = *iter;
+		if (table != hazard) {
+			delete table;
+			iter = m_tables_gc.erase(iter);
+		}
+		else ++iter;
+	}
+
+	if (force) {
+		Table *table = m_table.exchange(nullptr);
+		if (table)
+			delete table;
+	}
+}
+
+
 // controller queue methods.
 void samplv1_controls::process_enqueue (
 	unsigned short channel, unsigned short param, unsigned short value )
@@ -626,17 +922,22 @@ void samplv1_controls::process_event ( const Event& event )
 
 	m_sched_in.schedule_key(key);
 
-	const Map::Iterator& iter_end = m_map.end();
-	Map::Iterator iter = m_map.find(key);
-	if (iter == iter_end && key.channel() > 0) {
+	Table *table = table_acquire();
+	if (table == nullptr)
+		return;
+
+	Data *pData = table->find(key);
+	if (pData == nullptr && key.channel() > 0) {
 		key.status = key.type(); // channel=0 (Auto)
-		iter = m_map.find(key);
+		pData = table->find(key);
 	}
-	if (iter == iter_end)
+	if (pData == nullptr) {
+		table_release();
 		return;
+	}
 
 	// reference to payload...
-	Data& data = iter.value();
+	Data& data = *pData;
 
 	// process controller event...
 	float fScale = float(event.value) / 127.0f;
@@ -654,23 +955,28 @@ void samplv1_controls::process_event ( const Event& event )
 	if (data.flags & Logarithmic)
 		fScale *= (fScale * fScale);
 
+	if (data.index < 0 || data.index >= samplv1::NUM_PARAMS) {
+		table_release();
+		return;
+	}
+
 	const samplv1::ParamIndex index
 		= samplv1::ParamIndex(data.index);
 
 	// catch-up testing begin...
 	bool bSync = (data.flags & Hook) || !samplv1_param::paramFloat(index);
 	if (!bSync)
-		bSync = data.sync;
+		bSync = m_sync[index].load();
 	if (!bSync) {
-		const float v0 = data.val;
+		const float v0 = m_sync_val[index].load();
 		const float v1 = samplv1_param::paramScale(index,
 			m_sched_in.instance()->paramValue(index));
 		const float d1 = ::fabsf(v1 - fScale);
 		const float d2 = ::fabsf(v1 - v0) * d1;
 		bSync = (d2 < 0.001f);
 		if (bSync) {
-			data.val = fScale;
-			data.sync = true;
+			m_sync_val[index].store(fScale);
+			m_sync[index].store(true);
 		}
 	}
 
@@ -678,6 +984,8 @@ void samplv1_controls::process_event ( const Event& event )
 		m_sched_out.schedule_event(index,
 			samplv1_param::paramValue(index, fScale));
 	}
+
+	table_release();
 }
 
 
@@ -703,62 +1011,70 @@ void samplv1_controls::reset (void)
 	if (!enabled())
 		return;
 
-	const Map::Iterator& iter_end = m_map.end();
-	Map::Iterator iter = m_map.begin();
+	std::lock_guard<std::mutex> lock(m_map_mutex);
+
+	// reset the catch-up state, kept aside from the dispatch table...
+	Map::const_iterator iter = m_map.begin();
+	const Map::const_iterator& iter_end = m_map.end();
 	for ( ; iter != iter_end; ++iter) {
-		Data& data = iter.value();
+		const Data& data = iter->second;
 		if (data.flags & Hook)
 			continue;
+		if (data.index < 0 || data.index >= samplv1::NUM_PARAMS)
+			continue;
 		const samplv1::ParamIndex index
 			= samplv1::ParamIndex(data.index);
-		data.val = samplv1_param::paramScale(index,
-			m_sched_in.instance()->paramValue(index));
-		data.sync = false;
+		m_sync_val[index].store(samplv1_param::paramScale(index,
+			m_sched_in.instance()->paramValue(index)));
+		m_sync[index].store(false);
 	}
 }
 
 
 // text utilities.
-samplv1_controls::Type samplv1_controls::typeFromText ( const QString& sText )
+samplv1_controls::Type samplv1_controls::typeFromText ( const char *pszText )
 {
-	if (sText == "CC")
+	if (pszText == nullptr)
+		return None;
+	else
+	if (::strcmp(pszText, "CC") == 0)
 		return CC;
 	else
-	if (sText == "RPN")
+	if (::strcmp(pszText, "RPN") == 0)
 		return RPN;
 	else
-	if (sText == "NRPN")
+	if (::strcmp(pszText, "NRPN") == 0)
 		return NRPN;
 	else
-	if (sText == "CC14")
+	if (::strcmp(pszText, "CC14") == 0)
 		return CC14;
 	else
 		return None;
 }
 
 
-QString samplv1_controls::textFromType ( Type ctype )
+const char *samplv1_controls::textFromType ( Type ctype )
 {
-	QString sText;
+	const char *pszText = "";
 
 	switch (ctype) {
 	case CC:
-		sText = "CC";
+		pszText = "CC";
 		break;
 	case RPN:
-		sText = "RPN";
+		pszText = "RPN";
 		break;
 	case NRPN:
-		sText = "NRPN";
+		pszText = "NRPN";
 		break;
 	case CC14:
-		sText = "CC14";
+		pszText = "CC14";
 		break;
 	default:
 		break;
 	}
 
-	return sText;
+	return pszText;
 }
 
 
@@ -25,7 +25,11 @@
 #include "samplv1_param.h"
 #include "samplv1_sched.h"
 
-#include <QMap>
+#include <map>
+#include <vector>
+
+#include <atomic>
+#include <mutex>
 
 #include <math.h>
 
@@ -102,7 +106,7 @@ public:
 		bool sync;
 	};
 
-	typedef QMap<Key, Data> Map;
+	typedef std::map<Key, Data> Map;
 
 	// controller events.
 	struct Event
@@ -111,17 +115,20 @@ public:
 		unsigned short value;
 	};
 
-	// controller map methods.
-	const Map& map() const { return m_map; }
+	// controller map methods (non real-time, serialized).
+	Map map() const;
+
+	int find_control(const Key& key) const;
+	void add_control(const Key& key, const Data& data);
+	void remove_control(const Key& key);
+
+	void clear();
 
-	int find_control(const Key& key) const
-		{ return m_map.value(key).index; }
-	void add_control(const Key& key, const Data& data)
-		{ m_map.insert(key, data); }
-	void remove_control(const Key& key)
-		{ m_map.remove(key); }
+	// bulk (re)assignment, one dispatch table rebuild only.
+	void set_map(const Map& map);
 
-	void clear() { m_map.clear(); }
+	// (re)build and publish the real-time dispatch table.
+	void update();
 
 	// reset all controllers.
 	void reset();
@@ -138,8 +145,8 @@ public:
 	void process(unsigned int nframes);
 
 	// text utilities.
-	static Type typeFromText(const QString& sText);
-	static QString textFromType(Type ctype);
+	static Type typeFromText(const char *pszText);
+	static const char *textFromType(Type ctype);
 
 	// current/last controller accessor.
 	const Key& current_key() const;
@@ -223,6 +230,31 @@ private:
 	// controllers map.
 	Map m_map;
 
+	// controllers map and dispatch table rebuild/gc serialization.
+	mutable std::mutex m_map_mutex;
+
+	// (re)build and publish the dispatch table (locked).
+	void table_update();
+
+	// real-time dispatch table (flat lookup).
+	class Table;
+
+	// acquire/release current dispatch table (real-time safe).
+	Table *table_acquire();
+	void table_release();
+
+	// dispose all tables no longer in use.
+	void table_cleanup(bool force = false);
+
+	std::atomic<Table *> m_table;
+	std::atomic<Table *> m_table_hazard;
+
+	std::vector<Table *> m_tables_gc;
+
+	// catch-up state, per parameter (kept across table rebuilds).
+	std::atomic<float> m_sync_val[samplv1::NUM_PARAMS];
+	std::atomic<bool>  m_sync[samplv1::NUM_PARAMS];
+
 	// frame timers.
 	unsigned int m_timeout;
 	unsigned int m_timein;
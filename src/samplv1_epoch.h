@@ -0,0 +1,66 @@
+// samplv1_epoch.h
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __samplv1_epoch_h
+#define __samplv1_epoch_h
+
+#include <stdint.h>
+
+#include <atomic>
+
+
+//-------------------------------------------------------------------------
+// samplv1_epoch - audio cycle counter (deferred reclamation grace).
+//
+// Bumped once at the start of each process() cycle: anything retired
+// (unpublished) at some epoch may be freed as soon as the audio thread
+// has started two more cycles, as it can't be holding it any longer.
+//
+
+class samplv1_epoch
+{
+public:
+
+	// ctor.
+	samplv1_epoch() : m_epoch(0) {}
+
+	// audio thread: one tick per cycle.
+	void tick()
+		{ m_epoch.fetch_add(1, std::memory_order_acq_rel); }
+
+	// current epoch (retire stamp).
+	uint32_t current() const
+		{ return m_epoch.load(std::memory_order_acquire); }
+
+	// grace period over since the retire stamp?
+	bool elapsed(uint32_t epoch, uint32_t cycles = 2) const
+		{ return (current() - epoch) >= cycles; }
+
+private:
+
+	// instance variables.
+	std::atomic<uint32_t> m_epoch;
+};
+
+
+#endif	// __samplv1_epoch_h
+
+// end of samplv1_epoch.h
@@ -21,6 +21,10 @@
 
 #include "samplv1_formant.h"
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 
 //---------------------------------------------------------------------
 // formant filter.
@@ -224,4 +228,155 @@ void samplv1_formant::reset_coeffs (void)
 }
 
 
+//---------------------------------------------------------------------
+// samplv1_formant2 - stereo formant parallel filter bank (SIMD).
+//
+
+// reset filters
+void samplv1_formant2::reset (void)
+{
+	for (uint32_t k = 0; k < NUM_LANES; ++k) {
+		m_a0[k] = m_a0_step[k] = 0.0f;
+		m_b1[k] = m_b1_step[k] = 0.0f;
+		m_b2[k] = m_b2_step[k] = 0.0f;
+		m_out1[k] = m_out2[k] = 0.0f;
+	}
+
+	m_csteps = 0;
+}
+
+
+// reset coeffs. method
+void samplv1_formant2::reset_coeffs (void)
+{
+	if (m_pImpl == nullptr)
+		return;
+
+	m_pImpl->reset_coeffs(m_cutoff, m_reso);
+
+	for (uint32_t i = 0; i < NUM_FORMANTS; ++i) {
+		const samplv1_formant::Coeffs& coeffs = m_pImpl->coeffs(i);
+		for (uint32_t k = 2 * i; k < 2 * i + 2; ++k) {
+			m_a0_step[k] = (coeffs.a0 - m_a0[k]) / float(NUM_STEPS);
+			m_b1_step[k] = (coeffs.b1 - m_b1[k]) / float(NUM_STEPS);
+			m_b2_step[k] = (coeffs.b2 - m_b2[k]) / float(NUM_STEPS);
+		}
+	}
+
+	m_csteps = NUM_STEPS;
+}
+
+
+// process block (in-place, stereo)
+void samplv1_formant2::process ( float *in1, float *in2,
+	const float *cutoff, const float *reso, uint32_t nframes )
+{
+#if defined(__SSE__)
+
+	__m128 a0[3], b1[3], b2[3], out1[3], out2[3];
+	__m128 a0_step[3], b1_step[3], b2_step[3];
+
+	uint32_t r;
+
+	for (r = 0; r < 3; ++r) {
+		a0[r] = _mm_loadu_ps(&m_a0[r << 2]);
+		b1[r] = _mm_loadu_ps(&m_b1[r << 2]);
+		b2[r] = _mm_loadu_ps(&m_b2[r << 2]);
+		a0_step[r] = _mm_loadu_ps(&m_a0_step[r << 2]);
+		b1_step[r] = _mm_loadu_ps(&m_b1_step[r << 2]);
+		b2_step[r] = _mm_loadu_ps(&m_b2_step[r << 2]);
+		out1[r] = _mm_loadu_ps(&m_out1[r << 2]);
+		out2[r] = _mm_loadu_ps(&m_out2[r << 2]);
+	}
+
+	for (uint32_t j = 0; j < nframes; ++j) {
+
+		if (update(cutoff[j], reso[j])) {
+			for (r = 0; r < 3; ++r) {
+				_mm_storeu_ps(&m_a0[r << 2], a0[r]);
+				_mm_storeu_ps(&m_b1[r << 2], b1[r]);
+				_mm_storeu_ps(&m_b2[r << 2], b2[r]);
+			}
+			reset_coeffs();
+			for (r = 0; r < 3; ++r) {
+				a0_step[r] = _mm_loadu_ps(&m_a0_step[r << 2]);
+				b1_step[r] = _mm_loadu_ps(&m_b1_step[r << 2]);
+				b2_step[r] = _mm_loadu_ps(&m_b2_step[r << 2]);
+			}
+		}
+
+		if (m_csteps > 0) {
+			for (r = 0; r < 3; ++r) {
+				a0[r] = _mm_add_ps(a0[r], a0_step[r]);
+				b1[r] = _mm_add_ps(b1[r], b1_step[r]);
+				b2[r] = _mm_add_ps(b2[r], b2_step[r]);
+			}
+			--m_csteps;
+		}
+
+		const __m128 in = _mm_setr_ps(in1[j], in2[j], in1[j], in2[j]);
+		__m128 sum = _mm_setzero_ps();
+		for (r = 0; r < 3; ++r) {
+			const __m128 out = _mm_sub_ps(
+				_mm_add_ps(_mm_mul_ps(a0[r], in), _mm_mul_ps(b1[r], out1[r])),
+				_mm_mul_ps(b2[r], out2[r]));
+			out2[r] = out1[r];
+			out1[r] = out;
+			sum = _mm_add_ps(sum, out);
+		}
+
+		// lanes 0+2 (left) and 1+3 (right)
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		float outs[4];
+		_mm_storeu_ps(outs, sum);
+		in1[j] = outs[0];
+		in2[j] = outs[1];
+	}
+
+	for (r = 0; r < 3; ++r) {
+		_mm_storeu_ps(&m_a0[r << 2], a0[r]);
+		_mm_storeu_ps(&m_b1[r << 2], b1[r]);
+		_mm_storeu_ps(&m_b2[r << 2], b2[r]);
+		_mm_storeu_ps(&m_out1[r << 2], out1[r]);
+		_mm_storeu_ps(&m_out2[r << 2], out2[r]);
+	}
+
+#else
+
+	uint32_t k;
+
+	for (uint32_t j = 0; j < nframes; ++j) {
+
+		if (update(cutoff[j], reso[j]))
+			reset_coeffs();
+
+		if (m_csteps > 0) {
+			for (k = 0; k < NUM_LANES; ++k) {
+				m_a0[k] += m_a0_step[k];
+				m_b1[k] += m_b1_step[k];
+				m_b2[k] += m_b2_step[k];
+			}
+			--m_csteps;
+		}
+
+		const float in[2] = { in1[j], in2[j] };
+		float sum[2] = { 0.0f, 0.0f };
+		for (k = 0; k < NUM_LANES; ++k) {
+			const float out
+				= m_a0[k] * in[k & 1]
+				+ m_b1[k] * m_out1[k]
+				- m_b2[k] * m_out2[k];
+			m_out2[k] = m_out1[k];
+			m_out1[k] = out;
+			sum[k & 1] += out;
+		}
+
+		in1[j] = sum[0];
+		in2[j] = sum[1];
+	}
+
+#endif
+}
+
+
 // end of samplv1_formant.cpp
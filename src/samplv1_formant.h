@@ -1,7 +1,7 @@
 // samplv1_formant.h
 //
 /****************************************************************************
-   Copyright (C) 2012-2019, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
 
    This program is free software; you can redistribute it and/or
    modify it under the terms of the GNU General Public License
@@ -252,6 +252,95 @@ private:
 };
 
 
+//---------------------------------------------------------------------
+// samplv1_formant2 - stereo formant parallel filter bank (SIMD).
+//
+// All formant bands of both channels are processed in parallel lanes
+// (band i left at lane 2*i, right at lane 2*i+1, zero padded).
+//
+
+class samplv1_formant2
+{
+public:
+
+	typedef samplv1_formant::Impl Impl;
+
+	// ctor.
+	samplv1_formant2(Impl *pImpl = 0)
+		: m_pImpl(pImpl), m_cutoff(0.5f), m_reso(0.0f), m_nstep(0)
+		{ reset(); reset_coeffs(); }
+
+	// reset impl.
+	void reset(Impl *pImpl)
+		{ m_pImpl = pImpl; reset_coeffs(); }
+
+	void reset_filters(float cutoff, float reso)
+	{
+		reset();
+
+		if (update(cutoff, reso))
+			reset_coeffs();
+	}
+
+	// process block (in-place, stereo)
+	void process(float *in1, float *in2,
+		const float *cutoff, const float *reso, uint32_t nframes);
+
+protected:
+
+	// constants
+	static const uint32_t NUM_FORMANTS = samplv1_formant::NUM_FORMANTS;
+	static const uint32_t NUM_STEPS = samplv1_formant::NUM_STEPS;
+	static const uint32_t NUM_LANES = 12;
+
+	// reset filters
+	void reset();
+
+	// update method (true when coeffs. are due)
+	bool update(float cutoff, float reso)
+	{
+		if (m_nstep > 0)
+			--m_nstep;
+		else
+		if (::fabsf(m_cutoff - cutoff) > 0.001f ||
+			::fabsf(m_reso   - reso)   > 0.001f) {
+			m_nstep = NUM_STEPS;
+			m_cutoff = cutoff;
+			m_reso = reso;
+			return true;
+		}
+
+		return false;
+	}
+
+	// reset coeffs. method
+	void reset_coeffs();
+
+private:
+
+	// instance members
+	Impl *m_pImpl;
+
+	// parameters.
+	float m_cutoff;
+	float m_reso;
+
+	// slew-rate control.
+	uint32_t m_nstep;
+
+	// step-wise smoothed coeffs. (per lane)
+	float m_a0[NUM_LANES], m_a0_step[NUM_LANES];
+	float m_b1[NUM_LANES], m_b1_step[NUM_LANES];
+	float m_b2[NUM_LANES], m_b2_step[NUM_LANES];
+
+	uint32_t m_csteps;
+
+	// 2-pole resonators state (per lane)
+	float m_out1[NUM_LANES];
+	float m_out2[NUM_LANES];
+};
+
+
 #endif	// __samplv1_formant_h
 
 // end of samplv1_formant.h
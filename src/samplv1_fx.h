@@ -1,7 +1,7 @@
 // samplv1_fx.h
 //
 /****************************************************************************
-   Copyright (C) 2012-2015, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
 
    This program is free software; you can redistribute it and/or
    modify it under the terms of the GNU General Public License
@@ -315,8 +315,8 @@ public:
 
 	float output(float in, float delay, float feedb)
 	{
-		// calculate delay offset
-		float delta = float(m_frames) - delay;
+		// calculate delay offset (wrapped, for float precision)
+		float delta = float(m_frames & MAX_MASK) - delay;
 		// clip lookback buffer-bound
 		if (delta < 0.0f)
 			delta += float(MAX_SIZE);
@@ -353,14 +353,75 @@ public:
 		//	feedb *= (1.0f - daft);
 		}
 		delay *= float(MAX_SIZE);
-		// process
-		for (uint32_t i = 0; i < nframes; ++i)
-			in[i] += wet * output(in[i], delay, feedb);
+		// process (in blocks)
+		while (nframes > 0) {
+			uint32_t nblock = nframes;
+			if (nblock > MAX_BLOCK)
+				nblock = MAX_BLOCK;
+			// fixed delay: block reads don't overlap block writes?
+			if (delay < float(nblock + 3))
+				nblock = 0;
+			if (nblock > 0) {
+				process_block(in, nblock, wet, delay, feedb);
+			} else {
+				nblock = 1;
+				*in += wet * output(*in, delay, feedb);
+			}
+			in += nblock;
+			nframes -= nblock;
+		}
 	}
 
 	static const uint32_t MAX_SIZE = (1 << 12);	//= 4096;
 	static const uint32_t MAX_MASK = MAX_SIZE - 1;
 
+protected:
+
+	static const uint32_t MAX_BLOCK = 64;
+
+	// fixed delay block: the fractional offset is the same for all
+	// frames, so the 4 samples hermite is just a 4-tap FIR filter.
+	void process_block(float *in, uint32_t nframes,
+		float wet, float delay, float feedb)
+	{
+		float delta = float(m_frames & MAX_MASK) - delay;
+		if (delta < 0.0f)
+			delta += float(MAX_SIZE);
+		const uint32_t index = uint32_t(delta);
+		const float x  = delta - ::floorf(delta);
+		const float x2 = x * x;
+		const float x3 = x * x2;
+		const float w0 = -0.5f * x3 + x2 - 0.5f * x;
+		const float w1 =  1.5f * x3 - 2.5f * x2 + 1.0f;
+		const float w2 = -1.5f * x3 + 2.0f * x2 + 0.5f * x;
+		const float w3 =  0.5f * x3 - 0.5f * x2;
+		// delayed reads (contiguous, unless wrapped)
+		float out[MAX_BLOCK];
+		uint32_t i = 0;
+		while (i < nframes) {
+			const uint32_t k = (index + i) & MAX_MASK;
+			uint32_t n = nframes - i;
+			if (k + n + 3 > MAX_SIZE) {
+				n = (k + 3 < MAX_SIZE ? MAX_SIZE - k - 3 : 0);
+				if (n == 0) {
+					out[i++] = w0 * m_buffer[k]
+						+ w1 * m_buffer[(k + 1) & MAX_MASK]
+						+ w2 * m_buffer[(k + 2) & MAX_MASK]
+						+ w3 * m_buffer[(k + 3) & MAX_MASK];
+					continue;
+				}
+			}
+			const float *y = &m_buffer[k];
+			for (uint32_t j = 0; j < n; ++j, ++i)
+				out[i] = w0 * y[j] + w1 * y[j + 1] + w2 * y[j + 2] + w3 * y[j + 3];
+		}
+		// feedback writes and wet mix
+		for (i = 0; i < nframes; ++i) {
+			m_buffer[(m_frames++) & MAX_MASK] = in[i] + out[i] * feedb;
+			in[i] += wet * out[i];
+		}
+	}
+
 private:
 
 	float m_buffer[MAX_SIZE];
@@ -483,12 +544,29 @@ public:
 		else
 		if (ndelay > MAX_SIZE)
 			ndelay = MAX_SIZE;
-		// delay process
-		for (uint32_t i = 0; i < nframes; ++i) {
-			const uint32_t j = (m_frames++) & MAX_MASK;
-			m_out = m_buffer[(j - ndelay) & MAX_MASK];
-			m_buffer[j] = *in + m_out * feedb;
-			*in++ += wet * m_out;
+		// delay process (in contiguous blocks, no wrap around,
+		// reads never overlapping writes as ndelay >= MIN_SIZE)
+		while (nframes > 0) {
+			const uint32_t j = m_frames & MAX_MASK;
+			const uint32_t k = (j - ndelay) & MAX_MASK;
+			uint32_t nblock = nframes;
+			if (nblock > MIN_SIZE)
+				nblock = MIN_SIZE;
+			if (nblock > MAX_SIZE - j)
+				nblock = MAX_SIZE - j;
+			if (nblock > MAX_SIZE - k)
+				nblock = MAX_SIZE - k;
+			const float *out = &m_buffer[k];
+			float *buf = &m_buffer[j];
+			for (uint32_t i = 0; i < nblock; ++i) {
+				const float y = out[i];
+				buf[i] = in[i] + y * feedb;
+				in[i] += wet * y;
+			}
+			m_out = out[nblock - 1];
+			m_frames += nblock;
+			in += nblock;
+			nframes -= nblock;
 		}
 	}
 
@@ -521,8 +599,14 @@ public:
 		{ m_out = 0.0f; }
 
 	float output(float in, float delay)
+		{ return filter(in, coeff(delay)); }
+
+	// all-pass coefficient (same for all taps of a chain)
+	static float coeff(float delay)
+		{ return (1.0f - delay) / (1.0f + delay); }
+
+	float filter(float in, float a1)
 	{
-		const float a1 = (1.0f - delay) / (1.0f + delay);
 		const float out = m_out - a1 * in;
 		m_out = in + a1 * out;
 		return out;
@@ -577,23 +661,36 @@ public:
 		const float lfo_inc   = 2.0f * M_PI * rate / m_srate;
 		// anti-denormal noise
 		const float adenormal = 1E-14f * float(::rand());
-		// sweep...
-		for (uint32_t i = 0; i < nframes; ++i) {
-			// calculate and update phaser lfo
-			const float delay = delay_min + (delay_max - delay_min)
-				* 0.5f * (1.0f + ::sinf(m_lfo_phase));
+		// sweep... (lfo at control rate, linearly interpolated)
+		const float delay_amp = 0.5f * (delay_max - delay_min);
+		float delay1 = delay_min + delay_amp * (1.0f + ::sinf(m_lfo_phase));
+		while (nframes > 0) {
+			uint32_t nblock = nframes;
+			if (nblock > LFO_STEPS)
+				nblock = LFO_STEPS;
 			// increment phase
-			m_lfo_phase += lfo_inc;
+			m_lfo_phase += lfo_inc * float(nblock);
 			// positive wrap phase
-			if (m_lfo_phase >= 2.0f * M_PI)
+			while (m_lfo_phase >= 2.0f * M_PI)
 				m_lfo_phase -= 2.0f * M_PI;
-			// get input
-			m_out = in[i] + adenormal + m_out * feedb;
-			// update filter coeffs and calculate output
-			for (uint16_t n = 0; n < MAX_TAPS; ++n)
-				m_out = m_taps[n].output(m_out, delay);
-			// output
-			in[i] += wet * m_out * depth;
+			// calculate and update phaser lfo
+			const float delay0 = delay1;
+			delay1 = delay_min + delay_amp * (1.0f + ::sinf(m_lfo_phase));
+			const float delta = (delay1 - delay0) / float(nblock);
+			for (uint32_t i = 0; i < nblock; ++i) {
+				// update filter coeffs (all taps)
+				const float a1
+					= samplv1_fx_allpass::coeff(delay0 + delta * float(i));
+				// get input
+				m_out = in[i] + adenormal + m_out * feedb;
+				// calculate output
+				for (uint16_t n = 0; n < MAX_TAPS; ++n)
+					m_out = m_taps[n].filter(m_out, a1);
+				// output
+				in[i] += wet * m_out * depth;
+			}
+			in += nblock;
+			nframes -= nblock;
 		}
 	}
 
@@ -602,6 +699,7 @@ private:
 	float m_srate;
 
 	static const uint16_t MAX_TAPS = 6;
+	static const uint32_t LFO_STEPS = 32;
 
 	samplv1_fx_allpass m_taps[MAX_TAPS];
 
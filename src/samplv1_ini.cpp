@@ -0,0 +1,713 @@
+// samplv1_ini.cpp
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "samplv1_ini.h"
+
+#include "samplv1_programs.h"
+#include "samplv1_controls.h"
+
+#include <fstream>
+#include <sstream>
+#include <locale>
+
+#include <mutex>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+
+
+//-------------------------------------------------------------------------
+// Local string helpers.
+
+// Trim leading and trailing whitespace.
+static std::string samplv1_ini_trimmed ( const std::string& s )
+{
+	const char *ws = " \t\r\n";
+	const size_t i = s.find_first_not_of(ws);
+	if (i == std::string::npos)
+		return std::string();
+	const size_t j = s.find_last_not_of(ws);
+	return s.substr(i, j - i + 1);
+}
+
+
+// Hexadecimal digit value (-1 if none).
+static int samplv1_ini_hex ( char ch )
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	return -1;
+}
+
+
+// UTF-16 code units to UTF-8 (surrogate pairs aware).
+class samplv1_ini_utf8
+{
+public:
+
+	samplv1_ini_utf8(std::string& sOut) : m_out(sOut), m_high(0) {}
+
+	void append(unsigned long ch)
+	{
+		if (ch >= 0xd800 && ch < 0xdc00) {
+			m_high = ch;
+			return;
+		}
+		if (ch >= 0xdc00 && ch < 0xe000 && m_high) {
+			ch = 0x10000 + ((m_high - 0xd800) << 10) + (ch - 0xdc00);
+		}
+		m_high = 0;
+		if (ch < 0x80) {
+			m_out += char(ch);
+		}
+		else
+		if (ch < 0x800) {
+			m_out += char(0xc0 | (ch >> 6));
+			m_out += char(0x80 | (ch & 0x3f));
+		}
+		else
+		if (ch < 0x10000) {
+			m_out += char(0xe0 | (ch >> 12));
+			m_out += char(0x80 | ((ch >> 6) & 0x3f));
+			m_out += char(0x80 | (ch & 0x3f));
+		}
+		else {
+			m_out += char(0xf0 | (ch >> 18));
+			m_out += char(0x80 | ((ch >> 12) & 0x3f));
+			m_out += char(0x80 | ((ch >> 6) & 0x3f));
+			m_out += char(0x80 | (ch & 0x3f));
+		}
+	}
+
+private:
+
+	std::string& m_out;
+	unsigned long m_high;
+};
+
+
+//-------------------------------------------------------------------------
+// samplv1_ini - Prototype settings reader (plain INI, read-only).
+//
+
+// Default settings file path.
+static std::string samplv1_ini_fileName (void)
+{
+	// Same location as QSettings(SAMPLV1_DOMAIN, SAMPLV1_TITLE)...
+	std::string sConfigDir;
+	const char *pszConfigHome = ::getenv("XDG_CONFIG_HOME");
+	if (pszConfigHome && pszConfigHome[0] == '/') {
+		sConfigDir = pszConfigHome;
+	} else {
+		const char *pszHome = ::getenv("HOME");
+		if (pszHome)
+			sConfigDir = pszHome;
+		sConfigDir += "/.config";
+	}
+
+	return sConfigDir + "/" SAMPLV1_DOMAIN "/" SAMPLV1_TITLE ".conf";
+}
+
+
+// Constructor (reads the default settings file).
+samplv1_ini::samplv1_ini (void) : m_refcount(0)
+{
+	load(samplv1_ini_fileName());
+
+	iPitchShiftType = intValue("Default/PitchShiftType", 0);
+	iSampleInterpType = intValue("Default/SampleInterpType", 0);
+	iSampleStorageType = intValue("Default/SampleStorageType", 0);
+	bControlsEnabled = boolValue("Default/ControlsEnabled", false);
+	bProgramsEnabled = boolValue("Default/ProgramsEnabled", false);
+	bProgramsPreload = boolValue("Default/ProgramsPreload", false);
+
+	// Micro-tuning options.
+	bTuningEnabled = boolValue("Tuning/Enabled", false);
+	fTuningRefPitch = floatValue("Tuning/RefPitch", 440.0f);
+	iTuningRefNote = intValue("Tuning/RefNote", 69);
+	sTuningScaleFile = value("Tuning/ScaleFile");
+	sTuningKeyMapFile = value("Tuning/KeyMapFile");
+}
+
+
+//-------------------------------------------------------------------------
+// samplv1_ini_watcher - settings file change detection.
+//
+// Watches the settings directory (QSettings saves by renaming a temporary
+// file over the old one) through inotify, where available; otherwise, or
+// whenever the directory can't be watched, falls back to a stat() check.
+//
+
+class samplv1_ini_watcher
+{
+public:
+
+	// ctor.
+	samplv1_ini_watcher(const std::string& sFileName)
+		: m_sFileName(sFileName), m_inotify(-1), m_watch(-1)
+	{
+		const size_t i = m_sFileName.rfind('/');
+		m_sName = m_sFileName.substr(i + 1);
+	#ifdef HAVE_SYS_INOTIFY_H
+		m_inotify = ::inotify_init();
+		if (m_inotify >= 0) {
+			::fcntl(m_inotify, F_SETFL,
+				::fcntl(m_inotify, F_GETFL) | O_NONBLOCK);
+			if (i != std::string::npos) {
+				m_watch = ::inotify_add_watch(m_inotify,
+					m_sFileName.substr(0, i).c_str(),
+					IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+			}
+		}
+	#endif
+		stat_file(m_stat);
+	}
+
+	// dtor.
+	~samplv1_ini_watcher()
+	{
+	#ifdef HAVE_SYS_INOTIFY_H
+		if (m_inotify >= 0)
+			::close(m_inotify);
+	#endif
+	}
+
+	// whether the file has changed since last check.
+	bool changed()
+	{
+	#ifdef HAVE_SYS_INOTIFY_H
+		if (m_watch >= 0) {
+			bool bChanged = false;
+			char buf[4096]
+				__attribute__ ((aligned(__alignof__(struct inotify_event))));
+			ssize_t len;
+			while ((len = ::read(m_inotify, buf, sizeof(buf))) > 0) {
+				const char *ptr = buf;
+				while (ptr < buf + len) {
+					const struct inotify_event *event
+						= (const struct inotify_event *) ptr;
+					if (event->mask & IN_IGNORED) {
+						// Directory gone: fall back to stat()...
+						m_watch = -1;
+						bChanged = true;
+					}
+					else
+					if (event->len > 0 && m_sName == event->name)
+						bChanged = true;
+					ptr += sizeof(struct inotify_event) + event->len;
+				}
+			}
+			return bChanged;
+		}
+	#endif
+		struct stat st;
+		stat_file(st);
+		const bool bChanged
+			= (st.st_mtime != m_stat.st_mtime
+			|| st.st_size  != m_stat.st_size
+			|| st.st_ino   != m_stat.st_ino);
+		m_stat = st;
+		return bChanged;
+	}
+
+protected:
+
+	void stat_file(struct stat& st) const
+	{
+		if (::stat(m_sFileName.c_str(), &st) != 0)
+			::memset(&st, 0, sizeof(st));
+	}
+
+private:
+
+	// instance variables.
+	std::string m_sFileName;
+	std::string m_sName;
+
+	int m_inotify;
+	int m_watch;
+
+	struct stat m_stat;
+};
+
+
+// Shared snapshot state.
+static std::mutex g_ini_mutex;
+
+static samplv1_ini *g_ini_snapshot = nullptr;
+static samplv1_ini_watcher *g_ini_watcher = nullptr;
+static unsigned int g_ini_refcount = 0;
+
+
+// Shared settings snapshot (process-wide, reference counted).
+samplv1_ini *samplv1_ini::acquire (void)
+{
+	std::lock_guard<std::mutex> lock(g_ini_mutex);
+
+	if (g_ini_snapshot && g_ini_watcher && g_ini_watcher->changed()) {
+		// Stale: detach, current holders keep their own copy...
+		if (--g_ini_snapshot->m_refcount == 0)
+			delete g_ini_snapshot;
+		g_ini_snapshot = nullptr;
+	}
+
+	if (g_ini_snapshot == nullptr) {
+		// Watch first, so that no change goes amiss while loading...
+		if (g_ini_watcher == nullptr)
+			g_ini_watcher = new samplv1_ini_watcher(samplv1_ini_fileName());
+		g_ini_snapshot = new samplv1_ini();
+		++g_ini_snapshot->m_refcount; // the shared one.
+	}
+
+	++g_ini_snapshot->m_refcount;
+	++g_ini_refcount;
+
+	return g_ini_snapshot;
+}
+
+
+void samplv1_ini::release ( samplv1_ini *pIni )
+{
+	if (pIni == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(g_ini_mutex);
+
+	if (--pIni->m_refcount == 0)
+		delete pIni;
+
+	// Last one out turns off the lights...
+	if (g_ini_refcount > 0 && --g_ini_refcount == 0) {
+		if (g_ini_snapshot && --g_ini_snapshot->m_refcount == 0)
+			delete g_ini_snapshot;
+		g_ini_snapshot = nullptr;
+		if (g_ini_watcher)
+			delete g_ini_watcher;
+		g_ini_watcher = nullptr;
+	}
+}
+
+
+// Settings file directory path.
+std::string samplv1_ini::filePath ( const std::string& sName ) const
+{
+	const size_t i = m_sFileName.rfind('/');
+	if (i == std::string::npos)
+		return sName;
+	else
+		return m_sFileName.substr(0, i + 1) + sName;
+}
+
+
+// Preset utility methods.
+std::string samplv1_ini::presetFile ( const std::string& sPreset ) const
+{
+	return value("Presets/" + sPreset);
+}
+
+
+// Programs utility methods.
+void samplv1_ini::loadPrograms ( samplv1_programs *pPrograms ) const
+{
+	pPrograms->clear_banks();
+
+	const std::vector<std::string>& bank_keys = childKeys("Programs");
+	std::vector<std::string>::const_iterator bank_iter = bank_keys.begin();
+	for ( ; bank_iter != bank_keys.end(); ++bank_iter) {
+		const std::string& bank_key = *bank_iter;
+		const uint16_t bank_id = ::atoi(bank_key.c_str());
+		const std::string& bank_name
+			= value("Programs/" + bank_key);
+		samplv1_programs::Bank *pBank = pPrograms->add_bank(bank_id, bank_name);
+		const std::string& sGroup = "Programs/Bank_" + bank_key;
+		const std::vector<std::string>& prog_keys = childKeys(sGroup);
+		std::vector<std::string>::const_iterator prog_iter = prog_keys.begin();
+		for ( ; prog_iter != prog_keys.end(); ++prog_iter) {
+			const std::string& prog_key = *prog_iter;
+			const uint16_t prog_id = ::atoi(prog_key.c_str());
+			const std::string& prog_name
+				= value(sGroup + '/' + prog_key);
+			pBank->add_prog(prog_id, prog_name);
+		}
+	}
+
+	pPrograms->enabled(bProgramsEnabled);
+	pPrograms->preload(bProgramsPreload);
+}
+
+
+// Controllers utility methods.
+void samplv1_ini::loadControls ( samplv1_controls *pControls ) const
+{
+	samplv1_controls::Map map;
+
+	const std::vector<std::string>& keys = childKeys("Controllers");
+	std::vector<std::string>::const_iterator iter = keys.begin();
+	for ( ; iter != keys.end(); ++iter) {
+		const std::string& sKey = *iter;
+		std::vector<std::string> clist;
+		std::istringstream ss(sKey);
+		std::string sItem;
+		while (std::getline(ss, sItem, '_'))
+			clist.push_back(sItem);
+		if (clist.size() < 4 || clist.at(0) != "Control")
+			continue;
+		const unsigned short channel
+			= ::atoi(clist.at(1).c_str());
+		const samplv1_controls::Type ctype
+			= samplv1_controls::typeFromText(clist.at(2).c_str());
+		samplv1_controls::Key key;
+		key.status = ctype | (channel & 0x1f);
+		key.param = ::atoi(clist.at(3).c_str());
+		const std::vector<std::string>& vlist
+			= values("Controllers/" + sKey);
+		if (vlist.empty())
+			continue;
+		samplv1_controls::Data data;
+		data.index = ::atoi(vlist.at(0).c_str());
+		if (vlist.size() > 1)
+			data.flags = ::atoi(vlist.at(1).c_str());
+		map[key] = data;
+	}
+
+	pControls->set_map(map);
+	pControls->enabled(bControlsEnabled);
+}
+
+
+// Explicit I/O methods.
+bool samplv1_ini::load ( const std::string& sFileName )
+{
+	m_sFileName = sFileName;
+	m_values.clear();
+
+	std::ifstream fs(sFileName.c_str());
+	if (!fs.is_open())
+		return false;
+
+	std::string sGroup;
+	std::string sLine;
+
+	while (std::getline(fs, sLine)) {
+		// Backslash line continuation...
+		std::string sNext;
+		while (!sLine.empty() && sLine[sLine.length() - 1] == '\\'
+			&& std::getline(fs, sNext)) {
+			sLine += '\n';
+			sLine += sNext;
+		}
+		const std::string& sText = samplv1_ini_trimmed(sLine);
+		if (sText.empty() || sText[0] == ';' || sText[0] == '#')
+			continue;
+		if (sText[0] == '[') {
+			const size_t j = sText.find(']');
+			sGroup = unescapedKey(samplv1_ini_trimmed(
+				sText.substr(1, j == std::string::npos ? j : j - 1)));
+			if (sGroup == "General")
+				sGroup.clear();
+			continue;
+		}
+		const size_t i = sText.find('=');
+		if (i == std::string::npos)
+			continue;
+		std::string sKey = unescapedKey(
+			samplv1_ini_trimmed(sText.substr(0, i)));
+		if (sKey.empty())
+			continue;
+		if (!sGroup.empty())
+			sKey = sGroup + '/' + sKey;
+		m_values[sKey] = sText.substr(i + 1);
+	}
+
+	return true;
+}
+
+
+// Value accessors (full key path, eg. "Group/Key").
+std::string samplv1_ini::value (
+	const std::string& sKey, const std::string& sDefault ) const
+{
+	std::map<std::string, std::string>::const_iterator iter
+		= m_values.find(sKey);
+	if (iter == m_values.end())
+		return sDefault;
+
+	const std::vector<std::string>& list = unescapedValues(iter->second);
+	if (list.size() != 1)
+		return std::string();
+
+	// Special (non-string) variant values...
+	const std::string& sValue = list.front();
+	if (sValue.compare(0, 2, "@@") == 0)
+		return sValue.substr(1);
+	if (sValue.compare(0, 11, "@ByteArray(") == 0
+		&& sValue[sValue.length() - 1] == ')')
+		return sValue.substr(11, sValue.length() - 12);
+	if (sValue.compare(0, 9, "@Invalid(") == 0)
+		return sDefault;
+
+	return sValue;
+}
+
+
+std::vector<std::string> samplv1_ini::values ( const std::string& sKey ) const
+{
+	std::map<std::string, std::string>::const_iterator iter
+		= m_values.find(sKey);
+	if (iter == m_values.end())
+		return std::vector<std::string>();
+	else
+		return unescapedValues(iter->second);
+}
+
+
+int samplv1_ini::intValue ( const std::string& sKey, int iDefault ) const
+{
+	const std::string& sValue = value(sKey);
+	if (sValue.empty())
+		return iDefault;
+
+	char *end = nullptr;
+	const long ret = ::strtol(sValue.c_str(), &end, 10);
+	return (end && *end == '\0' ? int(ret) : iDefault);
+}
+
+
+float samplv1_ini::floatValue ( const std::string& sKey, float fDefault ) const
+{
+	const std::string& sValue = value(sKey);
+	if (sValue.empty())
+		return fDefault;
+
+	// Always the C locale (as written by QSettings)...
+	std::istringstream ss(sValue);
+	ss.imbue(std::locale::classic());
+	double ret = 0.0;
+	ss >> ret;
+	return (ss.fail() ? fDefault : float(ret));
+}
+
+
+bool samplv1_ini::boolValue ( const std::string& sKey, bool bDefault ) const
+{
+	const std::string& sValue = value(sKey);
+	if (sValue.empty())
+		return bDefault;
+
+	if (sValue == "true")
+		return true;
+	if (sValue == "false")
+		return false;
+
+	char *end = nullptr;
+	const long ret = ::strtol(sValue.c_str(), &end, 10);
+	return (end && *end == '\0' ? (ret != 0) : bDefault);
+}
+
+
+// Child keys of a group (sorted).
+std::vector<std::string> samplv1_ini::childKeys ( const std::string& sGroup ) const
+{
+	std::vector<std::string> keys;
+
+	const std::string& sPrefix = sGroup + '/';
+	std::map<std::string, std::string>::const_iterator iter
+		= m_values.lower_bound(sPrefix);
+	for ( ; iter != m_values.end(); ++iter) {
+		const std::string& sKey = iter->first;
+		if (sKey.compare(0, sPrefix.length(), sPrefix) != 0)
+			break;
+		const std::string& sChild = sKey.substr(sPrefix.length());
+		if (!sChild.empty() && sChild.find('/') == std::string::npos)
+			keys.push_back(sChild);
+	}
+
+	return keys;
+}
+
+
+// QSettings INI format key unescaping ('\' as '/', %XX and %UXXXX).
+std::string samplv1_ini::unescapedKey ( const std::string& sKey )
+{
+	std::string sOut;
+	samplv1_ini_utf8 utf8(sOut);
+
+	const size_t len = sKey.length();
+	size_t i = 0;
+	while (i < len) {
+		const char ch = sKey[i];
+		if (ch == '\\') {
+			sOut += '/';
+			++i;
+			continue;
+		}
+		if (ch != '%' || i == len - 1) {
+			sOut += ch;
+			++i;
+			continue;
+		}
+		size_t j = i + 1;
+		size_t ndigits = 2;
+		if (sKey[j] == 'U') {
+			++j;
+			ndigits = 4;
+		}
+		unsigned long code = 0;
+		size_t k = 0;
+		for ( ; k < ndigits && j + k < len; ++k) {
+			const int h = samplv1_ini_hex(sKey[j + k]);
+			if (h < 0)
+				break;
+			code = (code << 4) | h;
+		}
+		if (k < ndigits) {
+			sOut += '%';
+			++i;
+			continue;
+		}
+		utf8.append(code);
+		i = j + ndigits;
+	}
+
+	return sOut;
+}
+
+
+// QSettings INI format value unescaping (quotes, escapes and lists).
+std::vector<std::string> samplv1_ini::unescapedValues ( const std::string& sValue )
+{
+	std::vector<std::string> list;
+
+	std::string sOut;
+	samplv1_ini_utf8 utf8(sOut);
+
+	bool bQuoted = false;
+	bool bInQuotes = false;
+	size_t iChop = 0;
+
+	const size_t len = sValue.length();
+	size_t i = 0;
+
+	while (i < len && (sValue[i] == ' ' || sValue[i] == '\t'))
+		++i;
+
+	while (i < len) {
+		const char ch = sValue[i];
+		if (ch == '\\') {
+			if (++i >= len)
+				break;
+			const char ch2 = sValue[i++];
+			switch (ch2) {
+			case 'a':  sOut += '\a'; break;
+			case 'b':  sOut += '\b'; break;
+			case 'f':  sOut += '\f'; break;
+			case 'n':  sOut += '\n'; break;
+			case 'r':  sOut += '\r'; break;
+			case 't':  sOut += '\t'; break;
+			case 'v':  sOut += '\v'; break;
+			case '"':
+			case '?':
+			case '\'':
+			case '\\': sOut += ch2;  break;
+			case 'x': {
+				unsigned long code = 0;
+				while (i < len && samplv1_ini_hex(sValue[i]) >= 0)
+					code = (code << 4) | samplv1_ini_hex(sValue[i++]);
+				utf8.append(code);
+				break;
+			}
+			case '\n':
+			case '\r':
+				// line continuation...
+				if (i < len && (sValue[i] == '\n' || sValue[i] == '\r')
+					&& sValue[i] != ch2)
+					++i;
+				break;
+			default:
+				if (ch2 >= '0' && ch2 <= '7') {
+					unsigned long code = (ch2 - '0');
+					while (i < len && sValue[i] >= '0' && sValue[i] <= '7')
+						code = (code << 3) | (sValue[i++] - '0');
+					utf8.append(code);
+				}
+				break;
+			}
+			iChop = sOut.length();
+		}
+		else
+		if (ch == '"') {
+			++i;
+			bQuoted = true;
+			bInQuotes = !bInQuotes;
+			if (!bInQuotes) {
+				iChop = sOut.length();
+				while (i < len && (sValue[i] == ' ' || sValue[i] == '\t'))
+					++i;
+			}
+		}
+		else
+		if (ch == ',' && !bInQuotes) {
+			if (!bQuoted) {
+				size_t n = sOut.length();
+				while (n > iChop && (sOut[n - 1] == ' ' || sOut[n - 1] == '\t'))
+					--n;
+				sOut.erase(n);
+			}
+			list.push_back(sOut);
+			sOut.clear();
+			bQuoted = false;
+			iChop = 0;
+			++i;
+			while (i < len && (sValue[i] == ' ' || sValue[i] == '\t'))
+				++i;
+		}
+		else {
+			sOut += ch;
+			++i;
+		}
+	}
+
+	if (!bQuoted) {
+		size_t n = sOut.length();
+		while (n > iChop && (sOut[n - 1] == ' ' || sOut[n - 1] == '\t'))
+			--n;
+		sOut.erase(n);
+	}
+
+	list.push_back(sOut);
+
+	return list;
+}
+
+
+// end of samplv1_ini.cpp
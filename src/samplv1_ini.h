@@ -0,0 +1,130 @@
+// samplv1_ini.h
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __samplv1_ini_h
+#define __samplv1_ini_h
+
+#include "config.h"
+
+#define SAMPLV1_TITLE       PACKAGE_NAME
+
+#define SAMPLV1_DOMAIN      "rncbc.org"
+
+#include <string>
+#include <vector>
+#include <map>
+
+
+// forward decls.
+class samplv1_programs;
+class samplv1_controls;
+
+
+//-------------------------------------------------------------------------
+// samplv1_ini - Prototype settings reader (plain INI, read-only).
+//
+// Reads the very same file and format as samplv1_config (QSettings),
+// for the engine core alone, without any Qt dependency.
+//
+// Engine instances share one read-only snapshot per process (see
+// acquire/release), which is only re-read after the file changes.
+//
+
+class samplv1_ini
+{
+public:
+
+	// Constructor (reads the default settings file).
+	samplv1_ini();
+
+	// Shared settings snapshot (process-wide, reference counted).
+	static samplv1_ini *acquire();
+	static void release(samplv1_ini *pIni);
+
+	// Default options...
+	int iPitchShiftType;
+	int iSampleInterpType;
+	int iSampleStorageType;
+
+	// Special persistent options.
+	bool bControlsEnabled;
+	bool bProgramsEnabled;
+	bool bProgramsPreload;
+
+	// Micro-tuning options.
+	bool  bTuningEnabled;
+	float fTuningRefPitch;
+	int   iTuningRefNote;
+	std::string sTuningScaleFile;
+	std::string sTuningKeyMapFile;
+
+	// Settings file path (same as QSettings::fileName()).
+	const std::string& fileName() const
+		{ return m_sFileName; }
+
+	// Settings file directory path.
+	std::string filePath(const std::string& sName) const;
+
+	// Preset utility methods.
+	std::string presetFile(const std::string& sPreset) const;
+
+	// Programs utility methods.
+	void loadPrograms(samplv1_programs *pPrograms) const;
+
+	// Controllers utility methods.
+	void loadControls(samplv1_controls *pControls) const;
+
+protected:
+
+	// Explicit I/O methods.
+	bool load(const std::string& sFileName);
+
+	// Value accessors (full key path, eg. "Group/Key").
+	std::string value(const std::string& sKey,
+		const std::string& sDefault = std::string()) const;
+	std::vector<std::string> values(const std::string& sKey) const;
+
+	int   intValue(const std::string& sKey, int iDefault) const;
+	float floatValue(const std::string& sKey, float fDefault) const;
+	bool  boolValue(const std::string& sKey, bool bDefault) const;
+
+	// Child keys of a group (sorted).
+	std::vector<std::string> childKeys(const std::string& sGroup) const;
+
+	// QSettings INI format unescaping.
+	static std::string unescapedKey(const std::string& sKey);
+	static std::vector<std::string> unescapedValues(const std::string& sValue);
+
+private:
+
+	// Instance variables.
+	std::string m_sFileName;
+
+	std::map<std::string, std::string> m_values;
+
+	// Shared snapshot reference count.
+	unsigned int m_refcount;
+};
+
+
+#endif	// __samplv1_ini_h
+
+// end of samplv1_ini.h
@@ -27,10 +27,13 @@
 #include "samplv1_controls.h"
 
 #include <jack/midiport.h>
+#include <jack/thread.h>
 
 #include <stdio.h>
 #include <string.h>
 
+#include <semaphore.h>
+
 #include <math.h>
 
 #include <QCoreApplication>
@@ -103,6 +106,93 @@ private:
 #endif	// CONFIG_ALSA_MIDI
 
 
+//-------------------------------------------------------------------------
+// samplv1_jack_worker - parallel rendering worker (real-time) thread.
+
+class samplv1_jack_worker
+{
+public:
+
+	samplv1_jack_worker(samplv1_jack *sampl)
+		: m_sampl(sampl), m_client(nullptr), m_running(false)
+	{
+		::sem_init(&m_sem_start, 0, 0);
+		::sem_init(&m_sem_done, 0, 0);
+	}
+
+	~samplv1_jack_worker()
+	{
+		stop();
+
+		::sem_destroy(&m_sem_done);
+		::sem_destroy(&m_sem_start);
+	}
+
+	// start/stop (JACK client thread).
+	bool start(jack_client_t *client)
+	{
+		m_client = client;
+		m_running = true;
+
+		if (::jack_client_create_thread(m_client, &m_thread,
+				::jack_client_real_time_priority(m_client),
+				::jack_is_realtime(m_client), run, this) != 0) {
+			m_running = false;
+			m_client = nullptr;
+		}
+
+		return m_running;
+	}
+
+	void stop()
+	{
+		if (m_running) {
+			m_running = false;
+			::sem_post(&m_sem_start);
+			::jack_client_stop_thread(m_client, m_thread);
+			m_client = nullptr;
+		}
+	}
+
+	// job signal and wait (real-time safe).
+	void post()
+		{ ::sem_post(&m_sem_start); }
+	void wait()
+		{ while (::sem_wait(&m_sem_done) != 0) {} }
+
+protected:
+
+	// main thread executive.
+	static void *run(void *arg)
+	{
+		samplv1_jack_worker *worker
+			= static_cast<samplv1_jack_worker *> (arg);
+
+		for (;;) {
+			while (::sem_wait(&worker->m_sem_start) != 0) {}
+			if (!worker->m_running)
+				break;
+			worker->m_sampl->process_parts_job();
+			::sem_post(&worker->m_sem_done);
+		}
+
+		return nullptr;
+	}
+
+private:
+
+	samplv1_jack *m_sampl;
+
+	jack_client_t *m_client;
+	jack_native_thread_t m_thread;
+
+	std::atomic<bool> m_running;
+
+	sem_t m_sem_start;
+	sem_t m_sem_done;
+};
+
+
 //-------------------------------------------------------------------------
 // JACK process callback.
 
@@ -117,7 +207,7 @@ int samplv1_jack_process ( jack_nframes_t nframes, void *arg )
 
 static int samplv1_jack_buffer_size ( jack_nframes_t nframes, void *arg )
 {
-	static_cast<samplv1_jack *> (arg)->setBufferSize(nframes);
+	static_cast<samplv1_jack *> (arg)->setBufferSizeParts(nframes);
 
 	return 0;
 }
@@ -154,11 +244,84 @@ static void samplv1_jack_session_event (
 #endif	// CONFIG_JACK_SESSION
 
 
+//-------------------------------------------------------------------------
+// samplv1_jack_part - impl. (multi-instance host mode extra parts)
+//
+
+samplv1_jack_part::samplv1_jack_part (void) : samplv1(2)
+{
+	// init param ports
+	for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i) {
+		const samplv1::ParamIndex index = samplv1::ParamIndex(i);
+		m_params[i] = samplv1_param::paramDefaultValue(index);
+		samplv1::setParamPort(index, &m_params[i]);
+	}
+
+	samplv1::programs()->enabled(true);
+	samplv1::controls()->enabled(true);
+}
+
+
+void samplv1_jack_part::updatePreset ( bool /*bDirty*/ )
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateParam ( samplv1::ParamIndex /*index*/ )
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateParams (void)
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateSample (void)
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateOffsetRange (void)
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateLoopRange (void)
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateLoopFade (void)
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateLoopZero (void)
+{
+	// nothing to do here...
+}
+
+
+void samplv1_jack_part::updateTuning (void)
+{
+	samplv1::resetTuning();
+}
+
+
 //-------------------------------------------------------------------------
 // samplv1_jack - impl.
 //
 
-samplv1_jack::samplv1_jack (const char *client_name) : samplv1(2)
+samplv1_jack::samplv1_jack ( const char *client_name,
+	uint16_t nparts, bool merge, uint16_t njobs ) : samplv1(2)
 {
 	m_client = nullptr;
 
@@ -171,6 +334,44 @@ samplv1_jack::samplv1_jack (const char *client_name) : samplv1(2)
 
 	::memset(m_params, 0, samplv1::NUM_PARAMS * sizeof(float));
 
+	m_nevents = 0;
+
+	// multi-instance host mode parts...
+	if (nparts < 1)
+		nparts = 1;
+	else
+	if (nparts > MAX_PARTS)
+		nparts = MAX_PARTS;
+
+	m_nparts = nparts;
+	m_merge  = merge;
+	m_parts  = new Part [m_nparts];
+	m_nsize  = 0;
+	m_zeros  = nullptr;
+
+	for (uint16_t p = 0; p < m_nparts; ++p) {
+		Part& part = m_parts[p];
+		part.sampl = (p > 0 ? new samplv1_jack_part() : static_cast<samplv1 *> (this));
+		part.channel = (m_nparts > 1 ? p + 1 : 0);
+		part.audio_outs = nullptr;
+		part.ins  = nullptr;
+		part.outs = nullptr;
+		part.bufs = nullptr;
+	}
+
+	// parallel rendering...
+	if (njobs < 1)
+		njobs = 1;
+	else
+	if (njobs > m_nparts)
+		njobs = m_nparts;
+
+	m_njobs = njobs;
+	m_nworkers = 0;
+	m_workers = nullptr;
+	m_part_next = 0;
+	m_part_nframes = 0;
+
 #ifdef CONFIG_JACK_MIDI
 	m_midi_in = nullptr;
 #endif
@@ -195,6 +396,11 @@ samplv1_jack::~samplv1_jack (void)
 {
 	deactivate();
 	close();
+
+	for (uint16_t p = 1; p < m_nparts; ++p)
+		delete m_parts[p].sampl;
+
+	delete [] m_parts;
 }
 
 
@@ -218,73 +424,276 @@ int samplv1_jack::process ( jack_nframes_t nframes )
 			::jack_port_get_buffer(m_audio_outs[k], nframes));
 	}
 
+	// multi-instance host mode parts buffers...
+	for (uint16_t p = 1; p < m_nparts; ++p) {
+		Part& part = m_parts[p];
+		for (uint16_t k = 0; k < nchannels; ++k) {
+			if (m_merge) {
+				part.outs[k] = part.bufs[k];
+			} else {
+				part.outs[k] = static_cast<float *> (
+					::jack_port_get_buffer(part.audio_outs[k], nframes));
+			}
+		}
+	}
+
 	jack_position_t pos;
 	jack_transport_query(m_client, &pos);
 	if (pos.valid & JackPositionBBT) {
 		const float host_bpm = float(pos.beats_per_minute);
-		if (::fabsf(host_bpm - samplv1::tempo()) > 0.001f)
-			samplv1::setTempo(host_bpm);
+		if (::fabsf(host_bpm - samplv1::tempo()) > 0.001f) {
+			for (uint16_t p = 0; p < m_nparts; ++p)
+				m_parts[p].sampl->setTempo(host_bpm);
+		}
 	}
 
-	uint32_t ndelta = 0;
+	capture_events(nframes);
+
+	if (m_workers) {
+		// parallel rendering...
+		m_part_nframes = nframes;
+		m_part_next.store(0, std::memory_order_release);
+		for (uint16_t w = 0; w < m_nworkers; ++w)
+			m_workers[w]->post();
+		process_parts_job();
+		for (uint16_t w = 0; w < m_nworkers; ++w)
+			m_workers[w]->wait();
+	} else {
+		for (uint16_t p = 0; p < m_nparts; ++p)
+			process_part(p, nframes);
+	}
+
+	// merged outputs mix-down...
+	for (uint16_t p = 1; m_merge && p < m_nparts; ++p) {
+		const Part& part = m_parts[p];
+		for (uint16_t k = 0; k < nchannels; ++k) {
+			const float *buf = part.bufs[k];
+			float *out = outs[k];
+			for (uint32_t n = 0; n < nframes; ++n)
+				out[n] += buf[n];
+		}
+	}
+
+	return 0;
+}
+
+
+// MIDI events capture (per cycle).
+void samplv1_jack::capture_events ( jack_nframes_t nframes )
+{
+	m_nevents = 0;
 
 #ifdef CONFIG_JACK_MIDI
 	void *midi_in = ::jack_port_get_buffer(m_midi_in, nframes);
 	if (midi_in) {
 		const uint32_t nevents = ::jack_midi_get_event_count(midi_in);
-		for (uint32_t n = 0; n < nevents; ++n) {
+		for (uint32_t n = 0; n < nevents && m_nevents < MAX_EVENTS; ++n) {
 			jack_midi_event_t event;
 			::jack_midi_event_get(&event, midi_in, n);
-			if (event.time > ndelta) {
-				const uint32_t nread = event.time - ndelta;
-				if (nread > 0) {
-					samplv1::process(ins, outs, nread);
-					for (uint16_t k = 0; k < nchannels; ++k) {
-						ins[k]  += nread;
-						outs[k] += nread;
-					}
-				}
-				ndelta = event.time;
-			}
-			samplv1::process_midi(event.buffer, event.size);
+			Event& ev = m_events[m_nevents++];
+			ev.time = event.time;
+			ev.size = event.size;
+			ev.data = event.buffer;
 		}
 	}
 #endif
 #ifdef CONFIG_ALSA_MIDI
 	const jack_nframes_t buffer_size = ::jack_get_buffer_size(m_client);
 	const jack_nframes_t frame_time  = ::jack_last_frame_time(m_client);
-	uint8_t event_buffer[1024];
+	uint32_t ndata = 0;
 	jack_midi_event_t event;
 	while (::jack_ringbuffer_peek(m_alsa_buffer,
 			(char *) &event, sizeof(event)) == sizeof(event)) {
 		if (event.time > frame_time)
 			break;
+		if (event.size > MAX_EVENT_DATA) {
+			// way too big, drop it...
+			::jack_ringbuffer_read_advance(m_alsa_buffer,
+				sizeof(event) + event.size);
+			continue;
+		}
+		// no more room, leave it for the next cycle...
+		if (m_nevents >= MAX_EVENTS || ndata + event.size > MAX_EVENT_DATA)
+			break;
 		jack_nframes_t event_time = frame_time - event.time;
 		if (event_time > buffer_size)
 			event_time = 0;
 		else
 			event_time = buffer_size - event_time;
-		if (event_time > ndelta) {
-			const uint32_t nread = event_time - ndelta;
+		::jack_ringbuffer_read_advance(m_alsa_buffer, sizeof(event));
+		Event& ev = m_events[m_nevents++];
+		ev.time = event_time;
+		ev.size = event.size;
+		ev.data = &m_event_data[ndata];
+		::jack_ringbuffer_read(m_alsa_buffer, (char *) ev.data, ev.size);
+		ndata += ev.size;
+	}
+#endif // CONFIG_ALSA_MIDI
+}
+
+
+// process one part, split on its MIDI events.
+void samplv1_jack::process_part ( uint16_t ipart, jack_nframes_t nframes )
+{
+	const Part& part = m_parts[ipart];
+	samplv1 *pSampl = part.sampl;
+
+	const uint16_t nchannels = pSampl->channels();
+	float *ins[nchannels], *outs[nchannels];
+	for (uint16_t k = 0; k < nchannels; ++k) {
+		ins[k]  = part.ins[k];
+		outs[k] = part.outs[k];
+		// nb. left untouched while not running (eg. loading presets),
+		// which would be otherwise mixed down as stale garbage...
+		::memset(outs[k], 0, nframes * sizeof(float));
+	}
+
+	uint32_t ndelta = 0;
+
+	for (uint32_t n = 0; n < m_nevents; ++n) {
+		const Event& event = m_events[n];
+		// MIDI channel routing (host mode only)...
+		if (part.channel > 0 && event.size > 0 && event.data[0] < 0xf0
+			&& int(event.data[0] & 0x0f) + 1 != part.channel)
+			continue;
+		if (event.time > ndelta) {
+			const uint32_t nread = event.time - ndelta;
 			if (nread > 0) {
-				samplv1::process(ins, outs, nread);
+				pSampl->process(ins, outs, nread);
 				for (uint16_t k = 0; k < nchannels; ++k) {
 					ins[k]  += nread;
 					outs[k] += nread;
 				}
 			}
-			ndelta = event_time;
+			ndelta = event.time;
 		}
-		::jack_ringbuffer_read_advance(m_alsa_buffer, sizeof(event));
-		::jack_ringbuffer_read(m_alsa_buffer, (char *) event_buffer, event.size);
-		samplv1::process_midi(event_buffer, event.size);
+		pSampl->process_midi(event.data, event.size);
 	}
-#endif // CONFIG_ALSA_MIDI
 
 	if (nframes > ndelta)
-		samplv1::process(ins, outs, nframes - ndelta);
+		pSampl->process(ins, outs, nframes - ndelta);
+}
 
-	return 0;
+
+// parallel rendering worker job.
+void samplv1_jack::process_parts_job (void)
+{
+	uint32_t ipart = m_part_next.fetch_add(1, std::memory_order_acq_rel);
+	while (ipart < m_nparts) {
+		process_part(ipart, m_part_nframes);
+		ipart = m_part_next.fetch_add(1, std::memory_order_acq_rel);
+	}
+}
+
+
+// buffer-size change (all parts).
+void samplv1_jack::setBufferSizeParts ( uint32_t nsize )
+{
+	for (uint16_t p = 0; p < m_nparts; ++p)
+		m_parts[p].sampl->setBufferSize(nsize);
+
+	alloc_parts(nsize);
+}
+
+
+// multi-instance host mode parts accessors.
+uint16_t samplv1_jack::parts (void) const
+{
+	return m_nparts;
+}
+
+
+samplv1 *samplv1_jack::part ( uint16_t ipart ) const
+{
+	return (ipart < m_nparts ? m_parts[ipart].sampl : nullptr);
+}
+
+
+// multi-instance host mode parts buffers.
+void samplv1_jack::alloc_parts ( uint32_t nsize )
+{
+	free_parts();
+
+	if (m_nparts < 2)
+		return;
+
+	m_nsize = nsize;
+	m_zeros = new float [m_nsize];
+	::memset(m_zeros, 0, m_nsize * sizeof(float));
+
+	const uint16_t nchannels = samplv1::channels();
+
+	for (uint16_t p = 1; p < m_nparts; ++p) {
+		Part& part = m_parts[p];
+		for (uint16_t k = 0; k < nchannels; ++k) {
+			part.ins[k] = m_zeros;
+			if (m_merge)
+				part.bufs[k] = new float [m_nsize];
+		}
+	}
+}
+
+
+void samplv1_jack::free_parts (void)
+{
+	const uint16_t nchannels = samplv1::channels();
+
+	for (uint16_t p = 1; p < m_nparts; ++p) {
+		Part& part = m_parts[p];
+		for (uint16_t k = 0; part.bufs && k < nchannels; ++k) {
+			if (part.bufs[k]) {
+				delete [] part.bufs[k];
+				part.bufs[k] = nullptr;
+			}
+			part.ins[k] = nullptr;
+		}
+	}
+
+	if (m_zeros) {
+		delete [] m_zeros;
+		m_zeros = nullptr;
+	}
+
+	m_nsize = 0;
+}
+
+
+// parallel rendering workers.
+void samplv1_jack::start_workers (void)
+{
+	if (m_workers || m_njobs < 2 || m_client == nullptr)
+		return;
+
+	// keep only the ones actually started (eg. no RT permission)...
+	m_nworkers = 0;
+	m_workers = new samplv1_jack_worker * [m_njobs - 1];
+	for (uint16_t w = 0; w < m_njobs - 1; ++w) {
+		samplv1_jack_worker *worker = new samplv1_jack_worker(this);
+		if (worker->start(m_client))
+			m_workers[m_nworkers++] = worker;
+		else
+			delete worker;
+	}
+
+	// none at all? fallback to serial rendering...
+	if (m_nworkers < 1) {
+		delete [] m_workers;
+		m_workers = nullptr;
+	}
+}
+
+
+void samplv1_jack::stop_workers (void)
+{
+	if (m_workers == nullptr)
+		return;
+
+	for (uint16_t w = 0; w < m_nworkers; ++w)
+		delete m_workers[w];
+
+	delete [] m_workers;
+	m_workers = nullptr;
+	m_nworkers = 0;
 }
 
 
@@ -332,6 +741,33 @@ void samplv1_jack::open ( const char *client_name )
 		m_outs[k] = nullptr;
 	}
 
+	// multi-instance host mode parts ports & buffers...
+	Part& part0 = m_parts[0];
+	part0.audio_outs = m_audio_outs;
+	part0.ins  = m_ins;
+	part0.outs = m_outs;
+
+	for (uint16_t p = 1; p < m_nparts; ++p) {
+		Part& part = m_parts[p];
+		part.sampl->setSampleRate(float(jack_get_sample_rate(m_client)));
+		part.audio_outs = new jack_port_t * [nchannels];
+		part.ins  = new float * [nchannels];
+		part.outs = new float * [nchannels];
+		part.bufs = new float * [nchannels];
+		for (uint16_t k = 0; k < nchannels; ++k) {
+			part.audio_outs[k] = nullptr;
+			if (!m_merge) {
+				::snprintf(port_name, sizeof(port_name),
+					"part%d_out_%d", p + 1, k + 1);
+				part.audio_outs[k] = ::jack_port_register(m_client,
+					port_name, JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+			}
+			part.ins[k]  = nullptr;
+			part.outs[k] = nullptr;
+			part.bufs[k] = nullptr;
+		}
+	}
+
 	// register midi port
 #ifdef CONFIG_JACK_MIDI
 	m_midi_in = ::jack_port_register(m_client,
@@ -360,7 +796,10 @@ void samplv1_jack::open ( const char *client_name )
 #endif	// CONFIG_ALSA_MIDI
 
 	// setup any local, initial buffers...
-	samplv1::setBufferSize(::jack_get_buffer_size(m_client));
+	setBufferSizeParts(::jack_get_buffer_size(m_client));
+
+	// parallel rendering workers...
+	start_workers();
 
 	::jack_set_buffer_size_callback(m_client,
 		samplv1_jack_buffer_size, this);
@@ -387,7 +826,8 @@ void samplv1_jack::open ( const char *client_name )
 void samplv1_jack::activate (void)
 {
 	if (!m_activated) {
-		samplv1::reset();
+		for (uint16_t p = 0; p < m_nparts; ++p)
+			m_parts[p].sampl->reset();
 		if (m_client) {
 			::jack_activate(m_client);
 			m_activated = true;
@@ -408,6 +848,9 @@ void samplv1_jack::deactivate (void)
 
 void samplv1_jack::close (void)
 {
+	// stop parallel rendering workers...
+	stop_workers();
+
 #ifdef CONFIG_ALSA_MIDI
 	// close alsa sequencer client...
 	if (m_alsa_seq) {
@@ -447,6 +890,39 @@ void samplv1_jack::close (void)
 	// unregister audio ports
 	const uint16_t nchannels = samplv1::channels();
 
+	free_parts();
+
+	for (uint16_t p = 1; p < m_nparts; ++p) {
+		Part& part = m_parts[p];
+		for (uint16_t k = 0; part.audio_outs && k < nchannels; ++k) {
+			if (part.audio_outs[k]) {
+				::jack_port_unregister(m_client, part.audio_outs[k]);
+				part.audio_outs[k] = nullptr;
+			}
+		}
+		if (part.bufs) {
+			delete [] part.bufs;
+			part.bufs = nullptr;
+		}
+		if (part.outs) {
+			delete [] part.outs;
+			part.outs = nullptr;
+		}
+		if (part.ins) {
+			delete [] part.ins;
+			part.ins = nullptr;
+		}
+		if (part.audio_outs) {
+			delete [] part.audio_outs;
+			part.audio_outs = nullptr;
+		}
+	}
+
+	Part& part0 = m_parts[0];
+	part0.audio_outs = nullptr;
+	part0.ins  = nullptr;
+	part0.outs = nullptr;
+
 	for (uint16_t k = 0; k < nchannels; ++k) {
 		if (m_audio_outs && m_audio_outs[k]) {
 			::jack_port_unregister(m_client, m_audio_outs[k]);
@@ -602,8 +1078,8 @@ void samplv1_jack::sessionEvent ( void *pvSessionArg )
 	args << QCoreApplication::applicationFilePath();
 	args << QString("\"${SESSION_DIR}%1\"").arg(sSessionFile);
 
-	samplv1_param::savePreset(this,
-		QFileInfo(sSessionDir, sSessionFile).absoluteFilePath(), true);
+	samplv1_param::savePreset(this, QFileInfo(sSessionDir, sSessionFile)
+		.absoluteFilePath().toUtf8().constData(), true);
 
 	const QByteArray aCmdLine = args.join(" ").toUtf8();
 	pJackSessionEvent->command_line = ::strdup(aCmdLine.constData());
@@ -690,6 +1166,8 @@ void samplv1_jack::shutdown_close (void)
 {
 	m_activated = false;
 
+	stop_workers();
+
 	if (m_client) {
 		::jack_client_close(m_client);
 		m_client = nullptr;
@@ -739,7 +1217,8 @@ static void samplv1_sigterm_handler ( int /*signo*/ )
 // Constructor.
 samplv1_jack_application::samplv1_jack_application ( int& argc, char **argv )
 	: QObject(nullptr), m_pApp(nullptr), m_bGui(true),
-		m_sClientName(SAMPLV1_TITLE), m_pSampl(nullptr), m_pWidget(nullptr)
+		m_sClientName(SAMPLV1_TITLE), m_iParts(1), m_bMerge(false), m_iJobs(1),
+		m_pConfig(nullptr), m_pSampl(nullptr), m_pWidget(nullptr)
 	  #ifdef CONFIG_NSM
 		, m_pNsmClient(nullptr)
 	  #endif
@@ -752,6 +1231,9 @@ samplv1_jack_application::samplv1_jack_application ( int& argc, char **argv )
 			= QString::fromLocal8Bit(argv[i]);
 		if (sArg == "-g" || sArg == "--no-gui")
 			m_bGui = false;
+		else
+		if (sArg.startsWith("-c") || sArg.startsWith("--convert"))
+			m_bGui = false;
 	}
 
 	if (m_bGui) {
@@ -825,6 +1307,7 @@ samplv1_jack_application::~samplv1_jack_application (void)
 #endif
 	if (m_pWidget) delete m_pWidget;
 	if (m_pSampl) delete m_pSampl;
+	if (m_pConfig) delete m_pConfig;
 	if (m_pApp) delete m_pApp;
 }
 
@@ -862,13 +1345,53 @@ bool samplv1_jack_application::parse_args (void)
 				++i;
 		}
 		else
+		if (sArg == "-c" || sArg == "--convert") {
+			if (sVal.isNull()) {
+				out << QObject::tr("Option -c requires an argument (preset-file).\n\n");
+				return false;
+			}
+			m_sConvertFile = sVal;
+			if (iEqual < 0)
+				++i;
+		}
+		else
+		if (sArg == "-p" || sArg == "--parts") {
+			if (sVal.isNull() || sVal.toInt() < 1) {
+				out << QObject::tr("Option -p requires an argument (number).\n\n");
+				return false;
+			}
+			m_iParts = sVal.toInt();
+			if (iEqual < 0)
+				++i;
+		}
+		else
+		if (sArg == "-m" || sArg == "--mix") {
+			m_bMerge = true;
+		}
+		else
+		if (sArg == "-j" || sArg == "--jobs") {
+			if (sVal.isNull() || sVal.toInt() < 1) {
+				out << QObject::tr("Option -j requires an argument (number).\n\n");
+				return false;
+			}
+			m_iJobs = sVal.toInt();
+			if (iEqual < 0)
+				++i;
+		}
+		else
 		if (sArg == "-h" || sArg == "--help") {
 			out << QObject::tr(
-				"Usage: %1 [options] [preset-file]\n\n"
+				"Usage: %1 [options] [preset-file...]\n\n"
 				SAMPLV1_TITLE " - " SAMPLV1_SUBTITLE "\n\n"
 				"Options:\n\n"
 				"  -g, --no-gui\n\tDisable the graphical user interface (GUI)\n\n"
 				"  -n, --client-name=[label]\n\tSet the JACK client name (default: samplv1)\n\n"
+				"  -c, --convert=[preset-file]\n\tConvert the startup preset file into this one and quit\n"
+				"\t(binary format if suffixed ." SAMPLV1_PRESET_BIN_EXT ", XML otherwise)\n\n"
+				"  -p, --parts=[num]\n\tHost this many instances, each one listening\n"
+				"\ton its own MIDI channel and loading its own preset-file (default: 1)\n\n"
+				"  -m, --mix\n\tMix all the instances down to the same outputs\n\n"
+				"  -j, --jobs=[num]\n\tRender the instances in this many threads (default: 1)\n\n"
 				"  -h, --help\n\tShow help about command line options\n\n"
 				"  -v, --version\n\tShow version information\n\n")
 				.arg(args.at(0));
@@ -908,6 +1431,23 @@ bool samplv1_jack_application::setup (void)
 		return false;
 	}
 
+	// Preset format conversion only...
+	if (!m_sConvertFile.isEmpty()) {
+		QTextStream out(stderr);
+		if (m_presets.isEmpty()) {
+			out << QObject::tr("Option -c requires a preset-file to convert from.\n\n");
+		}
+		else
+		if (!samplv1_param::convertPreset(
+				m_presets.first().toUtf8().constData(),
+				m_sConvertFile.toUtf8().constData())) {
+			out << QObject::tr("Could not convert preset file: \"%1\" to \"%2\".\n\n")
+				.arg(m_presets.first()).arg(m_sConvertFile);
+		}
+		m_pApp->quit();
+		return false;
+	}
+
 	QObject::connect(this,
 		SIGNAL(shutdown_signal()),
 		SLOT(shutdown_slot()));
@@ -917,7 +1457,10 @@ bool samplv1_jack_application::setup (void)
 	const char *client_name
 		= aClientName.constData();
 
-	m_pSampl = new samplv1_jack(client_name);
+	// Settings (UI and application only)...
+	m_pConfig = new samplv1_config();
+
+	m_pSampl = new samplv1_jack(client_name, m_iParts, m_bMerge, m_iJobs);
 
 	if (m_bGui) {
 		m_pWidget = new samplv1widget_jack(m_pSampl);
@@ -929,7 +1472,14 @@ bool samplv1_jack_application::setup (void)
 	}
 	else
 	if (!m_presets.isEmpty())
-		samplv1_param::loadPreset(m_pSampl, m_presets.first());
+		samplv1_param::loadPreset(m_pSampl,
+			m_presets.first().toUtf8().constData());
+
+	// Multi-instance host mode: one preset-file per extra part...
+	const int iParts = qMin(int(m_pSampl->parts()), m_presets.count());
+	for (int i = 1; i < iParts; ++i)
+		samplv1_param::loadPreset(m_pSampl->part(i),
+			m_presets.at(i).toUtf8().constData());
 
 #ifdef CONFIG_NSM
 	// Check whether to participate into a NSM session...
@@ -1011,7 +1561,8 @@ void samplv1_jack_application::openSession (void)
 		if (m_pWidget) {
 			m_pWidget->loadPreset(sFilename);
 		} else {
-			samplv1_param::loadPreset(m_pSampl, sFilename);
+			samplv1_param::loadPreset(m_pSampl,
+				sFilename.toUtf8().constData());
 		}
 	}
 
@@ -1043,7 +1594,8 @@ void samplv1_jack_application::saveSession (void)
 //	const QFileInfo fi(path_name, display_name + '.' + SAMPLV1_TITLE);
 	const QFileInfo fi(path_name, "session." SAMPLV1_TITLE);
 
-	samplv1_param::savePreset(m_pSampl, fi.absoluteFilePath(), true);
+	samplv1_param::savePreset(m_pSampl,
+		fi.absoluteFilePath().toUtf8().constData(), true);
 
 	m_pNsmClient->save_reply();
 	m_pNsmClient->dirty(false);
@@ -26,6 +26,8 @@
 
 #include <jack/jack.h>
 
+#include <atomic>
+
 
 #ifdef CONFIG_ALSA_MIDI
 #include <jack/ringbuffer.h>
@@ -35,6 +37,41 @@ class samplv1_alsa_thread;
 #endif
 
 
+// forward decls.
+class samplv1_jack_worker;
+
+
+//-------------------------------------------------------------------------
+// samplv1_jack_part - decl. (multi-instance host mode extra parts)
+//
+
+class samplv1_jack_part : public samplv1
+{
+public:
+
+	samplv1_jack_part();
+
+protected:
+
+	void updatePreset(bool bDirty);
+	void updateParam(samplv1::ParamIndex index);
+	void updateParams();
+
+	void updateSample();
+
+	void updateOffsetRange();
+	void updateLoopRange();
+	void updateLoopFade();
+	void updateLoopZero();
+
+	void updateTuning();
+
+private:
+
+	float m_params[samplv1::NUM_PARAMS];
+};
+
+
 //-------------------------------------------------------------------------
 // samplv1_jack - decl.
 //
@@ -43,7 +80,8 @@ class samplv1_jack : public samplv1
 {
 public:
 
-	samplv1_jack(const char *client_name);
+	samplv1_jack(const char *client_name,
+		uint16_t nparts = 1, bool merge = false, uint16_t njobs = 1);
 
 	~samplv1_jack();
 
@@ -57,6 +95,16 @@ public:
 
 	int process(jack_nframes_t nframes);
 
+	// buffer-size change (all parts).
+	void setBufferSizeParts(uint32_t nsize);
+
+	// multi-instance host mode parts (first one is this).
+	uint16_t parts() const;
+	samplv1 *part(uint16_t ipart) const;
+
+	// parallel rendering worker job.
+	void process_parts_job();
+
 #ifdef CONFIG_ALSA_MIDI
 	snd_seq_t *alsa_seq() const;
 	void alsa_capture(snd_seq_event_t *ev);
@@ -85,6 +133,20 @@ protected:
 
 	void updateTuning();
 
+	// MIDI events capture (per cycle).
+	void capture_events(jack_nframes_t nframes);
+
+	// process one part, split on its MIDI events.
+	void process_part(uint16_t ipart, jack_nframes_t nframes);
+
+	// multi-instance host mode parts buffers.
+	void alloc_parts(uint32_t nsize);
+	void free_parts();
+
+	// parallel rendering workers.
+	void start_workers();
+	void stop_workers();
+
 private:
 
 	jack_client_t *m_client;
@@ -99,6 +161,48 @@ private:
 
 	float m_params[samplv1::NUM_PARAMS];
 
+	// MIDI events (per cycle).
+	struct Event
+	{
+		uint32_t time;
+		uint32_t size;
+		uint8_t *data;
+	};
+
+	static const uint32_t MAX_EVENTS = 1024;
+	static const uint32_t MAX_EVENT_DATA = 4096;
+
+	Event    m_events[MAX_EVENTS];
+	uint32_t m_nevents;
+
+	uint8_t  m_event_data[MAX_EVENT_DATA];
+
+	// multi-instance host mode parts.
+	struct Part
+	{
+		samplv1 *sampl;
+		int channel;
+		jack_port_t **audio_outs;
+		float **ins;
+		float **outs;
+		float **bufs;
+	};
+
+	static const uint16_t MAX_PARTS = 16;
+
+	uint16_t m_nparts;
+	bool     m_merge;
+	Part    *m_parts;
+	uint32_t m_nsize;
+	float   *m_zeros;
+
+	// parallel rendering.
+	uint16_t m_njobs;
+	uint16_t m_nworkers;
+	samplv1_jack_worker **m_workers;
+	std::atomic<uint32_t> m_part_next;
+	jack_nframes_t m_part_nframes;
+
 #ifdef CONFIG_JACK_MIDI
 	jack_port_t *m_midi_in;
 #endif
@@ -124,6 +228,7 @@ private:
 // forward decls.
 class QCoreApplication;
 class samplv1widget_jack;
+class samplv1_config;
 
 #ifdef CONFIG_NSM
 class samplv1_nsm;
@@ -192,6 +297,14 @@ private:
 	QString m_sClientName;
 	QStringList m_presets;
 
+	int  m_iParts;
+	bool m_bMerge;
+	int  m_iJobs;
+
+	QString m_sConvertFile;
+
+	samplv1_config *m_pConfig;
+
 	samplv1_jack *m_pSampl;
 	samplv1widget_jack *m_pWidget;
 
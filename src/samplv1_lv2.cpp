@@ -20,12 +20,14 @@
 *****************************************************************************/
 
 #include "samplv1_lv2.h"
-#include "samplv1_config.h"
 #include "samplv1_sched.h"
 #include "samplv1_sample.h"
+#include "samplv1_epoch.h"
 
 #include "samplv1_programs.h"
 #include "samplv1_controls.h"
+#include "samplv1_zones.h"
+#include "samplv1_xml.h"
 
 #include "lv2/lv2plug.in/ns/ext/midi/midi.h"
 #include "lv2/lv2plug.in/ns/ext/time/time.h"
@@ -62,12 +64,9 @@
 #endif
 
 #include <stdlib.h>
+#include <limits.h>
 #include <math.h>
 
-#include <QApplication>
-#include <QDomDocument>
-#include <QFileInfo>
-
 
 //-------------------------------------------------------------------------
 // samplv1_lv2 - impl.
@@ -79,9 +78,28 @@ typedef struct {
 	union {
 		uint32_t    key;
 		const char *path;
+		samplv1_sample *sample;
+		struct {
+			samplv1_sample *sample;
+			uint32_t serial;
+			uint32_t epoch;
+		} retire;
 	} data;
 } samplv1_lv2_worker_message;
 
+// atom-like message used internally with worker/response (peaks chunk)
+typedef struct {
+	LV2_Atom atom;
+	uint32_t key;		// serial and chunk index, as requested.
+	uint32_t nchunks;
+	uint16_t channels;
+	uint16_t level;
+	uint32_t frames;
+	uint32_t offset;
+	uint32_t nbins;
+	int8_t   data[samplv1_peaks::CHUNK_SIZE];
+} samplv1_lv2_peaks_message;
+
 
 samplv1_lv2::samplv1_lv2 (
 	double sample_rate, const LV2_Feature *const *host_features )
@@ -95,6 +113,15 @@ samplv1_lv2::samplv1_lv2 (
 	m_schedule = nullptr;
 	m_ndelta   = 0;
 
+	m_restore_pending.store(nullptr);
+	m_restore_sample = nullptr;
+
+	m_restore_serial.store(0);
+	m_restore_gc_count.store(0);
+	m_restore_gc_sched.store(false);
+
+	m_peaks_serial = 0;
+
 	const LV2_Options_Option *host_options = nullptr;
 
 	for (int i = 0; host_features && host_features[i]; ++i) {
@@ -136,6 +163,16 @@ samplv1_lv2::samplv1_lv2 (
 					m_urid_map->handle, SAMPLV1_LV2_PREFIX "P108_SAMPLE_OTABS");
 				m_urids.gen1_update = m_urid_map->map(
 					m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_UPDATE");
+				m_urids.gen1_restore = m_urid_map->map(
+					m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_RESTORE");
+				m_urids.gen1_retire = m_urid_map->map(
+					m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_RETIRE");
+				m_urids.gen1_peaks = m_urid_map->map(
+					m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_PEAKS");
+				m_urids.gen1_peaks_info = m_urid_map->map(
+					m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_PEAKS_INFO");
+				m_urids.gen1_peaks_data = m_urid_map->map(
+					m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_PEAKS_DATA");
 				m_urids.p201_tuning_enabled = m_urid_map->map(
 					m_urid_map->handle, SAMPLV1_LV2_PREFIX "P201_TUNING_ENABLED");
 				m_urids.p202_tuning_refPitch = m_urid_map->map(
@@ -160,6 +197,8 @@ samplv1_lv2::samplv1_lv2 (
 					m_urid_map->handle, LV2_ATOM__Bool);
 				m_urids.atom_Path = m_urid_map->map(
 					m_urid_map->handle, LV2_ATOM__Path);
+				m_urids.atom_Chunk = m_urid_map->map(
+					m_urid_map->handle, LV2_ATOM__Chunk);
 			#ifdef CONFIG_LV2_PORT_EVENT
 				m_urids.atom_PortEvent = m_urid_map->map(
 					m_urid_map->handle, LV2_ATOM__PortEvent);
@@ -240,6 +279,17 @@ samplv1_lv2::samplv1_lv2 (
 
 samplv1_lv2::~samplv1_lv2 (void)
 {
+	// detach from any restored sample, first...
+	samplv1::setSampleFile(nullptr, 0);
+
+	delete m_restore_pending.exchange(nullptr);
+	delete m_restore_sample;
+
+	std::list<RestoreGc>::const_iterator gc_iter = m_restore_gc.begin();
+	for ( ; gc_iter != m_restore_gc.end(); ++gc_iter)
+		delete gc_iter->sample;
+	m_restore_gc.clear();
+
 	delete [] m_outs;
 	delete [] m_ins;
 }
@@ -288,6 +338,15 @@ void samplv1_lv2::run ( uint32_t nframes )
 		lv2_atom_forge_sequence_head(&m_forge, &m_notify_frame, 0);
 	}
 
+	// restored state: swap in the prepared sample...
+	samplv1_sample *pSample = m_restore_pending.exchange(nullptr);
+	if (pSample)
+		restore_swap(pSample);
+
+	// retired ones still held? check again, one worker pass at a time...
+	if (m_restore_gc_count.load() > 0 && !m_restore_gc_sched.exchange(true))
+		restore_retire(nullptr);
+
 	uint32_t ndelta = 0;
 
 	if (m_atom_in) {
@@ -358,13 +417,15 @@ void samplv1_lv2::run ( uint32_t nframes )
 							|| key == m_urids.gen1_offset_start
 						#endif
 							) && type == m_urids.atom_Int) {
-							samplv1_sample *pSample = samplv1::sample();
-							if (pSample) {
-								const uint32_t offset_start
+							if (m_schedule) {
+								samplv1_lv2_worker_message mesg;
+								mesg.atom.type = m_urids.p102_offset_start;
+								mesg.atom.size = sizeof(mesg.data.key);
+								mesg.data.key
 									= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
-								const uint32_t offset_end
-									= pSample->offsetEnd();
-								setOffsetRange(offset_start, offset_end, true);
+								// schedule sample points update
+								m_schedule->schedule_work(
+									m_schedule->handle, sizeof(mesg), &mesg);
 							}
 						}
 						else
@@ -373,13 +434,15 @@ void samplv1_lv2::run ( uint32_t nframes )
 							|| key == m_urids.gen1_offset_end
 						#endif
 							) && type == m_urids.atom_Int) {
-							samplv1_sample *pSample = samplv1::sample();
-							if (pSample) {
-								const uint32_t offset_start
-									= pSample->offsetStart();
-								const uint32_t offset_end
+							if (m_schedule) {
+								samplv1_lv2_worker_message mesg;
+								mesg.atom.type = m_urids.p103_offset_end;
+								mesg.atom.size = sizeof(mesg.data.key);
+								mesg.data.key
 									= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
-								setOffsetRange(offset_start, offset_end, true);
+								// schedule sample points update
+								m_schedule->schedule_work(
+									m_schedule->handle, sizeof(mesg), &mesg);
 							}
 						}
 						else
@@ -388,13 +451,15 @@ void samplv1_lv2::run ( uint32_t nframes )
 							|| key == m_urids.gen1_loop_start
 						#endif
 							) && type == m_urids.atom_Int) {
-							samplv1_sample *pSample = samplv1::sample();
-							if (pSample) {
-								const uint32_t loop_start
+							if (m_schedule) {
+								samplv1_lv2_worker_message mesg;
+								mesg.atom.type = m_urids.p104_loop_start;
+								mesg.atom.size = sizeof(mesg.data.key);
+								mesg.data.key
 									= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
-								const uint32_t loop_end
-									= pSample->loopEnd();
-								setLoopRange(loop_start, loop_end, true);
+								// schedule sample points update
+								m_schedule->schedule_work(
+									m_schedule->handle, sizeof(mesg), &mesg);
 							}
 						}
 						else
@@ -403,13 +468,15 @@ void samplv1_lv2::run ( uint32_t nframes )
 							|| key == m_urids.gen1_loop_end
 						#endif
 							) && type == m_urids.atom_Int) {
-							samplv1_sample *pSample = samplv1::sample();
-							if (pSample) {
-								const uint32_t loop_start
-									= pSample->loopStart();
-								const uint32_t loop_end
+							if (m_schedule) {
+								samplv1_lv2_worker_message mesg;
+								mesg.atom.type = m_urids.p105_loop_end;
+								mesg.atom.size = sizeof(mesg.data.key);
+								mesg.data.key
 									= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
-								setLoopRange(loop_start, loop_end, true);
+								// schedule sample points update
+								m_schedule->schedule_work(
+									m_schedule->handle, sizeof(mesg), &mesg);
 							}
 						}
 						else
@@ -418,9 +485,16 @@ void samplv1_lv2::run ( uint32_t nframes )
 							|| key == m_urids.gen1_loop_fade
 						#endif
 							) && type == m_urids.atom_Int) {
-							const uint32_t loop_fade
-								= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
-							setLoopFade(loop_fade, true);
+							if (m_schedule) {
+								samplv1_lv2_worker_message mesg;
+								mesg.atom.type = m_urids.p106_loop_fade;
+								mesg.atom.size = sizeof(mesg.data.key);
+								mesg.data.key
+									= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
+								// schedule sample points update
+								m_schedule->schedule_work(
+									m_schedule->handle, sizeof(mesg), &mesg);
+							}
 						}
 						else
 						if ((key == m_urids.p107_loop_zero
@@ -432,9 +506,16 @@ void samplv1_lv2::run ( uint32_t nframes )
 							|| type == m_urids.atom_Int
 						#endif
 							)) {
-							const uint32_t loop_zero
-								= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
-							setLoopZero(loop_zero > 0, true);
+							if (m_schedule) {
+								samplv1_lv2_worker_message mesg;
+								mesg.atom.type = m_urids.p107_loop_zero;
+								mesg.atom.size = sizeof(mesg.data.key);
+								mesg.data.key
+									= *(uint32_t *) LV2_ATOM_BODY_CONST(value);
+								// schedule sample points update
+								m_schedule->schedule_work(
+									m_schedule->handle, sizeof(mesg), &mesg);
+							}
 						}
 						else
 						if (key == m_urids.p108_sample_otabs
@@ -498,10 +579,15 @@ void samplv1_lv2::run ( uint32_t nframes )
 					const LV2_Atom_URID *prop = nullptr;
 					lv2_atom_object_get(object,
 						m_urids.patch_property, (const LV2_Atom *) &prop, 0);
-					if (prop && prop->atom.type == m_forge.URID)
-						patch_get(prop->body);
-					else
+					if (prop && prop->atom.type == m_forge.URID) {
+						if (prop->body == m_urids.gen1_peaks)
+							peaks_update();
+						else
+							patch_get(prop->body);
+					} else {
 						patch_get(0); // all
+						peaks_update();
+					}
 				}
 			#endif	// CONFIG_LV2_PATCH
 			}
@@ -537,39 +623,106 @@ uint32_t samplv1_lv2::urid_map ( const char *uri ) const
 }
 
 
-//-------------------------------------------------------------------------
-// samplv1_lv2 - Instantiation and cleanup.
-//
+// thread-safe state restore (any thread, prepared sample hand-over).
+void samplv1_lv2::restore_sample ( samplv1_sample *pSample )
+{
+	// superseded before being ever swapped in? drop it...
+	delete m_restore_pending.exchange(pSample);
+}
 
-QApplication *samplv1_lv2::g_qapp_instance = nullptr;
-unsigned int  samplv1_lv2::g_qapp_refcount = 0;
+
+samplv1_sample *samplv1_lv2::restore_pending (void) const
+{
+	return m_restore_pending.load();
+}
 
 
-void samplv1_lv2::qapp_instantiate (void)
+// thread-safe state restore (audio thread, prepared sample swap).
+void samplv1_lv2::restore_swap ( samplv1_sample *pSample )
 {
-	if (qApp == nullptr && g_qapp_instance == nullptr) {
-		static int s_argc = 1;
-		static const char *s_argv[] = { SAMPLV1_TITLE, nullptr };
-		::setenv("QT_NO_GLIB", "1", 1); // Avoid glib event-loop...
-		g_qapp_instance = new QApplication(s_argc, (char **) s_argv);
+	samplv1::setSample(pSample);
+
+	// retire the previously restored one, after the UI is told...
+	samplv1_sample *pRetired = m_restore_sample;
+	m_restore_sample = pSample;
+
+	if (m_schedule) {
+		samplv1_lv2_worker_message mesg;
+		mesg.atom.type = m_urids.gen1_restore;
+		mesg.atom.size = sizeof(mesg.data.sample);
+		mesg.data.sample = pRetired;
+		m_schedule->schedule_work(
+			m_schedule->handle, sizeof(mesg), &mesg);
 	}
+}
+
 
-	if (g_qapp_instance) ++g_qapp_refcount;
+// restored sample retirement (audio thread, worker hand-over).
+void samplv1_lv2::restore_retire ( samplv1_sample *pSample )
+{
+	if (m_schedule) {
+		samplv1_lv2_worker_message mesg;
+		mesg.atom.type = m_urids.gen1_retire;
+		mesg.atom.size = sizeof(mesg.data.retire);
+		mesg.data.retire.sample = pSample;
+		mesg.data.retire.serial = m_restore_serial.load();
+		mesg.data.retire.epoch  = samplv1::epoch()->current();
+		m_schedule->schedule_work(
+			m_schedule->handle, sizeof(mesg), &mesg);
+	}
 }
 
 
-void samplv1_lv2::qapp_cleanup (void)
+// restored sample retirement (worker thread, deferred free).
+void samplv1_lv2::restore_cleanup (void)
 {
-	if (g_qapp_instance && --g_qapp_refcount == 0) {
-		delete g_qapp_instance;
-		g_qapp_instance = nullptr;
+	std::lock_guard<std::mutex> lock(m_restore_mutex);
+
+	// lowest serial all in-process UIs have switched over to...
+	uint32_t serial = m_restore_serial.load();
+	std::map<const void *, uint32_t>::const_iterator ack_iter
+		= m_restore_acks.begin();
+	for ( ; ack_iter != m_restore_acks.end(); ++ack_iter) {
+		if (int32_t(ack_iter->second - serial) < 0)
+			serial = ack_iter->second;
 	}
+
+	const samplv1_epoch *epoch = samplv1::epoch();
+
+	std::list<RestoreGc>::iterator gc_iter = m_restore_gc.begin();
+	while (gc_iter != m_restore_gc.end()) {
+		const RestoreGc& gc = *gc_iter;
+		if (int32_t(serial - gc.serial) >= 0 && epoch->elapsed(gc.epoch)) {
+			delete gc.sample;
+			gc_iter = m_restore_gc.erase(gc_iter);
+		}
+		else ++gc_iter;
+	}
+
+	m_restore_gc_count.store(m_restore_gc.size());
+}
+
+
+// restored sample retirement (in-process UI acknowledgement).
+uint32_t samplv1_lv2::restore_serial (void) const
+{
+	return m_restore_serial.load();
+}
+
+
+void samplv1_lv2::restore_ack ( const void *pUi, uint32_t serial )
+{
+	std::lock_guard<std::mutex> lock(m_restore_mutex);
+
+	m_restore_acks[pUi] = serial;
 }
 
 
-QApplication *samplv1_lv2::qapp_instance (void)
+void samplv1_lv2::restore_detach ( const void *pUi )
 {
-	return g_qapp_instance;
+	std::lock_guard<std::mutex> lock(m_restore_mutex);
+
+	m_restore_acks.erase(pUi);
 }
 
 
@@ -607,7 +760,12 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 #else
 	flags |= (LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE);
 #endif
-	const char *value = pPlugin->sampleFile();
+	// Restored sample, possibly not swapped in just yet...
+	const samplv1_sample *pSample = pPlugin->restore_pending();
+	if (pSample == nullptr)
+		pSample = pPlugin->sample();
+
+	const char *value = pSample->filename();
 
 	if (value && map_path)
 		value = (*map_path->abstract_path)(map_path->handle, value);
@@ -627,7 +785,7 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 	type = pPlugin->urid_map(LV2_ATOM__Int);
 	if (type) {
 		// Sample octaves...
-		uint32_t otabs = pPlugin->octaves();
+		uint32_t otabs = pSample->otabs();
 		if (otabs > 0) {
 			value = (const char *) &otabs;
 			key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "P108_SAMPLE_OTABS");
@@ -635,8 +793,8 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 				(*store)(handle, key, value, size, type, flags);
 		}
 		// Offset state...
-		uint32_t offset_start = pPlugin->offsetStart();
-		uint32_t offset_end   = pPlugin->offsetEnd();
+		uint32_t offset_start = pSample->offsetStart();
+		uint32_t offset_end   = pSample->offsetEnd();
 		if (offset_start < offset_end) {
 			value = (const char *) &offset_start;
 			key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "P102_OFFSET_START");
@@ -648,8 +806,8 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 				(*store)(handle, key, value, size, type, flags);
 		}
 		// Loop state...
-		uint32_t loop_start = pPlugin->loopStart();
-		uint32_t loop_end   = pPlugin->loopEnd();
+		uint32_t loop_start = pSample->loopStart();
+		uint32_t loop_end   = pSample->loopEnd();
 		if (loop_start < loop_end) {
 			value = (const char *) &loop_start;
 			key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "P104_LOOP_START");
@@ -660,7 +818,7 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 			if (key)
 				(*store)(handle, key, value, size, type, flags);
 		}
-		uint32_t loop_fade = pPlugin->loopFade();
+		uint32_t loop_fade = pSample->loopCrossFade();
 		value = (const char *) &loop_fade;
 		key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "P106_LOOP_FADE");
 		if (key)
@@ -669,7 +827,7 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 
 	type = pPlugin->urid_map(LV2_ATOM__Bool);
 	if (type) {
-		uint32_t loop_zero = pPlugin->isLoopZero() ? 1 : 0;
+		uint32_t loop_zero = pSample->isLoopZeroCrossing() ? 1 : 0;
 		value = (const char *) &loop_zero;
 		key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "P107_LOOP_ZERO");
 		if (key)
@@ -677,11 +835,13 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 	}
 
 	// FIXME: At this time, only micro-tonal (aka. tuning) settings
-	// are posed to be saved into some XML chunk as state...
-	if (!pPlugin->isTuningEnabled())
+	// and key/velocity zones are posed to be saved into some binary
+	// chunk as state...
+	const samplv1_zones::Zones& zones = pPlugin->zones()->zones();
+	if (!pPlugin->isTuningEnabled() && zones.empty())
 		return LV2_STATE_SUCCESS;
 
-	// Save all remaining state as XML chunk...
+	// Save all remaining state as binary chunk...
 	//
 	key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "state");
 	if (key == 0)
@@ -697,17 +857,37 @@ static LV2_State_Status samplv1_lv2_state_save ( LV2_Handle instance,
 	flags |= (LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE);
 #endif
 
-	QDomDocument doc(SAMPLV1_TITLE);
-	QDomElement eState = doc.createElement("state");
-
-	QDomElement eTuning = doc.createElement("tuning");
-	samplv1_param::saveTuning(pPlugin, doc, eTuning);
-	eState.appendChild(eTuning);
+	samplv1_param::Preset preset;
+	if (pPlugin->isTuningEnabled()) {
+		preset.bTuning = true;
+		preset.bTuningEnabled = true;
+		preset.fTuningRefPitch = pPlugin->tuningRefPitch();
+		preset.iTuningRefNote = pPlugin->tuningRefNote();
+		const char *pszScaleFile = pPlugin->tuningScaleFile();
+		if (pszScaleFile)
+			preset.sTuningScaleFile = pszScaleFile;
+		const char *pszKeyMapFile = pPlugin->tuningKeyMapFile();
+		if (pszKeyMapFile)
+			preset.sTuningKeyMapFile = pszKeyMapFile;
+	}
 
-	doc.appendChild(eState);
+	// Key/velocity zones (host mapped sample paths)...
+	preset.zones = zones;
+	samplv1_zones::Zones::iterator zone_iter = preset.zones.begin();
+	for ( ; zone_iter != preset.zones.end(); ++zone_iter) {
+		samplv1_zones::Zone& zone = *zone_iter;
+		if (map_path == nullptr)
+			continue;
+		char *path = (*map_path->abstract_path)(
+			map_path->handle, zone.filename.c_str());
+		if (path) {
+			zone.filename = path;
+			::free(path);
+		}
+	}
 
-	const QByteArray data(doc.toByteArray());
-	value = data.constData();
+	const std::string& data = samplv1_param::savePresetData(preset);
+	value = data.data();
 	size = data.size();
 
 	return (*store)(handle, key, value, size, type, flags);
@@ -775,8 +955,9 @@ static LV2_State_Status samplv1_lv2_state_restore ( LV2_Handle instance,
 		return LV2_STATE_ERR_UNKNOWN;
 
 	// Make sure to get rid of any symlinks...
-	const QString sSampleFile
-		= QFileInfo(QString::fromUtf8(value)).canonicalFilePath();
+	char szSampleFile[PATH_MAX];
+	if (::realpath(value, szSampleFile) == nullptr)
+		szSampleFile[0] = '\0';
 
 	if (map_path)
 		::free((void *) value);
@@ -795,8 +976,6 @@ static LV2_State_Status samplv1_lv2_state_restore ( LV2_Handle instance,
 		}
 	}
 
-	pPlugin->setSampleFile(sSampleFile.toUtf8().constData(), otabs);
-
 	// Restore state properties...
 	uint32_t offset_start = 0;
 	uint32_t offset_end = 0;
@@ -921,16 +1100,27 @@ static LV2_State_Status samplv1_lv2_state_restore ( LV2_Handle instance,
 		}
 	}
 
-	pPlugin->setLoopZero(loop_zero > 0);
-	pPlugin->setLoopFade(loop_fade);
+	// Prepare the sample tables right here, off the audio thread;
+	// these get swapped in on the next run() cycle...
+	samplv1_sample *pSample
+		= new samplv1_sample(pPlugin->sampleRate(), pPlugin->epoch());
+	pSample->setReverse(pPlugin->paramValue(samplv1::GEN1_REVERSE) > 0.5f);
+	pSample->setOffset(pPlugin->paramValue(samplv1::GEN1_OFFSET) > 0.5f);
+	pSample->setLoop(pPlugin->paramValue(samplv1::GEN1_LOOP) > 0.5f);
+	pSample->setLoopZeroCrossing(loop_zero > 0);
+	pSample->setLoopCrossFade(loop_fade);
+	if (szSampleFile[0])
+		pSample->open(szSampleFile, 1.0f, otabs);
 
 	if (loop_start < loop_end)
-		pPlugin->setLoopRange(loop_start, loop_end);
+		pSample->setLoopRange(loop_start, loop_end);
 
 	if (offset_start < offset_end)
-		pPlugin->setOffsetRange(offset_start, offset_end);
+		pSample->setOffsetRange(offset_start, offset_end);
+
+	pPlugin->restore_sample(pSample);
 
-	// Retrieve any remaining state as XML chunk...
+	// Retrieve any remaining state as binary (or legacy XML) chunk...
 	//
 	key = pPlugin->urid_map(SAMPLV1_LV2_PREFIX "state");
 	if (key == 0)
@@ -946,19 +1136,40 @@ static LV2_State_Status samplv1_lv2_state_restore ( LV2_Handle instance,
 
 	value = (const char *) (*retrieve)(handle, key, &size, &type, &flags);
 
+	samplv1_zones::Zones zones;
+
 	if (value != nullptr && size > 2 && type == chunk_type
 		&& (flags & (LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE))) {
-		
-		QDomDocument doc(SAMPLV1_TITLE);
-		if (doc.setContent(QByteArray(value, size))) {
-			QDomElement eState = doc.documentElement();
-			if (eState.tagName() == "state") {
-				for (QDomNode nChild = eState.firstChild();
-						!nChild.isNull();
-							nChild = nChild.nextSibling()) {
-					QDomElement eChild = nChild.toElement();
-					if (eChild.isNull())
+		const std::string data(value, size);
+		samplv1_param::Preset preset;
+		samplv1_xml eState;
+		if (samplv1_param::isPresetData(data)) {
+			if (samplv1_param::loadPresetData(preset, data)) {
+				if (preset.bTuning)
+					samplv1_param::applyTuning(pPlugin, preset);
+				// Key/velocity zones (host mapped sample paths)...
+				samplv1_zones::Zones::iterator zone_iter = preset.zones.begin();
+				for ( ; zone_iter != preset.zones.end(); ++zone_iter) {
+					samplv1_zones::Zone& zone = *zone_iter;
+					if (map_path == nullptr)
 						continue;
+					char *path = (*map_path->absolute_path)(
+						map_path->handle, zone.filename.c_str());
+					if (path) {
+						zone.filename = path;
+						::free(path);
+					}
+				}
+				zones = preset.zones;
+			}
+		}
+		else
+		if (eState.setContent(data.data(), data.size())) {
+			if (eState.tagName() == "state") {
+				samplv1_xml::List::const_iterator iter
+					= eState.childNodes().begin();
+				for ( ; iter != eState.childNodes().end(); ++iter) {
+					const samplv1_xml& eChild = *iter;
 					if (eChild.tagName() == "tuning")
 						samplv1_param::loadTuning(pPlugin, eChild);
 				}
@@ -966,10 +1177,9 @@ static LV2_State_Status samplv1_lv2_state_restore ( LV2_Handle instance,
 		}
 	}
 
-	pPlugin->reset();
-
-	samplv1_sched::sync_notify(pPlugin, samplv1_sched::Sample, 1);
+	pPlugin->zones()->setZones(zones);
 
+	// nb. notifications are left to the worker, after the swap...
 	return LV2_STATE_SUCCESS;
 }
 
@@ -989,20 +1199,20 @@ const LV2_Program_Descriptor *samplv1_lv2::get_program ( uint32_t index )
 {
 	samplv1_programs *pPrograms = samplv1::programs();
 	const samplv1_programs::Banks& banks = pPrograms->banks();
-	samplv1_programs::Banks::ConstIterator bank_iter = banks.constBegin();
-	const samplv1_programs::Banks::ConstIterator& bank_end = banks.constEnd();
+	samplv1_programs::Banks::const_iterator bank_iter = banks.begin();
+	const samplv1_programs::Banks::const_iterator& bank_end = banks.end();
 	for (uint32_t i = 0; bank_iter != bank_end; ++bank_iter) {
-		samplv1_programs::Bank *pBank = bank_iter.value();
+		samplv1_programs::Bank *pBank = bank_iter->second;
 		const samplv1_programs::Progs& progs = pBank->progs();
-		samplv1_programs::Progs::ConstIterator prog_iter = progs.constBegin();
-		const samplv1_programs::Progs::ConstIterator& prog_end = progs.constEnd();
+		samplv1_programs::Progs::const_iterator prog_iter = progs.begin();
+		const samplv1_programs::Progs::const_iterator& prog_end = progs.end();
 		for ( ; prog_iter != prog_end; ++prog_iter, ++i) {
-			samplv1_programs::Prog *pProg = prog_iter.value();
+			samplv1_programs::Prog *pProg = prog_iter->second;
 			if (i >= index) {
-				m_aProgramName = pProg->name().toUtf8();
+				m_aProgramName = pProg->name();
 				m_program.bank = pBank->id();
 				m_program.program = pProg->id();
-				m_program.name = m_aProgramName.constData();
+				m_program.name = m_aProgramName.c_str();
 				return &m_program;
 			}
 		}
@@ -1151,11 +1361,51 @@ bool samplv1_lv2::worker_work ( const void *data, uint32_t size )
 	if (mesg->atom.type == m_urids.p101_sample_file)
 		samplv1::setSampleFile(mesg->data.path, samplv1::octaves());
 	else
+	if (mesg->atom.type == m_urids.gen1_restore)
+		return true; // nb. UI gets notified first, see worker_response().
+	else
+	if (mesg->atom.type == m_urids.gen1_retire) {
+		// retired restored sample: hold until out of sight...
+		if (mesg->data.retire.sample) {
+			RestoreGc gc;
+			gc.sample = mesg->data.retire.sample;
+			gc.serial = mesg->data.retire.serial;
+			gc.epoch  = mesg->data.retire.epoch;
+			m_restore_gc.push_back(gc);
+		}
+		restore_cleanup();
+		m_restore_gc_sched.store(false);
+		return true;
+	}
+	else
 	if (mesg->atom.type == m_urids.p108_sample_otabs)
 		samplv1::setSampleFile(samplv1::sampleFile(), mesg->data.key);
 	else
 	if (mesg->atom.type == m_urids.tun1_update)
 		samplv1::resetTuning();
+	else
+	if (mesg->atom.size > 0 && samplv1::sample()) {
+		// sample offset/loop points (loop cross-fade seams get baked)...
+		samplv1_sample *pSample = samplv1::sample();
+		const uint32_t key = mesg->data.key;
+		if (mesg->atom.type == m_urids.p102_offset_start)
+			samplv1::setOffsetRange(key, pSample->offsetEnd());
+		else
+		if (mesg->atom.type == m_urids.p103_offset_end)
+			samplv1::setOffsetRange(pSample->offsetStart(), key);
+		else
+		if (mesg->atom.type == m_urids.p104_loop_start)
+			samplv1::setLoopRange(key, pSample->loopEnd());
+		else
+		if (mesg->atom.type == m_urids.p105_loop_end)
+			samplv1::setLoopRange(pSample->loopStart(), key);
+		else
+		if (mesg->atom.type == m_urids.p106_loop_fade)
+			samplv1::setLoopFade(key);
+		else
+		if (mesg->atom.type == m_urids.p107_loop_zero)
+			samplv1::setLoopZero(key > 0);
+	}
 
 	return true;
 }
@@ -1163,6 +1413,11 @@ bool samplv1_lv2::worker_work ( const void *data, uint32_t size )
 
 bool samplv1_lv2::worker_response ( const void *data, uint32_t size )
 {
+	// waveform peaks chunk (variable size)?
+	if (size > sizeof(LV2_Atom)
+		&& ((const LV2_Atom *) data)->type == m_urids.gen1_peaks)
+		return peaks_response(data, size);
+
 	if (size != sizeof(samplv1_lv2_worker_message))
 		return false;
 
@@ -1180,6 +1435,29 @@ bool samplv1_lv2::worker_response ( const void *data, uint32_t size )
 #endif
 	if (mesg->atom.type == m_urids.state_StateChanged)
 		return state_changed();
+	else
+	if (mesg->atom.type == m_urids.gen1_retire)
+		return true;
+	else
+	if (mesg->atom.type == m_urids.gen1_restore) {
+		// restored state, swapped in: update everything...
+		peaks_update();
+		m_restore_serial.fetch_add(1);
+		samplv1_sched::sync_notify(this, samplv1_sched::Sample, 1);
+		// the former one goes only after the UI has switched over...
+		if (mesg->data.sample)
+			restore_retire(mesg->data.sample);
+	#ifdef CONFIG_LV2_PATCH
+		return patch_get(0);
+	#else
+		return true;
+	#endif
+	}
+
+	// new or updated sample waveform?
+	if (mesg->atom.type == m_urids.p101_sample_file ||
+		mesg->atom.type == m_urids.gen1_update)
+		peaks_update();
 
 	// update all properties, and eventually, any observers...
 	samplv1_sched::sync_notify(this, samplv1_sched::Sample, 0);
@@ -1192,6 +1470,135 @@ bool samplv1_lv2::worker_response ( const void *data, uint32_t size )
 }
 
 
+// waveform peak summary, (re)start sending (audio thread).
+void samplv1_lv2::peaks_update (void)
+{
+	if (m_schedule == nullptr)
+		return;
+
+	// any chunks still in flight are now stale...
+	m_peaks_serial = (m_peaks_serial + 1) & 0xffff;
+
+	samplv1_lv2_worker_message mesg;
+	mesg.atom.type = m_urids.gen1_peaks;
+	mesg.atom.size = sizeof(mesg.data.key);
+	mesg.data.key  = (m_peaks_serial << 16); // first chunk.
+	m_schedule->schedule_work(
+		m_schedule->handle, sizeof(mesg), &mesg);
+}
+
+
+// waveform peak summary, build and respond one chunk (worker thread).
+bool samplv1_lv2::worker_peaks ( const void *data, uint32_t size,
+	LV2_Worker_Respond_Function respond, LV2_Worker_Respond_Handle handle )
+{
+	if (size != sizeof(samplv1_lv2_worker_message))
+		return false;
+
+	const samplv1_lv2_worker_message *mesg
+		= (const samplv1_lv2_worker_message *) data;
+
+	if (mesg->atom.type != m_urids.gen1_peaks)
+		return false;
+
+	const uint32_t serial = (mesg->data.key >> 16);
+	const uint32_t index  = (mesg->data.key & 0xffff);
+
+	// first chunk: (re)build from the current sample tables...
+	if (index == 0)
+		m_peaks.build(samplv1::sample(), serial);
+	else
+	if (m_peaks.serial() != serial)
+		return true; // stale, superseded.
+
+	samplv1_lv2_peaks_message resp;
+	resp.atom.type = m_urids.gen1_peaks;
+	resp.key = mesg->data.key;
+	resp.nchunks = m_peaks.chunks();
+	resp.channels = m_peaks.channels();
+	resp.frames = m_peaks.frames();
+
+	uint16_t level = 0;
+	uint32_t offset = 0;
+	resp.nbins = m_peaks.getChunk(index, level, offset, resp.data);
+	resp.level = level;
+	resp.offset = offset;
+
+	const uint32_t nsize = sizeof(resp) - sizeof(resp.data)
+		+ resp.nbins * (resp.channels << 1);
+	resp.atom.size = nsize - sizeof(LV2_Atom);
+
+	respond(handle, nsize, &resp);
+	return true;
+}
+
+
+// waveform peak summary, send one chunk to notify port (audio thread).
+bool samplv1_lv2::peaks_response ( const void *data, uint32_t size )
+{
+	const samplv1_lv2_peaks_message *mesg
+		= (const samplv1_lv2_peaks_message *) data;
+
+	if (size < sizeof(*mesg) - sizeof(mesg->data))
+		return false;
+
+	const uint32_t nbytes = mesg->nbins * (mesg->channels << 1);
+	if (size < sizeof(*mesg) - sizeof(mesg->data) + nbytes)
+		return false;
+
+	// stale, superseded?
+	const uint32_t serial = (mesg->key >> 16);
+	if (serial != m_peaks_serial || m_atom_out == nullptr)
+		return true;
+
+	samplv1_lv2_worker_message next;
+	next.atom.type = m_urids.gen1_peaks;
+	next.atom.size = sizeof(next.data.key);
+	next.data.key  = mesg->key;
+
+	// not enough room on the notify port? try again later...
+	const uint32_t nspace = 128 + nbytes;
+	if (m_forge.offset + nspace > m_forge.size) {
+		m_schedule->schedule_work(
+			m_schedule->handle, sizeof(next), &next);
+		return true;
+	}
+
+	lv2_atom_forge_frame_time(&m_forge, m_ndelta);
+
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_object(&m_forge, &frame, 0, m_urids.gen1_peaks);
+
+	const int32_t info[5] = {
+		int32_t(serial),
+		int32_t(mesg->channels),
+		int32_t(mesg->frames),
+		int32_t(mesg->level),
+		int32_t(mesg->offset)
+	};
+
+	lv2_atom_forge_key(&m_forge, m_urids.gen1_peaks_info);
+	lv2_atom_forge_vector(&m_forge,
+		sizeof(int32_t), m_urids.atom_Int, 5, info);
+
+	lv2_atom_forge_key(&m_forge, m_urids.gen1_peaks_data);
+	lv2_atom_forge_atom(&m_forge, nbytes, m_urids.atom_Chunk);
+	lv2_atom_forge_write(&m_forge, mesg->data, nbytes);
+
+	lv2_atom_forge_pop(&m_forge, &frame);
+
+	// next chunk, if any...
+	const uint32_t index = (mesg->key & 0xffff) + 1;
+	if (index < mesg->nchunks) {
+		next.data.key = (serial << 16) | index;
+		m_schedule->schedule_work(
+			m_schedule->handle, sizeof(next), &next);
+	}
+
+	return true;
+}
+
+
 bool samplv1_lv2::state_changed (void)
 {
 	lv2_atom_forge_frame_time(&m_forge, m_ndelta);
@@ -1368,8 +1775,6 @@ static LV2_Handle samplv1_lv2_instantiate (
 	const LV2_Descriptor *, double sample_rate, const char *,
 	const LV2_Feature *const *host_features )
 {
-	samplv1_lv2::qapp_instantiate();
-
 	return new samplv1_lv2(sample_rate, host_features);
 }
 
@@ -1412,8 +1817,6 @@ static void samplv1_lv2_cleanup ( LV2_Handle instance )
 	samplv1_lv2 *pPlugin = static_cast<samplv1_lv2 *> (instance);
 	if (pPlugin)
 		delete pPlugin;
-
-	samplv1_lv2::qapp_cleanup();
 }
 
 
@@ -1451,6 +1854,8 @@ static LV2_Worker_Status samplv1_lv2_worker_work (
 	LV2_Worker_Respond_Handle handle, uint32_t size, const void *data )
 {
 	samplv1_lv2 *pSampl = static_cast<samplv1_lv2 *> (instance);
+	if (pSampl && pSampl->worker_peaks(data, size, respond, handle))
+		return LV2_WORKER_SUCCESS;
 	if (pSampl && pSampl->worker_work(data, size)) {
 		respond(handle, size, data);
 		return LV2_WORKER_SUCCESS;
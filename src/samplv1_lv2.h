@@ -23,6 +23,7 @@
 #define __samplv1_lv2_h
 
 #include "samplv1.h"
+#include "samplv1_peaks.h"
 
 #include "lv2/lv2plug.in/ns/ext/urid/urid.h"
 #include "lv2/lv2plug.in/ns/ext/atom/atom.h"
@@ -30,19 +31,20 @@
 
 #include "lv2/lv2plug.in/ns/ext/worker/worker.h"
 
+#include <atomic>
+#include <mutex>
+#include <list>
+#include <map>
+
 #define SAMPLV1_LV2_URI "http://samplv1.sourceforge.net/lv2"
 #define SAMPLV1_LV2_PREFIX SAMPLV1_LV2_URI "#"
 
 
 #ifdef CONFIG_LV2_PROGRAMS
 #include "lv2_programs.h"
-#include <QByteArray>
+#include <string>
 #endif
 
-// Forward decls.
-class QApplication;
-
-
 //-------------------------------------------------------------------------
 // samplv1_lv2 - decl.
 //
@@ -75,6 +77,15 @@ public:
 
 	uint32_t urid_map(const char *uri) const;
 
+	// thread-safe state restore (prepared sample hand-over).
+	void restore_sample(samplv1_sample *pSample);
+	samplv1_sample *restore_pending() const;
+
+	// restored sample retirement (in-process UI acknowledgement).
+	uint32_t restore_serial() const;
+	void restore_ack(const void *pUi, uint32_t serial);
+	void restore_detach(const void *pUi);
+
 #ifdef CONFIG_LV2_PROGRAMS
 	const LV2_Program_Descriptor *get_program(uint32_t index);
 	void select_program(uint32_t bank, uint32_t program);
@@ -83,10 +94,8 @@ public:
 	bool worker_work(const void *data, uint32_t size);
 	bool worker_response(const void *data, uint32_t size);
 
-	static void qapp_instantiate();
-	static void qapp_cleanup();
-
-	static QApplication *qapp_instance();
+	bool worker_peaks(const void *data, uint32_t size,
+		LV2_Worker_Respond_Function respond, LV2_Worker_Respond_Handle handle);
 
 protected:
 
@@ -105,6 +114,14 @@ protected:
 
 	bool state_changed();
 
+	void restore_swap(samplv1_sample *pSample);
+	void restore_retire(samplv1_sample *pSample);
+	void restore_cleanup();
+
+	// waveform peak summary (chunked, to out-of-process UIs).
+	void peaks_update();
+	bool peaks_response(const void *data, uint32_t size);
+
 #ifdef CONFIG_LV2_PATCH
 	bool patch_set(LV2_URID key);
 	bool patch_get(LV2_URID key);
@@ -139,6 +156,11 @@ private:
 		LV2_URID p107_loop_zero;
 		LV2_URID p108_sample_otabs;
 		LV2_URID gen1_update;
+		LV2_URID gen1_restore;
+		LV2_URID gen1_retire;
+		LV2_URID gen1_peaks;
+		LV2_URID gen1_peaks_info;
+		LV2_URID gen1_peaks_data;
 		LV2_URID p201_tuning_enabled;
 		LV2_URID p202_tuning_refPitch;
 		LV2_URID p203_tuning_refNote;
@@ -151,6 +173,7 @@ private:
 		LV2_URID atom_Int;
 		LV2_URID atom_Bool;
 		LV2_URID atom_Path;
+		LV2_URID atom_Chunk;
 	#ifdef CONFIG_LV2_PORT_EVENT
 		LV2_URID atom_PortEvent;
 		LV2_URID atom_portTuple;
@@ -177,6 +200,29 @@ private:
 
 	uint32_t m_ndelta;
 
+	std::atomic<samplv1_sample *> m_restore_pending;
+	samplv1_sample *m_restore_sample;
+
+	// retired restored samples, freed once out of (UI) sight.
+	struct RestoreGc
+	{
+		samplv1_sample *sample;
+		uint32_t serial;
+		uint32_t epoch;
+	};
+
+	std::list<RestoreGc> m_restore_gc;	// worker thread only.
+
+	std::atomic<uint32_t> m_restore_serial;
+	std::atomic<uint32_t> m_restore_gc_count;
+	std::atomic<bool>     m_restore_gc_sched;
+
+	std::map<const void *, uint32_t> m_restore_acks;
+	std::mutex m_restore_mutex;
+
+	samplv1_peaks m_peaks;
+	uint32_t m_peaks_serial;
+
 	LV2_Atom_Sequence *m_atom_in;
 	LV2_Atom_Sequence *m_atom_out;
 
@@ -185,11 +231,8 @@ private:
 
 #ifdef CONFIG_LV2_PROGRAMS
 	LV2_Program_Descriptor m_program;
-	QByteArray m_aProgramName;
+	std::string m_aProgramName;
 #endif
-
-	static QApplication *g_qapp_instance;
-	static unsigned int  g_qapp_refcount;
 };
 
 
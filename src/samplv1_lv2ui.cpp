@@ -22,6 +22,8 @@
 #include "samplv1_lv2ui.h"
 #include "samplv1_lv2.h"
 
+#include "samplv1_config.h"
+
 #include "lv2/lv2plug.in/ns/ext/instance-access/instance-access.h"
 
 #include <samplv1widget_lv2.h>
@@ -57,6 +59,57 @@ void samplv1_lv2ui::write_function (
 }
 
 
+void samplv1_lv2ui::write_function ( uint32_t port_index,
+	uint32_t buffer_size, uint32_t format, const void *buffer ) const
+{
+	m_write_function(m_controller,
+		port_index, buffer_size, format, buffer);
+}
+
+
+// Dedicated application and settings (UI only).
+QApplication   *samplv1_lv2ui::g_qapp_instance = nullptr;
+samplv1_config *samplv1_lv2ui::g_qapp_config   = nullptr;
+unsigned int    samplv1_lv2ui::g_qapp_refcount = 0;
+
+
+void samplv1_lv2ui::qapp_instantiate (void)
+{
+	if (qApp == nullptr && g_qapp_instance == nullptr) {
+		static int s_argc = 1;
+		static const char *s_argv[] = { SAMPLV1_TITLE, nullptr };
+		::setenv("QT_NO_GLIB", "1", 1); // Avoid glib event-loop...
+		g_qapp_instance = new QApplication(s_argc, (char **) s_argv);
+	}
+
+	if (samplv1_config::getInstance() == nullptr && g_qapp_config == nullptr)
+		g_qapp_config = new samplv1_config();
+
+	++g_qapp_refcount;
+}
+
+
+void samplv1_lv2ui::qapp_cleanup (void)
+{
+	if (g_qapp_refcount > 0 && --g_qapp_refcount == 0) {
+		if (g_qapp_config) {
+			delete g_qapp_config;
+			g_qapp_config = nullptr;
+		}
+		if (g_qapp_instance) {
+			delete g_qapp_instance;
+			g_qapp_instance = nullptr;
+		}
+	}
+}
+
+
+QApplication *samplv1_lv2ui::qapp_instance (void)
+{
+	return g_qapp_instance;
+}
+
+
 //-------------------------------------------------------------------------
 // samplv1_lv2ui - LV2 UI desc.
 //
@@ -76,11 +129,10 @@ static LV2UI_Handle samplv1_lv2ui_instantiate (
 		}
 	}
 
-	if (pSynth == nullptr)
-		return nullptr;
+	samplv1_lv2ui::qapp_instantiate();
 
 	samplv1widget_lv2 *pWidget
-		= new samplv1widget_lv2(pSynth, controller, write_function);
+		= new samplv1widget_lv2(pSynth, controller, write_function, features);
 	*widget = pWidget;
 	return pWidget;
 }
@@ -88,8 +140,10 @@ static LV2UI_Handle samplv1_lv2ui_instantiate (
 static void samplv1_lv2ui_cleanup ( LV2UI_Handle ui )
 {
 	samplv1widget_lv2 *pWidget = static_cast<samplv1widget_lv2 *> (ui);
-	if (pWidget)
+	if (pWidget) {
 		delete pWidget;
+		samplv1_lv2ui::qapp_cleanup();
+	}
 }
 
 static void samplv1_lv2ui_port_event (
@@ -224,13 +278,13 @@ static LV2UI_Handle samplv1_lv2ui_x11_instantiate (
 			resize = (LV2UI_Resize *) ui_features[i]->data;
 	}
 
-	if (pSampl == nullptr)
-		return nullptr;
 	if (!parent)
 		return nullptr;
 
+	samplv1_lv2ui::qapp_instantiate();
+
 	samplv1widget_lv2 *pWidget
-		= new samplv1widget_lv2(pSampl, controller, write_function);
+		= new samplv1widget_lv2(pSampl, controller, write_function, ui_features);
 	if (resize && resize->handle) {
 		const QSize& hint = pWidget->sizeHint();
 		resize->ui_resize(resize->handle, hint.width(), hint.height());
@@ -308,12 +362,15 @@ static LV2UI_Handle samplv1_lv2ui_external_instantiate (
 		}
 	}
 
+	samplv1_lv2ui::qapp_instantiate();
+
 	samplv1_lv2ui_external_widget *pExtWidget = new samplv1_lv2ui_external_widget;
 	pExtWidget->external.run  = samplv1_lv2ui_external_run;
 	pExtWidget->external.show = samplv1_lv2ui_external_show;
 	pExtWidget->external.hide = samplv1_lv2ui_external_hide;
 	pExtWidget->external_host = external_host;
-	pExtWidget->widget = new samplv1widget_lv2(pSampl, controller, write_function);
+	pExtWidget->widget = new samplv1widget_lv2(pSampl,
+		controller, write_function, ui_features);
 	if (external_host)
 		pExtWidget->widget->setExternalHost(external_host);
 	*widget = pExtWidget;
@@ -328,6 +385,7 @@ static void samplv1_lv2ui_external_cleanup ( LV2UI_Handle ui )
 		if (pExtWidget->widget)
 			delete pExtWidget->widget;
 		delete pExtWidget;
+		samplv1_lv2ui::qapp_cleanup();
 	}
 }
 
@@ -42,6 +42,9 @@
 
 // Forward decls.
 class samplv1_lv2;
+class samplv1_config;
+
+class QApplication;
 
 
 //-------------------------------------------------------------------------
@@ -59,12 +62,24 @@ public:
 	// Accessors.
 	const LV2UI_Controller& controller() const;
 	void write_function(samplv1::ParamIndex index, float fValue) const;
+	void write_function(uint32_t port_index,
+		uint32_t buffer_size, uint32_t format, const void *buffer) const;
+
+	// Dedicated application and settings (UI only).
+	static void qapp_instantiate();
+	static void qapp_cleanup();
+
+	static QApplication *qapp_instance();
 
 private:
 
 	// Instance variables.
 	LV2UI_Controller     m_controller;
 	LV2UI_Write_Function m_write_function;
+
+	static QApplication   *g_qapp_instance;
+	static samplv1_config *g_qapp_config;
+	static unsigned int    g_qapp_refcount;
 };
 
 
@@ -20,30 +20,200 @@
 *****************************************************************************/
 
 #include "samplv1_param.h"
-#include "samplv1_config.h"
+#include "samplv1_ini.h"
+#include "samplv1_xml.h"
 
-#include <QHash>
+#include <fstream>
+#include <sstream>
+#include <locale>
 
-#include <QDomDocument>
-#include <QTextStream>
-#include <QDir>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <math.h>
 
 
 //-------------------------------------------------------------------------
-// Abstract/absolute path functors.
+// Canonical/absolute/relative file path helpers (POSIX).
 
-QString samplv1_param::map_path::absolutePath (
-	const QString& sAbstractPath ) const
+// Current working directory.
+static std::string samplv1_param_currentDir (void)
 {
-	return QDir::current().absoluteFilePath(sAbstractPath);
+	char szPath[PATH_MAX];
+	if (::getcwd(szPath, sizeof(szPath)) == nullptr)
+		return std::string();
+	return szPath;
 }
 
-QString samplv1_param::map_path::abstractPath (
-	const QString& sAbsolutePath ) const
+
+// Remove redundant separators, "." and ".." path components.
+static std::string samplv1_param_cleanPath ( const std::string& sPath )
+{
+	std::vector<std::string> items;
+
+	const bool bAbsolute = (!sPath.empty() && sPath[0] == '/');
+
+	std::istringstream ss(sPath);
+	std::string sItem;
+	while (std::getline(ss, sItem, '/')) {
+		if (sItem.empty() || sItem == ".")
+			continue;
+		if (sItem == ".." && !items.empty() && items.back() != "..")
+			items.pop_back();
+		else
+		if (sItem != ".." || !bAbsolute)
+			items.push_back(sItem);
+	}
+
+	std::string sRet;
+	std::vector<std::string>::const_iterator iter = items.begin();
+	for ( ; iter != items.end(); ++iter) {
+		if (bAbsolute || iter != items.begin())
+			sRet += '/';
+		sRet += *iter;
+	}
+
+	if (sRet.empty())
+		sRet = (bAbsolute ? "/" : ".");
+
+	return sRet;
+}
+
+
+// File path, given a (absolute) directory path.
+static std::string samplv1_param_absoluteFilePath (
+	const std::string& sDir, const std::string& sFilename )
+{
+	if (sFilename.empty() || sFilename[0] == '/')
+		return sFilename;
+	if (sDir.empty() || sDir[sDir.length() - 1] == '/')
+		return sDir + sFilename;
+	return sDir + '/' + sFilename;
+}
+
+
+// Absolute file path (clean, but not canonical).
+static std::string samplv1_param_absoluteFilePath ( const std::string& sFilename )
 {
-	return QDir::current().relativeFilePath(sAbsolutePath);
+	return samplv1_param_cleanPath(
+		samplv1_param_absoluteFilePath(samplv1_param_currentDir(), sFilename));
+}
+
+
+// Absolute directory path of a file.
+static std::string samplv1_param_absoluteDir ( const std::string& sFilename )
+{
+	const std::string& sPath = samplv1_param_absoluteFilePath(sFilename);
+	const size_t i = sPath.rfind('/');
+	return (i > 0 ? sPath.substr(0, i) : std::string("/"));
+}
+
+
+// File path, relative to a (absolute) directory path.
+static std::string samplv1_param_relativeFilePath (
+	const std::string& sDir, const std::string& sFilename )
+{
+	if (sFilename.empty() || sFilename[0] != '/')
+		return sFilename;
+
+	std::vector<std::string> dirs, files;
+	std::string sItem;
+
+	std::istringstream ds(samplv1_param_cleanPath(sDir));
+	while (std::getline(ds, sItem, '/')) {
+		if (!sItem.empty())
+			dirs.push_back(sItem);
+	}
+
+	std::istringstream fs(samplv1_param_cleanPath(sFilename));
+	while (std::getline(fs, sItem, '/')) {
+		if (!sItem.empty())
+			files.push_back(sItem);
+	}
+
+	size_t i = 0;
+	while (i < dirs.size() && i < files.size() && dirs[i] == files[i])
+		++i;
+
+	std::string sRet;
+	for (size_t j = i; j < dirs.size(); ++j)
+		sRet += "../";
+	for (size_t j = i; j < files.size(); ++j) {
+		if (j > i)
+			sRet += '/';
+		sRet += files[j];
+	}
+
+	return sRet;
+}
+
+
+// Whether a file exists.
+static bool samplv1_param_exists ( const std::string& sFilename )
+{
+	struct stat st;
+	return (!sFilename.empty() && ::stat(sFilename.c_str(), &st) == 0);
+}
+
+
+// Symbolic link target (absolute path), if any.
+static bool samplv1_param_symLinkTarget (
+	const std::string& sFilename, std::string& sTarget )
+{
+	struct stat st;
+	if (sFilename.empty()
+		|| ::lstat(sFilename.c_str(), &st) != 0
+		|| !S_ISLNK(st.st_mode))
+		return false;
+
+	char szTarget[PATH_MAX];
+	const ssize_t len = ::readlink(sFilename.c_str(), szTarget, sizeof(szTarget) - 1);
+	if (len < 0)
+		return false;
+
+	szTarget[len] = '\0';
+	sTarget = samplv1_param_cleanPath(samplv1_param_absoluteFilePath(
+		samplv1_param_absoluteDir(sFilename), szTarget));
+	return true;
+}
+
+
+// Whole file contents in one single read.
+static bool samplv1_param_readFile (
+	const std::string& sFilename, std::string& data )
+{
+	std::ifstream file(sFilename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	std::ostringstream ss;
+	ss << file.rdbuf();
+	data = ss.str();
+	return true;
+}
+
+
+// Locale independent (C) numeric text conversions.
+static float samplv1_param_toFloat ( const std::string& sText )
+{
+	std::istringstream ss(sText);
+	ss.imbue(std::locale::classic());
+	float fValue = 0.0f;
+	ss >> fValue;
+	return (ss.fail() ? 0.0f : fValue);
+}
+
+static long samplv1_param_toLong ( const std::string& sText )
+{
+	return ::strtol(sText.c_str(), nullptr, 10);
+}
+
+static unsigned long samplv1_param_toULong ( const std::string& sText )
+{
+	return ::strtoul(sText.c_str(), nullptr, 10);
 }
 
 
@@ -220,350 +390,858 @@ bool samplv1_param::paramFloat ( samplv1::ParamIndex index )
 }
 
 
-// Preset serialization methods.
-bool samplv1_param::loadPreset (
-	samplv1 *pSampl, const QString& sFilename )
+// Preset snapshot methods.
+void samplv1_param::Preset::clear (void)
 {
-	if (pSampl == nullptr)
-		return false;
+	for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i) {
+		const samplv1::ParamIndex index = samplv1::ParamIndex(i);
+		params[i] = samplv1_param::paramDefaultValue(index);
+		paramsSet[i] = false;
+	}
 
-	QFileInfo fi(sFilename);
-	if (!fi.exists()) {
-		samplv1_config *pConfig = samplv1_config::getInstance();
-		if (pConfig) {
-			const QString& sPresetFile
-				= pConfig->presetFile(sFilename);
-			if (sPresetFile.isEmpty())
-				return false;
-			fi.setFile(sPresetFile);
-			if (!fi.exists())
-				return false;
-		}
+	bSample = false;
+	sSampleFile.clear();
+	iOctaves = 0;
+	iOffsetStart = 0;
+	iOffsetEnd = 0;
+	iLoopStart = 0;
+	iLoopEnd = 0;
+	iLoopFade = 0;
+	bLoopZero = true;
+
+	zones.clear();
+
+	bTuning = false;
+	bTuningEnabled = false;
+	fTuningRefPitch = 440.0f;
+	iTuningRefNote = 69;
+	sTuningScaleFile.clear();
+	sTuningKeyMapFile.clear();
+}
+
+
+// Zone key/velocity ranges (XML attributes).
+static void samplv1_param_loadZone (
+	samplv1_zones::Zone& zone, const samplv1_xml& eZone )
+{
+	zone.key_low  = uint8_t(samplv1_param_toULong(eZone.attribute("key-low",  "0")) & 0x7f);
+	zone.key_high = uint8_t(samplv1_param_toULong(eZone.attribute("key-high", "127")) & 0x7f);
+	zone.vel_low  = uint8_t(samplv1_param_toULong(eZone.attribute("vel-low",  "1")) & 0x7f);
+	zone.vel_high = uint8_t(samplv1_param_toULong(eZone.attribute("vel-high", "127")) & 0x7f);
+	zone.root_key = uint8_t(samplv1_param_toULong(eZone.attribute("root-key", "60")) & 0x7f);
+	zone.octaves  = uint16_t(samplv1_param_toULong(eZone.attribute("octaves", "0")));
+}
+
+static void samplv1_param_saveZone (
+	const samplv1_zones::Zone& zone, samplv1_xml& eZone )
+{
+	eZone.setAttribute("key-low",  std::to_string(int(zone.key_low)));
+	eZone.setAttribute("key-high", std::to_string(int(zone.key_high)));
+	eZone.setAttribute("vel-low",  std::to_string(int(zone.vel_low)));
+	eZone.setAttribute("vel-high", std::to_string(int(zone.vel_high)));
+	eZone.setAttribute("root-key", std::to_string(int(zone.root_key)));
+	if (zone.octaves > 0)
+		eZone.setAttribute("octaves", std::to_string(int(zone.octaves)));
+}
+
+
+bool samplv1_param::loadPreset (
+	samplv1_param::Preset& preset, const std::string& sFilename )
+{
+	preset.clear();
+
+	std::string sPresetFile(sFilename);
+	if (!samplv1_param_exists(sPresetFile)) {
+		samplv1_ini *ini = samplv1_ini::acquire();
+		sPresetFile = ini->presetFile(sFilename);
+		samplv1_ini::release(ini);
+		if (sPresetFile.empty())
+			return false;
+		if (!samplv1_param_exists(sPresetFile))
+			return false;
 	}
 
-	QFile file(fi.filePath());
-	if (!file.open(QIODevice::ReadOnly))
+	// Whole file contents in one single read...
+	std::string data;
+	if (!samplv1_param_readFile(sPresetFile, data))
 		return false;
 
-	const bool running = pSampl->running(false);
+	// All relative paths are resolved against the preset file location.
+	const std::string& sPresetDir = samplv1_param_absoluteDir(sPresetFile);
 
-	pSampl->setTuningEnabled(false);
-	pSampl->reset();
+	// Binary preset format?
+	if (samplv1_param::isPresetData(data))
+		return samplv1_param::loadPresetData(preset, data, sPresetDir);
 
-	static QHash<QString, samplv1::ParamIndex> s_hash;
-	if (s_hash.isEmpty()) {
+	static std::map<std::string, samplv1::ParamIndex> s_hash;
+	if (s_hash.empty()) {
 		for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i) {
 			const samplv1::ParamIndex index = samplv1::ParamIndex(i);
-			s_hash.insert(samplv1_param::paramName(index), index);
+			s_hash[samplv1_param::paramName(index)] = index;
 		}
 	}
 
-	const QDir currentDir(QDir::current());
-	QDir::setCurrent(fi.absolutePath());
-
-	QDomDocument doc(SAMPLV1_TITLE);
-	if (doc.setContent(&file)) {
-		QDomElement ePreset = doc.documentElement();
-		if (ePreset.tagName() == "preset") {
-		//	&& ePreset.attribute("name") == fi.completeBaseName()) {
-			for (QDomNode nChild = ePreset.firstChild();
-					!nChild.isNull();
-						nChild = nChild.nextSibling()) {
-				QDomElement eChild = nChild.toElement();
-				if (eChild.isNull())
-					continue;
-				if (eChild.tagName() == "params") {
-					for (QDomNode nParam = eChild.firstChild();
-							!nParam.isNull();
-								nParam = nParam.nextSibling()) {
-						QDomElement eParam = nParam.toElement();
-						if (eParam.isNull())
+	samplv1_xml ePreset;
+	if (ePreset.setContent(data.data(), data.size())
+		&& ePreset.tagName() == "preset") {
+		samplv1_xml::List::const_iterator child_iter
+			= ePreset.childNodes().begin();
+		for ( ; child_iter != ePreset.childNodes().end(); ++child_iter) {
+			const samplv1_xml& eChild = *child_iter;
+			if (eChild.tagName() == "params") {
+				samplv1_xml::List::const_iterator param_iter
+					= eChild.childNodes().begin();
+				for ( ; param_iter != eChild.childNodes().end(); ++param_iter) {
+					const samplv1_xml& eParam = *param_iter;
+					if (eParam.tagName() != "param")
+						continue;
+					uint32_t i = samplv1_param_toULong(eParam.attribute("index"));
+					const std::string& sName = eParam.attribute("name");
+					if (!sName.empty()) {
+						std::map<std::string, samplv1::ParamIndex>::const_iterator
+							iter = s_hash.find(sName);
+						if (iter == s_hash.end())
 							continue;
-						if (eParam.tagName() == "param") {
-							samplv1::ParamIndex index = samplv1::ParamIndex(
-								eParam.attribute("index").toULong());
-							const QString& sName = eParam.attribute("name");
-							if (!sName.isEmpty()) {
-								if (!s_hash.contains(sName))
-									continue;
-								index = s_hash.value(sName);
-							}
-							const float fValue = eParam.text().toFloat();
-							pSampl->setParamValue(index,
-								samplv1_param::paramSafeValue(index, fValue));
-						}
+						i = uint32_t(iter->second);
 					}
+					if (i >= samplv1::NUM_PARAMS)
+						continue;
+					const samplv1::ParamIndex index = samplv1::ParamIndex(i);
+					const float fValue = samplv1_param_toFloat(eParam.text());
+					preset.params[i] = samplv1_param::paramSafeValue(index, fValue);
+					preset.paramsSet[i] = true;
 				}
-				else
-				if (eChild.tagName() == "samples") {
-					samplv1_param::loadSamples(pSampl, eChild);
+			}
+			else
+			if (eChild.tagName() == "samples") {
+				samplv1_xml::List::const_iterator sample_iter
+					= eChild.childNodes().begin();
+				for ( ; sample_iter != eChild.childNodes().end(); ++sample_iter) {
+					const samplv1_xml& eSample = *sample_iter;
+					if (eSample.tagName() != "sample")
+						continue;
+					std::string sSampleFile;
+					samplv1_xml::List::const_iterator prop_iter
+						= eSample.childNodes().begin();
+					for ( ; prop_iter != eSample.childNodes().end(); ++prop_iter) {
+						const samplv1_xml& eProp = *prop_iter;
+						if (eProp.tagName() == "filename")
+							sSampleFile = eProp.text();
+						else
+						if (eProp.tagName() == "octaves")
+							preset.iOctaves = samplv1_param_toULong(eProp.text());
+						else
+						if (eProp.tagName() == "offset-start")
+							preset.iOffsetStart = samplv1_param_toULong(eProp.text());
+						else
+						if (eProp.tagName() == "offset-end")
+							preset.iOffsetEnd = samplv1_param_toULong(eProp.text());
+						else
+						if (eProp.tagName() == "loop-start")
+							preset.iLoopStart = samplv1_param_toULong(eProp.text());
+						else
+						if (eProp.tagName() == "loop-end")
+							preset.iLoopEnd = samplv1_param_toULong(eProp.text());
+						else
+						if (eProp.tagName() == "loop-fade")
+							preset.iLoopFade = samplv1_param_toULong(eProp.text());
+						else
+						if (eProp.tagName() == "loop-zero")
+							preset.bLoopZero = (samplv1_param_toLong(eProp.text()) > 0);
+					}
+					// Legacy loader...
+					if (sSampleFile.empty())
+						sSampleFile = eSample.text();
+					preset.sSampleFile = samplv1_param_absoluteFilePath(sPresetDir,
+						samplv1_param::loadFilename(sSampleFile));
+					preset.bSample = true;
 				}
-				else
-				if (eChild.tagName() == "tuning") {
-					samplv1_param::loadTuning(pSampl, eChild);
+			}
+			else
+			if (eChild.tagName() == "zones") {
+				samplv1_xml::List::const_iterator zone_iter
+					= eChild.childNodes().begin();
+				for ( ; zone_iter != eChild.childNodes().end(); ++zone_iter) {
+					const samplv1_xml& eZone = *zone_iter;
+					if (eZone.tagName() != "zone")
+						continue;
+					samplv1_zones::Zone zone;
+					samplv1_param_loadZone(zone, eZone);
+					samplv1_xml::List::const_iterator prop_iter
+						= eZone.childNodes().begin();
+					for ( ; prop_iter != eZone.childNodes().end(); ++prop_iter) {
+						const samplv1_xml& eProp = *prop_iter;
+						if (eProp.tagName() == "filename")
+							zone.filename = samplv1_param_absoluteFilePath(sPresetDir,
+								samplv1_param::loadFilename(eProp.text()));
+					}
+					if (!zone.filename.empty())
+						preset.zones.push_back(zone);
+				}
+			}
+			else
+			if (eChild.tagName() == "tuning") {
+				preset.bTuning = true;
+				preset.bTuningEnabled
+					= (samplv1_param_toLong(eChild.attribute("enabled")) > 0);
+				samplv1_xml::List::const_iterator prop_iter
+					= eChild.childNodes().begin();
+				for ( ; prop_iter != eChild.childNodes().end(); ++prop_iter) {
+					const samplv1_xml& eProp = *prop_iter;
+					if (eProp.tagName() == "enabled")
+						preset.bTuningEnabled = (samplv1_param_toLong(eProp.text()) > 0);
+					else
+					if (eProp.tagName() == "ref-pitch")
+						preset.fTuningRefPitch = samplv1_param_toFloat(eProp.text());
+					else
+					if (eProp.tagName() == "ref-note")
+						preset.iTuningRefNote = samplv1_param_toLong(eProp.text());
+					else
+					if (eProp.tagName() == "scale-file")
+						preset.sTuningScaleFile = samplv1_param_absoluteFilePath(sPresetDir,
+							samplv1_param::loadFilename(eProp.text()));
+					else
+					if (eProp.tagName() == "keymap-file")
+						preset.sTuningKeyMapFile = samplv1_param_absoluteFilePath(sPresetDir,
+							samplv1_param::loadFilename(eProp.text()));
 				}
 			}
 		}
 	}
 
-	file.close();
+	return true;
+}
+
+
+// Preset snapshot from instance.
+void samplv1_param::capturePreset (
+	samplv1 *pSampl, samplv1_param::Preset& preset )
+{
+	preset.clear();
+
+	if (pSampl == nullptr)
+		return;
 
 	pSampl->stabilize();
-	pSampl->reset();
-	pSampl->running(running);
 
-	QDir::setCurrent(currentDir.absolutePath());
+	for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i) {
+		preset.params[i] = pSampl->paramValue(samplv1::ParamIndex(i));
+		preset.paramsSet[i] = true;
+	}
 
-	return true;
+	const char *pszSampleFile = pSampl->sampleFile();
+	if (pszSampleFile) {
+		preset.bSample = true;
+		preset.sSampleFile = pszSampleFile;
+		preset.iOctaves = pSampl->octaves();
+		preset.iOffsetStart = pSampl->offsetStart();
+		preset.iOffsetEnd = pSampl->offsetEnd();
+		preset.iLoopStart = pSampl->loopStart();
+		preset.iLoopEnd = pSampl->loopEnd();
+		preset.iLoopFade = pSampl->loopFade();
+		preset.bLoopZero = pSampl->isLoopZero();
+	}
+
+	preset.zones = pSampl->zones()->zones();
+
+	if (pSampl->isTuningEnabled()) {
+		preset.bTuning = true;
+		preset.bTuningEnabled = true;
+		preset.fTuningRefPitch = pSampl->tuningRefPitch();
+		preset.iTuningRefNote = pSampl->tuningRefNote();
+		const char *pszScaleFile = pSampl->tuningScaleFile();
+		if (pszScaleFile)
+			preset.sTuningScaleFile = pszScaleFile;
+		const char *pszKeyMapFile = pSampl->tuningKeyMapFile();
+		if (pszKeyMapFile)
+			preset.sTuningKeyMapFile = pszKeyMapFile;
+	}
 }
 
 
-bool samplv1_param::savePreset (
-	samplv1 *pSampl, const QString& sFilename, bool bSymLink )
+// Binary preset format (versioned).
+static const uint32_t SAMPLV1_PRESET_MAGIC   = 0x73706c31; // "spl1"
+static const uint32_t SAMPLV1_PRESET_VERSION = 2; // 2: zones.
+
+
+// Binary preset data encoder (little-endian, same as QDataStream).
+class samplv1_param_writer
 {
-	if (pSampl == nullptr)
+public:
+
+	samplv1_param_writer(std::string& data) : m_data(data) {}
+
+	samplv1_param_writer& u8(uint8_t val)
+		{ m_data += char(val); return *this; }
+
+	samplv1_param_writer& u16(uint16_t val)
+		{ return u8(val & 0xff).u8(val >> 8); }
+
+	samplv1_param_writer& u32(uint32_t val)
+		{ return u16(val & 0xffff).u16(val >> 16); }
+
+	samplv1_param_writer& f32(float val)
+	{
+		uint32_t bits = 0;
+		::memcpy(&bits, &val, sizeof(bits));
+		return u32(bits);
+	}
+
+	// byte-array: length prefixed (0xffffffff when null).
+	samplv1_param_writer& bytes(const std::string& val)
+	{
+		if (val.empty())
+			return u32(0xffffffff);
+		u32(uint32_t(val.size()));
+		m_data += val;
+		return *this;
+	}
+
+private:
+
+	std::string& m_data;
+};
+
+
+// Binary preset data decoder (little-endian, same as QDataStream).
+class samplv1_param_reader
+{
+public:
+
+	samplv1_param_reader(const std::string& data)
+		: m_data(data), m_pos(0), m_ok(true) {}
+
+	bool ok() const { return m_ok; }
+
+	samplv1_param_reader& u8(uint8_t& val)
+	{
+		val = 0;
+		if (m_ok && m_pos < m_data.size())
+			val = uint8_t(m_data[m_pos++]);
+		else
+			m_ok = false;
+		return *this;
+	}
+
+	samplv1_param_reader& u16(uint16_t& val)
+	{
+		uint8_t lo = 0, hi = 0;
+		u8(lo).u8(hi);
+		val = uint16_t(lo) | (uint16_t(hi) << 8);
+		return *this;
+	}
+
+	samplv1_param_reader& u32(uint32_t& val)
+	{
+		uint16_t lo = 0, hi = 0;
+		u16(lo).u16(hi);
+		val = uint32_t(lo) | (uint32_t(hi) << 16);
+		return *this;
+	}
+
+	samplv1_param_reader& f32(float& val)
+	{
+		uint32_t bits = 0;
+		u32(bits);
+		::memcpy(&val, &bits, sizeof(val));
+		return *this;
+	}
+
+	samplv1_param_reader& bytes(std::string& val)
+	{
+		uint32_t len = 0;
+		val.clear();
+		u32(len);
+		if (!m_ok || len == 0xffffffff)
+			return *this;
+		if (len > m_data.size() - m_pos) {
+			m_ok = false;
+			return *this;
+		}
+		val = m_data.substr(m_pos, len);
+		m_pos += len;
+		return *this;
+	}
+
+private:
+
+	const std::string& m_data;
+	size_t m_pos;
+	bool   m_ok;
+};
+
+
+// Relative/absolute file path mappers (binary preset format).
+static std::string samplv1_param_abstractPath (
+	const std::string& sBasePath, const std::string& sAbsolutePath )
+{
+	if (sBasePath.empty() || sAbsolutePath.empty())
+		return sAbsolutePath;
+	else
+		return samplv1_param_relativeFilePath(sBasePath, sAbsolutePath);
+}
+
+static std::string samplv1_param_absolutePath (
+	const std::string& sBasePath, const std::string& sAbstractPath )
+{
+	if (sBasePath.empty() || sAbstractPath.empty())
+		return sAbstractPath;
+	else
+		return samplv1_param_absoluteFilePath(sBasePath, sAbstractPath);
+}
+
+
+bool samplv1_param::isPresetData ( const std::string& data )
+{
+	if (data.size() < 2 * sizeof(uint32_t))
 		return false;
 
-	pSampl->stabilize();
+	samplv1_param_reader ds(data);
+
+	uint32_t magic = 0;
+	ds.u32(magic);
+
+	return (magic == SAMPLV1_PRESET_MAGIC);
+}
+
+
+bool samplv1_param::loadPresetData ( samplv1_param::Preset& preset,
+	const std::string& data, const std::string& sBasePath )
+{
+	preset.clear();
+
+	samplv1_param_reader ds(data);
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	ds.u32(magic).u32(version);
+	if (magic != SAMPLV1_PRESET_MAGIC || version > SAMPLV1_PRESET_VERSION)
+		return false;
+
+	// Fixed parameter array, indexed by samplv1::ParamIndex...
+	uint32_t nparams = 0;
+	ds.u32(nparams);
+	for (uint32_t i = 0; i < nparams && ds.ok(); ++i) {
+		uint8_t set = 0;
+		float fValue = 0.0f;
+		ds.u8(set).f32(fValue);
+		if (i < samplv1::NUM_PARAMS && set) {
+			const samplv1::ParamIndex index = samplv1::ParamIndex(i);
+			preset.params[i] = samplv1_param::paramSafeValue(index, fValue);
+			preset.paramsSet[i] = true;
+		}
+	}
+
+	// Sample reference and settings...
+	uint8_t bSample = 0;
+	ds.u8(bSample);
+	if (bSample) {
+		std::string sSampleFile;
+		uint8_t bLoopZero = 1;
+		ds.bytes(sSampleFile)
+			.u16(preset.iOctaves)
+			.u32(preset.iOffsetStart)
+			.u32(preset.iOffsetEnd)
+			.u32(preset.iLoopStart)
+			.u32(preset.iLoopEnd)
+			.u32(preset.iLoopFade)
+			.u8(bLoopZero);
+		preset.bSample = true;
+		preset.sSampleFile = samplv1_param_absolutePath(sBasePath, sSampleFile);
+		preset.bLoopZero = (bLoopZero > 0);
+	}
+
+	// Micro-tuning settings...
+	uint8_t bTuning = 0;
+	ds.u8(bTuning);
+	if (bTuning) {
+		std::string sScaleFile;
+		std::string sKeyMapFile;
+		uint8_t bTuningEnabled = 0;
+		uint32_t iTuningRefNote = 69;
+		ds.u8(bTuningEnabled)
+			.f32(preset.fTuningRefPitch)
+			.u32(iTuningRefNote)
+			.bytes(sScaleFile)
+			.bytes(sKeyMapFile);
+		preset.bTuning = true;
+		preset.bTuningEnabled = (bTuningEnabled > 0);
+		preset.iTuningRefNote = int32_t(iTuningRefNote);
+		preset.sTuningScaleFile = samplv1_param_absolutePath(sBasePath, sScaleFile);
+		preset.sTuningKeyMapFile = samplv1_param_absolutePath(sBasePath, sKeyMapFile);
+	}
+
+	// Key/velocity zones (version 2)...
+	if (version > 1) {
+		uint32_t nzones = 0;
+		ds.u32(nzones);
+		for (uint32_t i = 0; i < nzones && ds.ok(); ++i) {
+			samplv1_zones::Zone zone;
+			std::string sSampleFile;
+			ds.u8(zone.key_low).u8(zone.key_high)
+				.u8(zone.vel_low).u8(zone.vel_high)
+				.u8(zone.root_key).u16(zone.octaves)
+				.bytes(sSampleFile);
+			zone.filename = samplv1_param_absolutePath(sBasePath, sSampleFile);
+			if (!zone.filename.empty() && ds.ok())
+				preset.zones.push_back(zone);
+		}
+	}
+
+	return ds.ok();
+}
+
+
+std::string samplv1_param::savePresetData (
+	const samplv1_param::Preset& preset, const std::string& sBasePath )
+{
+	std::string data;
+
+	samplv1_param_writer ds(data);
+
+	ds.u32(SAMPLV1_PRESET_MAGIC).u32(SAMPLV1_PRESET_VERSION);
+
+	ds.u32(samplv1::NUM_PARAMS);
+	for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i)
+		ds.u8(preset.paramsSet[i] ? 1 : 0).f32(preset.params[i]);
+
+	ds.u8(preset.bSample ? 1 : 0);
+	if (preset.bSample) {
+		ds.bytes(samplv1_param_abstractPath(sBasePath, preset.sSampleFile))
+			.u16(preset.iOctaves)
+			.u32(preset.iOffsetStart)
+			.u32(preset.iOffsetEnd)
+			.u32(preset.iLoopStart)
+			.u32(preset.iLoopEnd)
+			.u32(preset.iLoopFade)
+			.u8(preset.bLoopZero ? 1 : 0);
+	}
+
+	ds.u8(preset.bTuning ? 1 : 0);
+	if (preset.bTuning) {
+		ds.u8(preset.bTuningEnabled ? 1 : 0)
+			.f32(preset.fTuningRefPitch)
+			.u32(uint32_t(int32_t(preset.iTuningRefNote)))
+			.bytes(samplv1_param_abstractPath(sBasePath, preset.sTuningScaleFile))
+			.bytes(samplv1_param_abstractPath(sBasePath, preset.sTuningKeyMapFile));
+	}
+
+	ds.u32(preset.zones.size());
+	samplv1_zones::Zones::const_iterator iter = preset.zones.begin();
+	for ( ; iter != preset.zones.end(); ++iter) {
+		const samplv1_zones::Zone& zone = *iter;
+		ds.u8(zone.key_low).u8(zone.key_high)
+			.u8(zone.vel_low).u8(zone.vel_high)
+			.u8(zone.root_key).u16(zone.octaves)
+			.bytes(samplv1_param_abstractPath(sBasePath, zone.filename));
+	}
 
-	const QFileInfo fi(sFilename);
-	const QDir currentDir(QDir::current());
-	QDir::setCurrent(fi.absolutePath());
+	return data;
+}
+
+
+void samplv1_param::applyPreset (
+	samplv1 *pSampl, const samplv1_param::Preset& preset )
+{
+	if (pSampl == nullptr)
+		return;
 
-	QDomDocument doc(SAMPLV1_TITLE);
-	QDomElement ePreset = doc.createElement("preset");
-	ePreset.setAttribute("name", fi.completeBaseName());
-	ePreset.setAttribute("version", CONFIG_BUILD_VERSION);
+	const bool running = pSampl->running(false);
 
-	QDomElement eSamples = doc.createElement("samples");
-	samplv1_param::saveSamples(pSampl, doc, eSamples, map_path(), bSymLink);
-	ePreset.appendChild(eSamples);
+	pSampl->setTuningEnabled(false);
+	pSampl->reset();
+
+	if (preset.bSample) {
+		pSampl->setSampleFile(preset.sSampleFile.c_str(), preset.iOctaves);
+		// Set actual sample loop points...
+		pSampl->setLoopZero(preset.bLoopZero);
+		pSampl->setLoopFade(preset.iLoopFade);
+		pSampl->setLoopRange(preset.iLoopStart, preset.iLoopEnd);
+		pSampl->setOffsetRange(preset.iOffsetStart, preset.iOffsetEnd);
+		// Consolidate sample state...
+		pSampl->updateSample();
+	}
+
+	pSampl->zones()->setZones(preset.zones);
 
-	QDomElement eParams = doc.createElement("params");
 	for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i) {
-		QDomElement eParam = doc.createElement("param");
-		const samplv1::ParamIndex index = samplv1::ParamIndex(i);
-		eParam.setAttribute("index", QString::number(i));
-		eParam.setAttribute("name", samplv1_param::paramName(index));
-		const float fValue = pSampl->paramValue(index);
-		eParam.appendChild(doc.createTextNode(QString::number(fValue)));
-		eParams.appendChild(eParam);
+		if (preset.paramsSet[i])
+			pSampl->setParamValue(samplv1::ParamIndex(i), preset.params[i]);
 	}
-	ePreset.appendChild(eParams);
 
-	if (pSampl->isTuningEnabled()) {
-		QDomElement eTuning = doc.createElement("tuning");
-		samplv1_param::saveTuning(pSampl, doc, eTuning, bSymLink);
-		ePreset.appendChild(eTuning);
+	if (preset.bTuning)
+		samplv1_param::applyTuning(pSampl, preset);
+
+	pSampl->stabilize();
+	pSampl->reset();
+	pSampl->running(running);
+}
+
+
+void samplv1_param::applyTuning (
+	samplv1 *pSampl, const samplv1_param::Preset& preset )
+{
+	if (pSampl == nullptr)
+		return;
+
+	if (preset.bTuning) {
+		pSampl->setTuningEnabled(preset.bTuningEnabled);
+		pSampl->setTuningRefPitch(preset.fTuningRefPitch);
+		pSampl->setTuningRefNote(preset.iTuningRefNote);
+		if (!preset.sTuningScaleFile.empty())
+			pSampl->setTuningScaleFile(preset.sTuningScaleFile.c_str());
+		if (!preset.sTuningKeyMapFile.empty())
+			pSampl->setTuningKeyMapFile(preset.sTuningKeyMapFile.c_str());
 	}
 
-	doc.appendChild(ePreset);
+	// Consolidate tuning state...
+	pSampl->updateTuning();
+}
 
-	QFile file(fi.filePath());
-	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
-		return false;
 
-	QTextStream(&file) << doc.toString();
-	file.close();
+// Preset serialization methods.
+bool samplv1_param::loadPreset (
+	samplv1 *pSampl, const std::string& sFilename )
+{
+	if (pSampl == nullptr)
+		return false;
 
-	QDir::setCurrent(currentDir.absolutePath());
+	samplv1_param::Preset preset;
+	if (!samplv1_param::loadPreset(preset, sFilename))
+		return false;
 
+	samplv1_param::applyPreset(pSampl, preset);
 	return true;
 }
 
 
-// Sample serialization methods.
-void samplv1_param::loadSamples (
-	samplv1 *pSampl, const QDomElement& eSamples,
-	const samplv1_param::map_path& mapPath )
+bool samplv1_param::savePreset (
+	samplv1 *pSampl, const std::string& sFilename, bool bSymLink )
 {
 	if (pSampl == nullptr)
-		return;
+		return false;
 
-	for (QDomNode nSample = eSamples.firstChild();
-			!nSample.isNull();
-				nSample = nSample.nextSibling()) {
-		QDomElement eSample = nSample.toElement();
-		if (eSample.isNull())
-			continue;
-		if (eSample.tagName() == "sample") {
-		//	int index = eSample.attribute("index").toInt();
-			QString sSampleFile;
-			uint16_t iOctaves = 0;
-			uint32_t iOffsetStart = 0;
-			uint32_t iOffsetEnd = 0;
-			uint32_t iLoopStart = 0;
-			uint32_t iLoopEnd = 0;
-			uint32_t iLoopFade = 0;
-			bool bLoopZero = true;
-			for (QDomNode nChild = eSample.firstChild();
-					!nChild.isNull();
-						nChild = nChild.nextSibling()) {
-				QDomElement eChild = nChild.toElement();
-				if (eChild.isNull())
-					continue;
-				if (eChild.tagName() == "filename") {
-					sSampleFile = eChild.text();
-				}
-				else
-				if (eChild.tagName() == "octaves") {
-					iOctaves = eChild.text().toUInt();
-				}
-				else
-				if (eChild.tagName() == "offset-start") {
-					iOffsetStart = eChild.text().toULong();
-				}
-				else
-				if (eChild.tagName() == "offset-end") {
-					iOffsetEnd = eChild.text().toULong();
-				}
-				else
-				if (eChild.tagName() == "loop-start") {
-					iLoopStart = eChild.text().toULong();
-				}
-				else
-				if (eChild.tagName() == "loop-end") {
-					iLoopEnd = eChild.text().toULong();
-				}
-				else
-				if (eChild.tagName() == "loop-fade") {
-					iLoopFade = eChild.text().toULong();
-				}
-				else
-				if (eChild.tagName() == "loop-zero") {
-					bLoopZero = (eChild.text().toInt() > 0);
-				}
+	samplv1_param::Preset preset;
+	samplv1_param::capturePreset(pSampl, preset);
+
+	return samplv1_param::savePreset(preset, sFilename, bSymLink);
+}
+
+
+// Shortest text that reads back as the very same float value.
+static std::string samplv1_param_floatText ( float fValue )
+{
+	for (int iPrecision = 6; iPrecision < 10; ++iPrecision) {
+		std::ostringstream ss;
+		ss.imbue(std::locale::classic());
+		ss.precision(iPrecision);
+		ss << fValue;
+		const std::string& sValue = ss.str();
+		if (iPrecision > 8 || samplv1_param_toFloat(sValue) == fValue)
+			return sValue;
+	}
+
+	return std::string();
+}
+
+
+// Simple text element (XML).
+static samplv1_xml samplv1_param_textElement (
+	const char *pszTagName, const std::string& sText )
+{
+	samplv1_xml eElement(pszTagName);
+	eElement.setText(sText);
+	return eElement;
+}
+
+
+bool samplv1_param::savePreset ( const samplv1_param::Preset& preset,
+	const std::string& sFilename, bool bSymLink )
+{
+	const std::string& sCurrentDir = samplv1_param_currentDir();
+	const std::string& sPresetDir = samplv1_param_absoluteDir(sFilename);
+	const std::string& sPresetFile = samplv1_param_absoluteFilePath(sFilename);
+	if (::chdir(sPresetDir.c_str()) != 0)
+		return false;
+
+	// Canonical (or symlinked) file references, relative to the preset...
+	const std::string& sSampleFile = (preset.sSampleFile.empty()
+		? std::string() : samplv1_param::saveFilename(preset.sSampleFile, bSymLink));
+	const std::string& sScaleFile = (preset.sTuningScaleFile.empty()
+		? std::string() : samplv1_param::saveFilename(preset.sTuningScaleFile, bSymLink));
+	const std::string& sKeyMapFile = (preset.sTuningKeyMapFile.empty()
+		? std::string() : samplv1_param::saveFilename(preset.sTuningKeyMapFile, bSymLink));
+
+	samplv1_zones::Zones zones(preset.zones);
+	samplv1_zones::Zones::iterator zone_iter = zones.begin();
+	for ( ; zone_iter != zones.end(); ++zone_iter) {
+		samplv1_zones::Zone& zone = *zone_iter;
+		zone.filename = samplv1_param::saveFilename(zone.filename, bSymLink);
+	}
+
+	// Preset file base name and (complete) suffix...
+	std::string sName(sPresetFile.substr(sPresetFile.rfind('/') + 1));
+	std::string sSuffix;
+	const size_t i = sName.rfind('.');
+	if (i != std::string::npos) {
+		sSuffix = sName.substr(i + 1);
+		sName.erase(i);
+	}
+
+	std::string data;
+
+	if (sSuffix == SAMPLV1_PRESET_BIN_EXT) {
+		samplv1_param::Preset preset2(preset);
+		preset2.sSampleFile = sSampleFile;
+		preset2.zones = zones;
+		preset2.sTuningScaleFile = sScaleFile;
+		preset2.sTuningKeyMapFile = sKeyMapFile;
+		data = samplv1_param::savePresetData(preset2, sPresetDir);
+	} else {
+		samplv1_xml ePreset("preset");
+		ePreset.setAttribute("name", sName);
+		ePreset.setAttribute("version", CONFIG_BUILD_VERSION);
+
+		samplv1_xml eSamples("samples");
+		if (preset.bSample) {
+			samplv1_xml eSample("sample");
+			eSample.setAttribute("index", "0");
+			eSample.setAttribute("name", "GEN1_SAMPLE");
+			eSample.appendChild(samplv1_param_textElement("filename",
+				samplv1_param_relativeFilePath(sPresetDir, sSampleFile)));
+			if (preset.iOctaves > 0) {
+				eSample.appendChild(samplv1_param_textElement("octaves",
+					std::to_string(preset.iOctaves)));
+			}
+			if (preset.iOffsetStart < preset.iOffsetEnd) {
+				eSample.appendChild(samplv1_param_textElement("offset-start",
+					std::to_string(preset.iOffsetStart)));
+				eSample.appendChild(samplv1_param_textElement("offset-end",
+					std::to_string(preset.iOffsetEnd)));
+			}
+			if (preset.iLoopStart < preset.iLoopEnd) {
+				eSample.appendChild(samplv1_param_textElement("loop-start",
+					std::to_string(preset.iLoopStart)));
+				eSample.appendChild(samplv1_param_textElement("loop-end",
+					std::to_string(preset.iLoopEnd)));
+				eSample.appendChild(samplv1_param_textElement("loop-fade",
+					std::to_string(preset.iLoopFade)));
+				eSample.appendChild(samplv1_param_textElement("loop-zero",
+					std::to_string(int(preset.bLoopZero))));
+			}
+			eSamples.appendChild(eSample);
+		}
+		ePreset.appendChild(eSamples);
+
+		if (!zones.empty()) {
+			samplv1_xml eZones("zones");
+			for (zone_iter = zones.begin(); zone_iter != zones.end(); ++zone_iter) {
+				const samplv1_zones::Zone& zone = *zone_iter;
+				samplv1_xml eZone("zone");
+				samplv1_param_saveZone(zone, eZone);
+				eZone.appendChild(samplv1_param_textElement("filename",
+					samplv1_param_relativeFilePath(sPresetDir, zone.filename)));
+				eZones.appendChild(eZone);
+			}
+			ePreset.appendChild(eZones);
+		}
+
+		samplv1_xml eParams("params");
+		for (uint32_t i = 0; i < samplv1::NUM_PARAMS; ++i) {
+			if (!preset.paramsSet[i])
+				continue;
+			const samplv1::ParamIndex index = samplv1::ParamIndex(i);
+			samplv1_xml eParam("param");
+			eParam.setAttribute("index", std::to_string(i));
+			eParam.setAttribute("name", samplv1_param::paramName(index));
+			eParam.setText(samplv1_param_floatText(preset.params[i]));
+			eParams.appendChild(eParam);
+		}
+		ePreset.appendChild(eParams);
+
+		if (preset.bTuning) {
+			samplv1_xml eTuning("tuning");
+			eTuning.setAttribute("enabled",
+				std::to_string(int(preset.bTuningEnabled)));
+			eTuning.appendChild(samplv1_param_textElement("ref-pitch",
+				samplv1_param_floatText(preset.fTuningRefPitch)));
+			eTuning.appendChild(samplv1_param_textElement("ref-note",
+				std::to_string(preset.iTuningRefNote)));
+			if (!sScaleFile.empty()) {
+				eTuning.appendChild(samplv1_param_textElement("scale-file",
+					samplv1_param_relativeFilePath(sPresetDir, sScaleFile)));
 			}
-			// Legacy loader...
-			if (sSampleFile.isEmpty())
-				sSampleFile = eSample.text();
-			// Done it.
-			const QByteArray aSampleFile
-				= mapPath.absolutePath(
-					samplv1_param::loadFilename(sSampleFile)).toUtf8();
-			pSampl->setSampleFile(aSampleFile.constData(), iOctaves);
-			// Set actual sample loop points...
-			pSampl->setLoopZero(bLoopZero);
-			pSampl->setLoopFade(iLoopFade);
-			pSampl->setLoopRange(iLoopStart, iLoopEnd);
-			pSampl->setOffsetRange(iOffsetStart, iOffsetEnd);
+			if (!sKeyMapFile.empty()) {
+				eTuning.appendChild(samplv1_param_textElement("keymap-file",
+					samplv1_param_relativeFilePath(sPresetDir, sKeyMapFile)));
+			}
+			ePreset.appendChild(eTuning);
 		}
+
+		data = ePreset.toString(SAMPLV1_TITLE);
 	}
 
-	// Consolidate sample state...
-	pSampl->updateSample();
+	if (!sCurrentDir.empty() && ::chdir(sCurrentDir.c_str()) != 0)
+		return false;
+
+	std::ofstream file(sPresetFile.c_str(),
+		std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	file.write(data.data(), data.size());
+	file.close();
+
+	return !file.fail();
 }
 
 
-void samplv1_param::saveSamples (
-	samplv1 *pSampl, QDomDocument& doc, QDomElement& eSamples,
-	const samplv1_param::map_path& mapPath, bool bSymLink )
+// Preset format conversion (XML <-> binary, by file suffix).
+bool samplv1_param::convertPreset (
+	const std::string& sInFilename, const std::string& sOutFilename )
 {
-	if (pSampl == nullptr)
-		return;
+	samplv1_param::Preset preset;
+	if (!samplv1_param::loadPreset(preset, sInFilename))
+		return false;
 
-	const char *pszSampleFile = pSampl->sampleFile();
-	if (pszSampleFile == nullptr)
-		return;
+	return samplv1_param::savePreset(preset, sOutFilename);
+}
 
-	QDomElement eSample = doc.createElement("sample");
-	eSample.setAttribute("index", 0);
-	eSample.setAttribute("name", "GEN1_SAMPLE");
-
-	QDomElement eFilename = doc.createElement("filename");
-	eFilename.appendChild(doc.createTextNode(mapPath.abstractPath(
-		samplv1_param::saveFilename(
-			QString::fromUtf8(pszSampleFile), bSymLink))));
-	eSample.appendChild(eFilename);
-
-	const uint16_t iOctaves = pSampl->octaves();
-	if (iOctaves > 0) {
-		QDomElement eOctaves = doc.createElement("octaves");
-		eOctaves.appendChild(doc.createTextNode(
-			QString::number(iOctaves)));
-		eSample.appendChild(eOctaves);
-	}
-
-	const uint32_t iOffsetStart = pSampl->offsetStart();
-	const uint32_t iOffsetEnd   = pSampl->offsetEnd();
-	if (iOffsetStart < iOffsetEnd) {
-		QDomElement eOffsetStart = doc.createElement("offset-start");
-		eOffsetStart.appendChild(doc.createTextNode(
-			QString::number(iOffsetStart)));
-		eSample.appendChild(eOffsetStart);
-		QDomElement eOffsetEnd = doc.createElement("offset-end");
-		eOffsetEnd.appendChild(doc.createTextNode(
-			QString::number(iOffsetEnd)));
-		eSample.appendChild(eOffsetEnd);
-	}
-
-	const uint32_t iLoopStart = pSampl->loopStart();
-	const uint32_t iLoopEnd   = pSampl->loopEnd();
-	const uint32_t iLoopFade  = pSampl->loopFade();
-	const bool     bLoopZero  = pSampl->isLoopZero();
-	if (iLoopStart < iLoopEnd) {
-		QDomElement eLoopStart = doc.createElement("loop-start");
-		eLoopStart.appendChild(doc.createTextNode(
-			QString::number(iLoopStart)));
-		eSample.appendChild(eLoopStart);
-		QDomElement eLoopEnd = doc.createElement("loop-end");
-		eLoopEnd.appendChild(doc.createTextNode(
-			QString::number(iLoopEnd)));
-		eSample.appendChild(eLoopEnd);
-		QDomElement eLoopFade = doc.createElement("loop-fade");
-		eLoopFade.appendChild(doc.createTextNode(
-			QString::number(iLoopFade)));
-		eSample.appendChild(eLoopFade);
-		QDomElement eLoopZero = doc.createElement("loop-zero");
-		eLoopZero.appendChild(doc.createTextNode(
-			QString::number(int(bLoopZero))));
-		eSample.appendChild(eLoopZero);
-	}
-
-	eSamples.appendChild(eSample);
-}
-
-
-// Tuning serialization methods.
+
+// Tuning serialization methods (legacy XML state).
 void samplv1_param::loadTuning (
-	samplv1 *pSampl, const QDomElement& eTuning )
+	samplv1 *pSampl, const samplv1_xml& eTuning )
 {
 	if (pSampl == nullptr)
 		return;
 
-	pSampl->setTuningEnabled(eTuning.attribute("enabled").toInt() > 0);
+	pSampl->setTuningEnabled(
+		samplv1_param_toLong(eTuning.attribute("enabled")) > 0);
 
-	for (QDomNode nChild = eTuning.firstChild();
-			!nChild.isNull();
-				nChild = nChild.nextSibling()) {
-		QDomElement eChild = nChild.toElement();
-		if (eChild.isNull())
-			continue;
+	samplv1_xml::List::const_iterator iter = eTuning.childNodes().begin();
+	for ( ; iter != eTuning.childNodes().end(); ++iter) {
+		const samplv1_xml& eChild = *iter;
 		if (eChild.tagName() == "enabled") {
-			pSampl->setTuningEnabled(eChild.text().toInt() > 0);
+			pSampl->setTuningEnabled(samplv1_param_toLong(eChild.text()) > 0);
 		}
 		if (eChild.tagName() == "ref-pitch") {
-			pSampl->setTuningRefPitch(eChild.text().toFloat());
+			pSampl->setTuningRefPitch(samplv1_param_toFloat(eChild.text()));
 		}
 		else
 		if (eChild.tagName() == "ref-note") {
-			pSampl->setTuningRefNote(eChild.text().toInt());
+			pSampl->setTuningRefNote(samplv1_param_toLong(eChild.text()));
 		}
 		else
 		if (eChild.tagName() == "scale-file") {
-			const QString& sScaleFile
-				= eChild.text();
-			const QByteArray aScaleFile
-				= samplv1_param::loadFilename(sScaleFile).toUtf8();
-			pSampl->setTuningScaleFile(aScaleFile.constData());
+			const std::string& sScaleFile
+				= samplv1_param::loadFilename(eChild.text());
+			pSampl->setTuningScaleFile(sScaleFile.c_str());
 		}
 		else
 		if (eChild.tagName() == "keymap-file") {
-			const QString& sKeyMapFile
-				= eChild.text();
-			const QByteArray aKeyMapFile
-				= samplv1_param::loadFilename(sKeyMapFile).toUtf8();
-			pSampl->setTuningScaleFile(aKeyMapFile.constData());
+			const std::string& sKeyMapFile
+				= samplv1_param::loadFilename(eChild.text());
+			pSampl->setTuningKeyMapFile(sKeyMapFile.c_str());
 		}
 	}
 
@@ -572,77 +1250,81 @@ void samplv1_param::loadTuning (
 }
 
 
-void samplv1_param::saveTuning (
-	samplv1 *pSampl, QDomDocument& doc, QDomElement& eTuning, bool bSymLink )
+// Load/save and convert canonical/absolute filename helpers.
+std::string samplv1_param::loadFilename ( const std::string& sFilename )
 {
-	if (pSampl == nullptr)
-		return;
+	std::string sTarget;
+	if (samplv1_param_symLinkTarget(sFilename, sTarget))
+		return sTarget;
+	else
+		return sFilename;
+}
 
-	eTuning.setAttribute("enabled", int(pSampl->isTuningEnabled()));
-
-	QDomElement eRefPitch = doc.createElement("ref-pitch");
-	eRefPitch.appendChild(doc.createTextNode(
-		QString::number(pSampl->tuningRefPitch())));
-	eTuning.appendChild(eRefPitch);
-
-	QDomElement eRefNote = doc.createElement("ref-note");
-	eRefNote.appendChild(doc.createTextNode(
-		QString::number(pSampl->tuningRefNote())));
-	eTuning.appendChild(eRefNote);
-
-	const char *pszScaleFile = pSampl->tuningScaleFile();
-	if (pszScaleFile) {
-		const QString& sScaleFile
-			= QString::fromUtf8(pszScaleFile);
-		if (!sScaleFile.isEmpty()) {
-			QDomElement eScaleFile = doc.createElement("scale-file");
-			eScaleFile.appendChild(doc.createTextNode(
-				QDir::current().relativeFilePath(
-					samplv1_param::saveFilename(sScaleFile, bSymLink))));
-			eTuning.appendChild(eScaleFile);
-		}
-	}
 
-	const char *pszKeyMapFile = pSampl->tuningKeyMapFile();
-	if (pszKeyMapFile) {
-		const QString& sKeyMapFile
-			= QString::fromUtf8(pszKeyMapFile);
-		if (!sKeyMapFile.isEmpty()) {
-			QDomElement eKeyMapFile = doc.createElement("keymap-file");
-			eKeyMapFile.appendChild(doc.createTextNode(
-				QDir::current().relativeFilePath(
-					samplv1_param::saveFilename(sKeyMapFile, bSymLink))));
-			eTuning.appendChild(eKeyMapFile);
+// Simple string hash, as Qt5's generic qHash(QString) over UTF-16 units.
+static uint32_t samplv1_param_hash ( const std::string& sText )
+{
+	uint32_t h = 0;
+
+	const size_t len = sText.length();
+	size_t i = 0;
+	while (i < len) {
+		uint32_t ch = uint8_t(sText[i++]);
+		int n = 0;
+		if (ch >= 0xf0) {
+			ch &= 0x07;
+			n = 3;
+		}
+		else
+		if (ch >= 0xe0) {
+			ch &= 0x0f;
+			n = 2;
 		}
+		else
+		if (ch >= 0xc0) {
+			ch &= 0x1f;
+			n = 1;
+		}
+		for ( ; n > 0 && i < len; --n)
+			ch = (ch << 6) | (uint8_t(sText[i++]) & 0x3f);
+		if (ch >= 0x10000) {
+			ch -= 0x10000;
+			h = 31 * h + (0xd800 + (ch >> 10));
+			h = 31 * h + (0xdc00 + (ch & 0x3ff));
+		}
+		else h = 31 * h + ch;
 	}
-}
-
 
-// Load/save and convert canonical/absolute filename helpers.
-QString samplv1_param::loadFilename ( const QString& sFilename )
-{
-	QFileInfo fi(sFilename);
-	if (fi.isSymLink())
-		fi.setFile(fi.symLinkTarget());
-	return fi.filePath();
+	return h;
 }
 
 
-QString samplv1_param::saveFilename ( const QString& sFilename, bool bSymLink )
+std::string samplv1_param::saveFilename ( const std::string& sFilename, bool bSymLink )
 {
-	QFileInfo fi(sFilename);
-	if (bSymLink && fi.absolutePath() != QDir::current().absolutePath()) {
-		const QString& sPath = fi.absoluteFilePath();
-		const QString& sName = fi.baseName();
-		const QString& sExt  = fi.completeSuffix();
-		const QString& sLink = sName
-			+ '-' + QString::number(qHash(sPath), 16)
-			+ '.' + sExt;
-		QFile(sPath).link(sLink);
-		fi.setFile(QDir::current(), sLink);
+	std::string sPath = samplv1_param_absoluteFilePath(sFilename);
+	const std::string& sCurrentDir = samplv1_param_currentDir();
+	if (bSymLink && samplv1_param_absoluteDir(sPath) != sCurrentDir) {
+		// Link name: base name, path hash and complete suffix...
+		const std::string& sFile = sPath.substr(sPath.rfind('/') + 1);
+		const size_t i = sFile.find('.');
+		const std::string& sName = sFile.substr(0, i);
+		const std::string& sExt  = (i == std::string::npos
+			? std::string() : sFile.substr(i + 1));
+		char szHash[16];
+		::snprintf(szHash, sizeof(szHash), "%x", samplv1_param_hash(sPath));
+		const std::string& sLink = sName + '-' + szHash + '.' + sExt;
+		// nb. an existing link is just reused (as with QFile::link)...
+		const int ret = ::symlink(sPath.c_str(), sLink.c_str());
+		(void) ret;
+		sPath = samplv1_param_absoluteFilePath(sCurrentDir, sLink);
 	}
-	else if (fi.isSymLink()) fi.setFile(fi.symLinkTarget());
-	return fi.absoluteFilePath();
+	else {
+		std::string sTarget;
+		if (samplv1_param_symLinkTarget(sPath, sTarget))
+			sPath = sTarget;
+	}
+
+	return sPath;
 }
 
 
@@ -23,12 +23,16 @@
 #define __samplv1_param_h
 
 #include "samplv1.h"
+#include "samplv1_zones.h"
 
-#include <QString>
+#include <string>
 
 // forward decl.
-class QDomElement;
-class QDomDocument;
+class samplv1_xml;
+
+
+// Binary preset file suffix.
+#define SAMPLV1_PRESET_BIN_EXT  "samplv1b"
 
 
 //-------------------------------------------------------------------------
@@ -37,37 +41,77 @@ class QDomDocument;
 
 namespace samplv1_param
 {
-	// Abstract/absolute path functors.
-	class map_path
+	// Preset snapshot (parsed, detached from any instance).
+	struct Preset
 	{
-	public:
-
-		virtual QString absolutePath(const QString& sAbstractPath) const;
-		virtual QString abstractPath(const QString& sAbsolutePath) const;
+		// ctor.
+		Preset() { clear(); }
+
+		// reset to nil.
+		void clear();
+
+		// parameter values (whether present).
+		float params[samplv1::NUM_PARAMS];
+		bool  paramsSet[samplv1::NUM_PARAMS];
+
+		// sample reference (absolute path) and settings.
+		bool     bSample;
+		std::string sSampleFile;
+		uint16_t iOctaves;
+		uint32_t iOffsetStart;
+		uint32_t iOffsetEnd;
+		uint32_t iLoopStart;
+		uint32_t iLoopEnd;
+		uint32_t iLoopFade;
+		bool     bLoopZero;
+
+		// key/velocity zones (absolute sample paths).
+		samplv1_zones::Zones zones;
+
+		// micro-tuning settings.
+		bool     bTuning;
+		bool     bTuningEnabled;
+		float    fTuningRefPitch;
+		int      iTuningRefNote;
+		std::string sTuningScaleFile;
+		std::string sTuningKeyMapFile;
 	};
 
+	// Preset snapshot methods.
+	bool loadPreset(Preset& preset,
+		const std::string& sFilename);
+	bool savePreset(const Preset& preset,
+		const std::string& sFilename,
+		bool bSymLink = false);
+	void capturePreset(samplv1 *pSampl,
+		Preset& preset);
+	void applyPreset(samplv1 *pSampl,
+		const Preset& preset);
+	void applyTuning(samplv1 *pSampl,
+		const Preset& preset);
+
+	// Binary preset snapshot methods (paths relative to base path).
+	bool isPresetData(const std::string& data);
+	bool loadPresetData(Preset& preset,
+		const std::string& data,
+		const std::string& sBasePath = std::string());
+	std::string savePresetData(const Preset& preset,
+		const std::string& sBasePath = std::string());
+
+	// Preset format conversion (XML <-> binary).
+	bool convertPreset(const std::string& sInFilename,
+		const std::string& sOutFilename);
+
 	// Preset serialization methods.
 	bool loadPreset(samplv1 *pSampl,
-		const QString& sFilename);
+		const std::string& sFilename);
 	bool savePreset(samplv1 *pSampl,
-		const QString& sFilename,
-		bool bSymLink = false);
-
-	// Sample serialization methods.
-	void loadSamples(samplv1 *pSampl,
-		const QDomElement& eSamples,
-		const map_path& mapPath = map_path());
-	void saveSamples(samplv1 *pSampl,
-		QDomDocument& doc, QDomElement& eSamples,
-		const map_path& mapPath = map_path(),
+		const std::string& sFilename,
 		bool bSymLink = false);
 
-	// Tuning serialization methods.
+	// Tuning serialization methods (legacy XML state).
 	void loadTuning(samplv1 *pSampl,
-		const QDomElement& eTuning);
-	void saveTuning(samplv1 *pSampl,
-		QDomDocument& doc, QDomElement& eTuning,
-		bool bSymLink = false);
+		const samplv1_xml& eTuning);
 
 	// Default parameter name/value helpers.
 	const char *paramName(samplv1::ParamIndex index);
@@ -78,8 +122,8 @@ namespace samplv1_param
 	bool paramFloat(samplv1::ParamIndex index);
 
 	// Load/save and convert canonical/absolute filename helpers.
-	QString loadFilename(const QString& sFilename);
-	QString saveFilename(const QString& sFilename, bool bSymLink);
+	std::string loadFilename(const std::string& sFilename);
+	std::string saveFilename(const std::string& sFilename, bool bSymLink);
 };
 
 
@@ -0,0 +1,282 @@
+// samplv1_peaks.cpp
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "samplv1_peaks.h"
+#include "samplv1_sample.h"
+
+#include <string.h>
+#include <math.h>
+
+
+// 8bit quantization helpers (min rounds down, max rounds up).
+static inline int8_t samplv1_peaks_qmin ( float v )
+{
+	const float q = ::floorf(v * 127.0f);
+	return int8_t(q < -127.0f ? -127 : (q > 127.0f ? 127 : int(q)));
+}
+
+static inline int8_t samplv1_peaks_qmax ( float v )
+{
+	const float q = ::ceilf(v * 127.0f);
+	return int8_t(q < -127.0f ? -127 : (q > 127.0f ? 127 : int(q)));
+}
+
+
+//-------------------------------------------------------------------------
+// samplv1_peaks - compact waveform peak summary (display).
+//
+
+// ctor.
+samplv1_peaks::samplv1_peaks (void)
+	: m_serial(0), m_nchannels(0), m_nframes(0)
+{
+	for (uint16_t level = 0; level < LEVELS; ++level) {
+		m_nbins[level] = 0;
+		m_ready[level] = 0;
+		m_data[level]  = nullptr;
+	}
+}
+
+
+// dtor.
+samplv1_peaks::~samplv1_peaks (void)
+{
+	clear();
+}
+
+
+// (re)build from the sample tables (non real-time).
+void samplv1_peaks::build ( const samplv1_sample *sample, uint32_t serial )
+{
+	if (sample == nullptr || !sample->isOpen()) {
+		reset(0, 0, serial);
+		return;
+	}
+
+	const uint16_t nchannels = sample->channels();
+	const uint32_t nframes = sample->length();
+
+	reset(nchannels, nframes, serial);
+
+	for (uint16_t level = 0; level < LEVELS; ++level) {
+		const uint32_t nbins = m_nbins[level];
+		int8_t *data = m_data[level];
+		uint32_t i1 = 0;
+		for (uint32_t j = 0; j < nbins; ++j) {
+			const uint32_t i2
+				= uint32_t((uint64_t(j + 1) * uint64_t(nframes)) / nbins);
+			for (uint16_t k = 0; k < nchannels; ++k) {
+				float vmin = 0.0f;
+				float vmax = 0.0f;
+				sample->peak(k, i1, i2, vmin, vmax);
+				*data++ = samplv1_peaks_qmin(vmin);
+				*data++ = samplv1_peaks_qmax(vmax);
+			}
+			i1 = i2;
+		}
+		m_ready[level] = nbins;
+	}
+}
+
+
+// (re)initialize, for chunk assembly.
+void samplv1_peaks::reset (
+	uint16_t nchannels, uint32_t nframes, uint32_t serial )
+{
+	alloc(nchannels, nframes);
+
+	m_serial = serial;
+}
+
+
+// clear all.
+void samplv1_peaks::clear (void)
+{
+	for (uint16_t level = 0; level < LEVELS; ++level) {
+		if (m_data[level]) {
+			delete [] m_data[level];
+			m_data[level] = nullptr;
+		}
+		m_nbins[level] = 0;
+		m_ready[level] = 0;
+	}
+
+	m_nchannels = 0;
+	m_nframes = 0;
+}
+
+
+// level bins (re)allocation.
+void samplv1_peaks::alloc ( uint16_t nchannels, uint32_t nframes )
+{
+	clear();
+
+	if (nchannels < 1 || nframes < 1)
+		return;
+
+	m_nchannels = nchannels;
+	m_nframes = nframes;
+
+	uint32_t nbins = BINS0;
+	for (uint16_t level = 0; level < LEVELS; ++level) {
+		if (nbins > nframes)
+			nbins = nframes;
+		// no finer than the frames themselves...
+		if (level > 0 && m_nbins[level - 1] >= nbins)
+			break;
+		m_nbins[level] = nbins;
+		m_data[level] = new int8_t [nbins * (nchannels << 1)];
+		::memset(m_data[level], 0, nbins * (nchannels << 1));
+		nbins <<= 2;
+	}
+}
+
+
+// chunk accessors.
+uint32_t samplv1_peaks::chunks (void) const
+{
+	const uint32_t nchunk = chunkBins();
+	if (nchunk < 1)
+		return 0;
+
+	uint32_t nchunks = 0;
+	for (uint16_t level = 0; level < LEVELS; ++level)
+		nchunks += (m_nbins[level] + nchunk - 1) / nchunk;
+
+	return nchunks;
+}
+
+
+uint32_t samplv1_peaks::getChunk ( uint32_t index,
+	uint16_t& level, uint32_t& offset, int8_t *data ) const
+{
+	level = 0;
+	offset = 0;
+
+	const uint32_t nchunk = chunkBins();
+	if (nchunk < 1)
+		return 0;
+
+	for ( ; level < LEVELS; ++level) {
+		const uint32_t nbins = m_ready[level];
+		const uint32_t nchunks = (nbins + nchunk - 1) / nchunk;
+		if (index < nchunks) {
+			offset = index * nchunk;
+			const uint32_t n = (offset + nchunk < nbins ? nchunk : nbins - offset);
+			const uint32_t nsize = (m_nchannels << 1);
+			::memcpy(data, m_data[level] + offset * nsize, n * nsize);
+			return n;
+		}
+		index -= nchunks;
+	}
+
+	level = 0;
+	return 0;
+}
+
+
+bool samplv1_peaks::setChunk ( uint16_t level, uint32_t offset,
+	const int8_t *data, uint32_t nbins )
+{
+	if (level >= LEVELS || offset + nbins > m_nbins[level])
+		return false;
+
+	// already there? (resent)
+	if (offset + nbins <= m_ready[level])
+		return true;
+
+	// out of order? (dropped)
+	if (offset != m_ready[level])
+		return false;
+
+	const uint32_t nsize = (m_nchannels << 1);
+	::memcpy(m_data[level] + offset * nsize, data, nbins * nsize);
+	m_ready[level] += nbins;
+
+	return true;
+}
+
+
+// finest complete level, if any.
+int samplv1_peaks::finest (void) const
+{
+	int level = LEVELS - 1;
+	while (level >= 0 && !isComplete(level))
+		--level;
+
+	return level;
+}
+
+
+// finest complete level bin width (in frames).
+uint32_t samplv1_peaks::resolution (void) const
+{
+	const int level = finest();
+	if (level < 0)
+		return 0;
+
+	const uint32_t nbins = m_nbins[level];
+	return (m_nframes + nbins - 1) / nbins;
+}
+
+
+// waveform peak range (min/max over frames [start, end)).
+void samplv1_peaks::peak ( uint16_t k, uint32_t start, uint32_t end,
+	float& vmin, float& vmax ) const
+{
+	vmin = vmax = 0.0f;
+
+	int level = finest();
+	if (level < 0 || k >= m_nchannels || start >= m_nframes)
+		return;
+
+	if (end > m_nframes)
+		end = m_nframes;
+	if (end <= start)
+		end = start + 1;
+
+	// coarsest complete level whose bins are not wider than the span...
+	const uint32_t nspan = end - start;
+	while (level > 0 && isComplete(level - 1)
+		&& (m_nframes / m_nbins[level - 1]) <= nspan)
+		--level;
+
+	const uint32_t nbins = m_nbins[level];
+	const uint32_t nsize = (m_nchannels << 1);
+	const int8_t *data = m_data[level] + (k << 1);
+
+	uint32_t j = uint32_t((uint64_t(start) * nbins) / m_nframes);
+	const uint32_t j2 = uint32_t((uint64_t(end - 1) * nbins) / m_nframes);
+	int vmin8 = data[j * nsize];
+	int vmax8 = data[j * nsize + 1];
+	while (++j <= j2) {
+		if (vmin8 > data[j * nsize])
+			vmin8 = data[j * nsize];
+		if (vmax8 < data[j * nsize + 1])
+			vmax8 = data[j * nsize + 1];
+	}
+
+	vmin = float(vmin8) / 127.0f;
+	vmax = float(vmax8) / 127.0f;
+}
+
+
+// end of samplv1_peaks.cpp
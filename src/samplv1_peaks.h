@@ -0,0 +1,129 @@
+// samplv1_peaks.h
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __samplv1_peaks_h
+#define __samplv1_peaks_h
+
+#include <stdint.h>
+
+
+// forward decls.
+class samplv1_sample;
+
+
+//-------------------------------------------------------------------------
+// samplv1_peaks - compact waveform peak summary (display).
+//
+// A few resolution levels of 8bit min/max pairs, each one four times
+// finer than the previous, built from the sample tables on one side
+// and assembled from fixed-size chunks on the other, so that it can
+// be shipped over to out-of-process user interfaces.
+//
+
+class samplv1_peaks
+{
+public:
+
+	// resolution levels (level 0 is the coarsest).
+	enum { LEVELS = 3, BINS0 = 256 };
+
+	// maximum chunk data size (bytes).
+	enum { CHUNK_SIZE = 1024 };
+
+	// ctor.
+	samplv1_peaks();
+
+	// dtor.
+	~samplv1_peaks();
+
+	// (re)build from the sample tables (non real-time).
+	void build(const samplv1_sample *sample, uint32_t serial);
+
+	// (re)initialize, for chunk assembly.
+	void reset(uint16_t nchannels, uint32_t nframes, uint32_t serial);
+
+	// clear all.
+	void clear();
+
+	// accessors.
+	uint32_t serial() const
+		{ return m_serial; }
+	uint16_t channels() const
+		{ return m_nchannels; }
+	uint32_t frames() const
+		{ return m_nframes; }
+
+	// number of bins per level (never more than frames).
+	uint32_t bins(uint16_t level) const
+		{ return (level < LEVELS ? m_nbins[level] : 0); }
+
+	// whether a level has been fully built or assembled.
+	bool isComplete(uint16_t level) const
+		{ return (level < LEVELS && m_nbins[level] > 0
+			&& m_ready[level] >= m_nbins[level]); }
+	bool isEmpty() const
+		{ return !isComplete(0); }
+
+	// number of bins per chunk.
+	uint32_t chunkBins() const
+		{ return (m_nchannels > 0 ? CHUNK_SIZE / (m_nchannels << 1) : 0); }
+
+	// chunk accessors (bins as min/max pairs, interleaved channels);
+	// chunks are numbered in level order, coarsest first.
+	uint32_t chunks() const;
+
+	uint32_t getChunk(uint32_t index,
+		uint16_t& level, uint32_t& offset, int8_t *data) const;
+	bool setChunk(uint16_t level, uint32_t offset,
+		const int8_t *data, uint32_t nbins);
+
+	// finest complete level bin width (in frames).
+	uint32_t resolution() const;
+
+	// waveform peak range (min/max over frames [start, end)).
+	void peak(uint16_t k, uint32_t start, uint32_t end,
+		float& vmin, float& vmax) const;
+
+protected:
+
+	// level bins (re)allocation.
+	void alloc(uint16_t nchannels, uint32_t nframes);
+
+	// finest complete level, if any.
+	int finest() const;
+
+private:
+
+	// instance variables.
+	uint32_t m_serial;
+	uint16_t m_nchannels;
+	uint32_t m_nframes;
+
+	uint32_t m_nbins[LEVELS];
+	uint32_t m_ready[LEVELS];
+
+	int8_t  *m_data[LEVELS];
+};
+
+
+#endif	// __samplv1_peaks_h
+
+// end of samplv1_peaks.h
@@ -21,6 +21,96 @@
 
 #include "samplv1_programs.h"
 
+#include "samplv1_sample.h"
+#include "samplv1_zones.h"
+#include "samplv1_epoch.h"
+
+
+//-------------------------------------------------------------------------
+// samplv1_programs::PreloadBank - preloaded bank (all programs).
+//
+
+class samplv1_programs::PreloadBank
+{
+public:
+
+	// max. number of (MIDI) programs.
+	static const uint16_t MAX_PROGS = 128;
+
+	// ctor.
+	PreloadBank(uint16_t bank_id) : m_bank_id(bank_id)
+	{
+		for (uint16_t i = 0; i < MAX_PROGS; ++i)
+			m_progs[i] = nullptr;
+	}
+
+	// dtor.
+	~PreloadBank()
+	{
+		for (uint16_t i = 0; i < MAX_PROGS; ++i)
+			delete m_progs[i];
+		std::map<std::string, samplv1_sample *>::const_iterator iter
+			= m_samples.begin();
+		for ( ; iter != m_samples.end(); ++iter)
+			delete iter->second;
+	}
+
+	// accessors.
+	uint16_t id() const
+		{ return m_bank_id; }
+
+	Preload *prog(uint16_t prog_id) const
+		{ return (prog_id < MAX_PROGS ? m_progs[prog_id] : nullptr); }
+
+	void set_prog(uint16_t prog_id, Preload *preload)
+		{ m_progs[prog_id] = preload; }
+
+	// sample tables, shared by all programs with the same setup.
+	samplv1_sample *find_sample(const std::string& key) const
+	{
+		std::map<std::string, samplv1_sample *>::const_iterator iter
+			= m_samples.find(key);
+		return (iter != m_samples.end() ? iter->second : nullptr);
+	}
+	void add_sample(const std::string& key, samplv1_sample *sample)
+		{ m_samples[key] = sample; }
+
+	bool has_sample(samplv1_sample *sample) const
+	{
+		std::map<std::string, samplv1_sample *>::const_iterator iter
+			= m_samples.begin();
+		for ( ; iter != m_samples.end(); ++iter) {
+			if (iter->second == sample)
+				return true;
+		}
+		return false;
+	}
+
+	void set_sample_rate(float srate)
+	{
+		std::map<std::string, samplv1_sample *>::const_iterator iter
+			= m_samples.begin();
+		for ( ; iter != m_samples.end(); ++iter)
+			iter->second->setSampleRate(srate);
+	}
+
+	bool has_prog(Preload *preload) const
+	{
+		return (preload
+			&& preload->bank_id == m_bank_id
+			&& prog(preload->prog_id) == preload);
+	}
+
+private:
+
+	// instance variables.
+	uint16_t m_bank_id;
+
+	Preload *m_progs[MAX_PROGS];
+
+	std::map<std::string, samplv1_sample *> m_samples;
+};
+
 
 //-------------------------------------------------------------------------
 // samplv1_programs - Bank/programs database class (singleton).
@@ -28,9 +118,10 @@
 
 // ctor.
 samplv1_programs::samplv1_programs ( samplv1 *pSampl )
-	: m_enabled(false), m_sched(pSampl),
+	: m_enabled(false), m_preload(false), m_sched(pSampl),
 		m_bank_msb(0), m_bank_lsb(0),
-		m_bank(nullptr), m_prog(nullptr)
+		m_bank(nullptr), m_prog(nullptr),
+		m_preload_bank(nullptr), m_preload_pending(nullptr)
 {
 }
 
@@ -39,25 +130,28 @@ samplv1_programs::samplv1_programs ( samplv1 *pSampl )
 samplv1_programs::~samplv1_programs (void)
 {
 	clear_banks();
+
+	preload_cleanup(nullptr, true);
 }
 
 
 // prog. managers
 samplv1_programs::Prog *samplv1_programs::Bank::find_prog ( uint16_t prog_id ) const
 {
-	return m_progs.value(prog_id, nullptr);
+	const Progs::const_iterator iter = m_progs.find(prog_id);
+	return (iter != m_progs.end() ? iter->second : nullptr);
 }
 
 
 samplv1_programs::Prog *samplv1_programs::Bank::add_prog (
-	uint16_t prog_id, const QString& prog_name )
+	uint16_t prog_id, const std::string& prog_name )
 {
 	Prog *prog = find_prog(prog_id);
 	if (prog) {
 		prog->set_name(prog_name);
 	} else {
 		prog = new Prog(prog_id, prog_name);
-		m_progs.insert(prog_id, prog);
+		m_progs[prog_id] = prog;
 	}
 	return prog;
 }
@@ -66,14 +160,17 @@ samplv1_programs::Prog *samplv1_programs::Bank::add_prog (
 void samplv1_programs::Bank::remove_prog ( uint16_t prog_id )
 {
 	Prog *prog = find_prog(prog_id);
-	if (prog && m_progs.remove(prog_id))
+	if (prog && m_progs.erase(prog_id))
 		delete prog;
 }
 
 
 void samplv1_programs::Bank::clear_progs (void)
 {
-	qDeleteAll(m_progs);
+	Progs::const_iterator iter = m_progs.begin();
+	for ( ; iter != m_progs.end(); ++iter)
+		delete iter->second;
+
 	m_progs.clear();
 }
 
@@ -81,19 +178,20 @@ void samplv1_programs::Bank::clear_progs (void)
 // bank managers
 samplv1_programs::Bank *samplv1_programs::find_bank ( uint16_t bank_id ) const
 {
-	return m_banks.value(bank_id, nullptr);
+	const Banks::const_iterator iter = m_banks.find(bank_id);
+	return (iter != m_banks.end() ? iter->second : nullptr);
 }
 
 
 samplv1_programs::Bank *samplv1_programs::add_bank (
-	uint16_t bank_id, const QString& bank_name )
+	uint16_t bank_id, const std::string& bank_name )
 {
 	Bank *bank = find_bank(bank_id);
 	if (bank) {
 		bank->set_name(bank_name);
 	} else {
 		bank = new Bank(bank_id, bank_name);
-		m_banks.insert(bank_id, bank);
+		m_banks[bank_id] = bank;
 	}
 	return bank;
 }
@@ -102,7 +200,7 @@ samplv1_programs::Bank *samplv1_programs::add_bank (
 void samplv1_programs::remove_bank ( uint16_t bank_id )
 {
 	Bank *bank = find_bank(bank_id);
-	if (bank && m_banks.remove(bank_id))
+	if (bank && m_banks.erase(bank_id))
 		delete bank;
 }
 
@@ -115,8 +213,28 @@ void samplv1_programs::clear_banks (void)
 	m_bank = nullptr;
 	m_prog = nullptr;
 
-	qDeleteAll(m_banks);
+	Banks::const_iterator iter = m_banks.begin();
+	for ( ; iter != m_banks.end(); ++iter)
+		delete iter->second;
+
 	m_banks.clear();
+
+	// preloaded bank is now stale...
+	m_preload_pending.store(nullptr);
+
+	preload_publish(nullptr);
+}
+
+
+// bank preload mode.
+void samplv1_programs::preload ( bool on )
+{
+	m_preload = on;
+
+	if (!m_preload) {
+		m_preload_pending.store(nullptr);
+		preload_publish(nullptr);
+	}
 }
 
 
@@ -170,6 +288,18 @@ void samplv1_programs::select_program ( uint16_t bank_id, uint16_t prog_id )
 		m_prog && m_prog->id() == prog_id)
 		return;
 
+	// preloaded bank? just swap it in on the next cycle...
+	if (m_preload) {
+		PreloadBank *pb = m_preload_bank.load();
+		if (pb && pb->id() == bank_id) {
+			Preload *preload = pb->prog(prog_id);
+			if (preload) {
+				m_preload_pending.store(preload);
+				return;
+			}
+		}
+	}
+
 	m_sched.select_program(bank_id, prog_id);
 }
 
@@ -180,11 +310,206 @@ void samplv1_programs::process_program (
 	m_bank = find_bank(bank_id);
 	m_prog = (m_bank ? m_bank->find_prog(prog_id) : nullptr);
 
-	if (m_prog) {
-		samplv1_param::loadPreset(pSampl, m_prog->name());
-		pSampl->updateSample();
-		pSampl->updateParams();
+	if (m_prog == nullptr)
+		return;
+
+	// preload the whole bank, then swap it in on the next cycle...
+	if (m_preload) {
+		PreloadBank *pb = preload_bank(pSampl, m_bank);
+		Preload *preload = (pb ? pb->prog(prog_id) : nullptr);
+		if (preload) {
+			m_preload_pending.store(preload);
+			return;
+		}
+	}
+
+	samplv1_param::loadPreset(pSampl, m_prog->name());
+	pSampl->updateSample();
+	pSampl->updateParams();
+}
+
+
+void samplv1_programs::process_preload (
+	samplv1 *pSampl, uint16_t bank_id, uint16_t prog_id )
+{
+	m_bank = find_bank(bank_id);
+	m_prog = (m_bank ? m_bank->find_prog(prog_id) : nullptr);
+
+	PreloadBank *pb = m_preload_bank.load();
+	Preload *preload = (pb && pb->id() == bank_id ? pb->prog(prog_id) : nullptr);
+	if (preload) {
+		// micro-tuning files are not for the audio thread...
+		pSampl->setTuningEnabled(false);
+		samplv1_param::applyTuning(pSampl, preload->preset);
+		// nor are the key/velocity zone samples...
+		pSampl->zones()->setZones(preload->preset.zones);
+	}
+
+	pSampl->updateSample();
+	pSampl->updateParams();
+}
+
+
+// preloaded bank (all programs).
+samplv1_programs::PreloadBank *samplv1_programs::preload_bank (
+	samplv1 *pSampl, Bank *bank )
+{
+	PreloadBank *pb = m_preload_bank.load();
+	if (pb && pb->id() == bank->id())
+		return pb;
+
+	// get rid of retired ones, first...
+	preload_cleanup(pSampl);
+
+	pb = new PreloadBank(bank->id());
+
+	const Progs& progs = bank->progs();
+	Progs::const_iterator prog_iter = progs.begin();
+	const Progs::const_iterator& prog_end = progs.end();
+	for ( ; prog_iter != prog_end; ++prog_iter) {
+		Prog *prog = prog_iter->second;
+		const uint16_t prog_id = prog->id();
+		if (prog_id >= PreloadBank::MAX_PROGS)
+			continue;
+		Preload *preload = new Preload;
+		preload->bank_id = bank->id();
+		preload->prog_id = prog_id;
+		preload->sample  = nullptr;
+		samplv1_param::Preset& preset = preload->preset;
+		if (!samplv1_param::loadPreset(preset, prog->name())) {
+			delete preload;
+			continue;
+		}
+		if (preset.bSample) {
+			const bool bReverse
+				= (preset.params[samplv1::GEN1_REVERSE] > 0.5f);
+			const bool bOffset
+				= (preset.params[samplv1::GEN1_OFFSET] > 0.5f);
+			const bool bLoop
+				= (preset.params[samplv1::GEN1_LOOP] > 0.5f);
+			// same file and setup makes the same sample tables...
+			const std::string& sKey = preset.sSampleFile
+				+ '|' + std::to_string(preset.iOctaves)
+				+ '|' + std::to_string(int(bReverse))
+				+ std::to_string(int(bOffset))
+				+ std::to_string(int(bLoop))
+				+ '|' + std::to_string(preset.iOffsetStart)
+				+ ':' + std::to_string(preset.iOffsetEnd)
+				+ '|' + std::to_string(preset.iLoopStart)
+				+ ':' + std::to_string(preset.iLoopEnd)
+				+ '|' + std::to_string(preset.iLoopFade)
+				+ '|' + std::to_string(int(preset.bLoopZero));
+			samplv1_sample *sample = pb->find_sample(sKey);
+			if (sample == nullptr) {
+				sample = new samplv1_sample(pSampl->sampleRate(), pSampl->epoch());
+				sample->setReverse(bReverse);
+				sample->setOffset(bOffset);
+				sample->setLoop(bLoop);
+				sample->setLoopZeroCrossing(preset.bLoopZero);
+				sample->setLoopCrossFade(preset.iLoopFade);
+				sample->open(preset.sSampleFile.c_str(), 1.0f, preset.iOctaves);
+				sample->setLoopRange(preset.iLoopStart, preset.iLoopEnd);
+				sample->setOffsetRange(preset.iOffsetStart, preset.iOffsetEnd);
+				pb->add_sample(sKey, sample);
+			}
+			preload->sample = sample;
+		}
+		pb->set_prog(prog_id, preload);
+	}
+
+	preload_publish(pb);
+
+	return m_preload_bank.load();
+}
+
+
+// swap in a new preloaded bank (or none), retiring the old one.
+void samplv1_programs::preload_publish ( PreloadBank *pb )
+{
+	std::lock_guard<std::mutex> lock(m_preload_mutex);
+
+	pb = m_preload_bank.exchange(pb);
+	if (pb) {
+		// the audio thread may still be looking into it...
+		samplv1_epoch *epoch = m_sched.instance()->epoch();
+		m_preload_gc.push_back({pb, epoch->current()});
+	}
+}
+
+
+// retired preloaded banks cleanup.
+void samplv1_programs::preload_cleanup ( samplv1 *pSampl, bool force )
+{
+	std::lock_guard<std::mutex> lock(m_preload_mutex);
+
+	samplv1_epoch *epoch = (pSampl ? pSampl->epoch() : nullptr);
+	samplv1_sample *sample = (pSampl ? pSampl->sample() : nullptr);
+	Preload *pending = m_preload_pending.load();
+
+	std::vector<PreloadGc>::iterator iter = m_preload_gc.begin();
+	while (iter != m_preload_gc.end()) {
+		PreloadBank *pb = iter->bank;
+		if (!force && epoch) {
+			// still in use by the audio thread? (last seen now)
+			if (pb->has_sample(sample) || pb->has_prog(pending)) {
+				iter->epoch = epoch->current();
+				++iter;
+				continue;
+			}
+			// may it still be held since last seen? (grace period)
+			if (!epoch->elapsed(iter->epoch)) {
+				++iter;
+				continue;
+			}
+		}
+		iter = m_preload_gc.erase(iter);
+		delete pb;
+	}
+
+	if (force) {
+		delete m_preload_bank.exchange(nullptr);
+		m_preload_pending.store(nullptr);
+	}
+}
+
+
+// copy-on-edit (false if not a preloaded, shared sample).
+bool samplv1_programs::preload_copy ( samplv1_sample *dst, samplv1_sample *src )
+{
+	std::lock_guard<std::mutex> lock(m_preload_mutex);
+
+	// none gets freed while locked...
+	bool shared = false;
+
+	PreloadBank *pb = m_preload_bank.load();
+	if (pb && pb->has_sample(src))
+		shared = true;
+
+	std::vector<PreloadGc>::const_iterator iter = m_preload_gc.begin();
+	for ( ; !shared && iter != m_preload_gc.end(); ++iter) {
+		if (iter->bank->has_sample(src))
+			shared = true;
 	}
+
+	if (shared)
+		dst->copy(*src);
+
+	return shared;
+}
+
+
+// preloaded samples sample-rate.
+void samplv1_programs::setSampleRate ( float srate )
+{
+	std::lock_guard<std::mutex> lock(m_preload_mutex);
+
+	PreloadBank *pb = m_preload_bank.load();
+	if (pb)
+		pb->set_sample_rate(srate);
+
+	std::vector<PreloadGc>::const_iterator iter = m_preload_gc.begin();
+	for ( ; iter != m_preload_gc.end(); ++iter)
+		iter->bank->set_sample_rate(srate);
 }
 
 
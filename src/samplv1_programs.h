@@ -25,7 +25,16 @@
 #include "samplv1_sched.h"
 #include "samplv1_param.h"
 
-#include <QMap>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <atomic>
+#include <mutex>
+
+
+// forward decls.
+class samplv1_sample;
 
 
 //-------------------------------------------------------------------------
@@ -48,32 +57,37 @@ public:
 	bool enabled() const
 		{ return m_enabled; }
 
+	// bank preload mode flags.
+	void preload(bool on);
+	bool preload() const
+		{ return m_preload; }
+
 	// prog. base node
 	class Prog
 	{
 	public:
 
-		Prog(uint16_t id, const QString& name)
+		Prog(uint16_t id, const std::string& name)
 			: m_id(id), m_name(name) {}
 
 		uint16_t id() const	{ return m_id; }
-		const QString& name() const	{ return m_name; }
-		void set_name(const QString& name) { m_name = name; }
+		const std::string& name() const	{ return m_name; }
+		void set_name(const std::string& name) { m_name = name; }
 
 	private:
 
-		uint16_t m_id;
-		QString  m_name;
+		uint16_t    m_id;
+		std::string m_name;
 	};
 
-	typedef QMap<uint16_t, Prog *> Progs;
+	typedef std::map<uint16_t, Prog *> Progs;
 
 	// bank node
 	class Bank : public Prog
 	{
 	public:
 
-		Bank(uint16_t id, const QString& name)
+		Bank(uint16_t id, const std::string& name)
 			: Prog(id, name) {}
 
 		~Bank() { clear_progs(); }
@@ -82,7 +96,7 @@ public:
 
 		// prog. managers
 		Prog *find_prog(uint16_t prog_id) const;
-		Prog *add_prog(uint16_t prog_id, const QString& prog_name);
+		Prog *add_prog(uint16_t prog_id, const std::string& prog_name);
 		void remove_prog(uint16_t prog_id);
 		void clear_progs();
 
@@ -91,13 +105,13 @@ public:
 		Progs m_progs;
 	};
 
-	typedef QMap<uint16_t, Bank *> Banks;
+	typedef std::map<uint16_t, Bank *> Banks;
 
 	const Banks& banks() const { return m_banks; }
 
 	// bank managers
 	Bank *find_bank(uint16_t bank_id) const;
-	Bank *add_bank(uint16_t bank_id, const QString& bank_name);
+	Bank *add_bank(uint16_t bank_id, const std::string& bank_name);
 	void remove_bank(uint16_t bank_id);
 
 	void clear_banks();
@@ -116,10 +130,50 @@ public:
 	Bank *current_bank() const { return m_bank; }
 	Prog *current_prog() const { return m_prog; }
 
+	// preloaded program (parsed preset and prepared sample).
+	struct Preload
+	{
+		uint16_t bank_id;
+		uint16_t prog_id;
+
+		samplv1_param::Preset preset;
+		samplv1_sample *sample;
+	};
+
+	// preloaded program change, pending on the audio thread.
+	Preload *preload_pending()
+		{ return m_preload_pending.exchange(nullptr); }
+
+	// preloaded program change, applied on the audio thread.
+	void preload_applied(Preload *preload)
+		{ m_sched.select_preload(preload->bank_id, preload->prog_id); }
+
+	void process_preload(samplv1 *pSampl, uint16_t bank_id, uint16_t prog_id);
+
+	// copy-on-edit (false if not a preloaded, shared sample).
+	bool preload_copy(samplv1_sample *dst, samplv1_sample *src);
+
+	// preloaded samples sample-rate.
+	void setSampleRate(float srate);
+
 protected:
 
 	uint16_t current_bank_id() const;
 
+	// preloaded bank (all programs).
+	class PreloadBank;
+
+	PreloadBank *preload_bank(samplv1 *pSampl, Bank *bank);
+	void preload_publish(PreloadBank *pb);
+	void preload_cleanup(samplv1 *pSampl, bool force = false);
+
+	// retired preloaded bank (last seen in use at epoch).
+	struct PreloadGc
+	{
+		PreloadBank *bank;
+		uint32_t     epoch;
+	};
+
 	// current bank/prog. scheduled thread
 	class Sched : public samplv1_sched
 	{
@@ -136,16 +190,27 @@ protected:
 				m_prog_id != prog_id) {
 				m_bank_id  = bank_id;
 				m_prog_id  = prog_id;
-				schedule();
+				schedule(0);
 			}
 		}
 
+		// schedule (preloaded, already swapped in)
+		void select_preload(uint16_t bank_id, uint16_t prog_id)
+		{
+			m_bank_id  = bank_id;
+			m_prog_id  = prog_id;
+			schedule(1);
+		}
+
 		// process (virtual).
-		void process(int)
+		void process(int sid)
 		{
 			samplv1 *pSampl = instance();
 			samplv1_programs *pPrograms = pSampl->programs();
-			pPrograms->process_program(pSampl, m_bank_id, m_prog_id);
+			if (sid > 0)
+				pPrograms->process_preload(pSampl, m_bank_id, m_prog_id);
+			else
+				pPrograms->process_program(pSampl, m_bank_id, m_prog_id);
 		}
 
 	private:
@@ -159,6 +224,7 @@ private:
 
 	// instance variables.
 	bool m_enabled;
+	bool m_preload;
 
 	Sched m_sched;
 
@@ -169,6 +235,12 @@ private:
 	Prog *m_prog;
 
 	Banks m_banks;
+
+	std::atomic<PreloadBank *> m_preload_bank;
+	std::atomic<Preload *> m_preload_pending;
+
+	std::vector<PreloadGc> m_preload_gc;
+	std::mutex m_preload_mutex;
 };
 
 
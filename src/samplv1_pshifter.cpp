@@ -153,13 +153,114 @@ void samplv1_rubberband_pshifter::process (
 
 #include <math.h>
 
+#include <mutex>
+
 #ifdef CONFIG_FFTW3
-// nothing here.
+
+//---------------------------------------------------------------------------
+// samplv1_fftw_plans - FFTW plan cache (per size, process wide).
+//
+
+class samplv1_fftw_plans
+{
+public:
+
+	samplv1_fftw_plans(uint32_t nsize);
+
+	samplv1_fftw_plans *next;
+	uint32_t   nsize;
+	fftwf_plan aplan;
+	fftwf_plan splan;
+
+	static samplv1_fftw_plans *get(uint32_t nsize);
+
+	static void setWisdomFile(const char *filename);
+
+private:
+
+	static samplv1_fftw_plans *g_list;
+	static char *g_wisdom;
+	static bool  g_wisdom_loaded;
+};
+
+
+// FFTW planner lock (not thread-safe; tables may be built concurrently).
+static std::mutex g_fftw_mutex;
+
+samplv1_fftw_plans *samplv1_fftw_plans::g_list = nullptr;
+char *samplv1_fftw_plans::g_wisdom = nullptr;
+bool  samplv1_fftw_plans::g_wisdom_loaded = false;
+
+
+samplv1_fftw_plans::samplv1_fftw_plans ( uint32_t nsize0 )
+	: next(nullptr), nsize(nsize0)
+{
+	// plan on scratch arrays, executed later on any alike aligned ones...
+	float *idata = ::fftwf_alloc_real(nsize << 1);
+	float *odata = ::fftwf_alloc_real(nsize << 1);
+	aplan = ::fftwf_plan_r2r_1d(nsize, idata, odata, FFTW_R2HC, FFTW_MEASURE);
+	splan = ::fftwf_plan_r2r_1d(nsize, idata, odata, FFTW_HC2R, FFTW_MEASURE);
+	::fftwf_free(odata);
+	::fftwf_free(idata);
+}
+
+
+samplv1_fftw_plans *samplv1_fftw_plans::get ( uint32_t nsize )
+{
+	std::lock_guard<std::mutex> lock(g_fftw_mutex);
+
+	if (!g_wisdom_loaded) {
+		g_wisdom_loaded = true;
+		if (g_wisdom)
+			::fftwf_import_wisdom_from_filename(g_wisdom);
+	}
+
+	samplv1_fftw_plans *plans = g_list;
+	while (plans) {
+		if (plans->nsize == nsize)
+			return plans;
+		plans = plans->next;
+	}
+
+	plans = new samplv1_fftw_plans(nsize);
+	plans->next = g_list;
+	g_list = plans;
+
+	// persist any new wisdom...
+	if (g_wisdom)
+		::fftwf_export_wisdom_to_filename(g_wisdom);
+
+	return plans;
+}
+
+
+void samplv1_fftw_plans::setWisdomFile ( const char *filename )
+{
+	std::lock_guard<std::mutex> lock(g_fftw_mutex);
+
+	if (g_wisdom) {
+		::free(g_wisdom);
+		g_wisdom = nullptr;
+	}
+
+	if (filename)
+		g_wisdom = ::strdup(filename);
+
+	g_wisdom_loaded = false;
+}
+
 #else
 
-/* 
-	FFT routine, (C) 1996 Stephan M. Bernsee.
-	
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+//---------------------------------------------------------------------------
+// samplv1_smbfft - Built-in FFT, with shared precomputed tables.
+//
+/*
+	Based on the FFT routine, (C) 1996 Stephan M. Bernsee.
+
 	sign = +1 is FFT (direct); -1 is iFFT (inverse).
 
 	Fills pframes[0...2*nsize-1] with the Fourier transform of the
@@ -171,56 +272,200 @@ void samplv1_rubberband_pshifter::process (
 	to be passed as {in[0],0,in[1],0,in[2],0,...} asf. In that case,
 	the transform of the frequencies of interest is in pframes[0...nsize].
 */
-static
-void smbFft ( float *pframes, uint32_t nframes, int sign )
+
+class samplv1_smbfft
+{
+public:
+
+	samplv1_smbfft(uint32_t nsize0);
+	~samplv1_smbfft();
+
+	samplv1_smbfft *next;
+	uint32_t  refc;
+	uint32_t  nsize;
+
+	void process(float *pframes, int sign) const;
+
+	static samplv1_smbfft *create(uint32_t nsize);
+	static void destroy(samplv1_smbfft *fft);
+
+private:
+
+	// bit-reversal swap pairs (complex index).
+	uint32_t *swaps;
+	uint32_t  nswaps;
+
+	// twiddles, per stage: real (doubled), imag (signed) interleaved.
+	float    *twids;
+
+	static samplv1_smbfft *g_list;
+	static std::mutex g_mutex;
+};
+
+
+samplv1_smbfft *samplv1_smbfft::g_list = nullptr;
+std::mutex samplv1_smbfft::g_mutex;
+
+
+samplv1_smbfft::samplv1_smbfft ( uint32_t nsize0 )
+	: next(nullptr), refc(0), nsize(nsize0), swaps(nullptr), nswaps(0)
 {
-	uint32_t i, bitm, j, le, le2, k;
-	float wr, wi, arg, *p1, *p2, temp;
-	float tr, ti, ur, ui, *p1r, *p1i, *p2r, *p2i;
-
-	const uint32_t nsize2 = (nframes << 1);
-	for (i = 2; i < nsize2 - 2; i += 2) {
-		for (bitm = 2, j = 0; bitm < nsize2; bitm <<= 1) {
-			if (i & bitm) ++j;
+	uint32_t i, j, bitm;
+
+	// bit-reversal permutation...
+	swaps = new uint32_t [nsize];
+	for (i = 1; i < nsize - 1; ++i) {
+		for (bitm = 1, j = 0; bitm < nsize; bitm <<= 1) {
 			j <<= 1;
+			if (i & bitm) j |= 1;
 		}
 		if (i < j) {
-			p1 = pframes + i; p2 = pframes + j;
-			temp = *p1; *(p1++) = *p2;
-			*(p2++) = temp; temp = *p1;
-			*p1 = *p2; *p2 = temp;
+			swaps[nswaps++] = i;
+			swaps[nswaps++] = j;
+		}
+	}
+
+	// twiddle factors (direct transform)...
+	twids = new float [nsize << 2];
+	float *w = twids;
+	for (uint32_t h = 1; h < nsize; h <<= 1) {
+		const float arg = M_PI / float(h);
+		for (j = 0; j < h; ++j) {
+			const float wr = ::cosf(arg * float(j));
+			const float wi = -::sinf(arg * float(j));
+			w[0] = wr; w[1] = wr;
+			w[(h << 1) + 0] = -wi;
+			w[(h << 1) + 1] = +wi;
+			w += 2;
+		}
+		w += (h << 1);
+	}
+}
+
+
+samplv1_smbfft::~samplv1_smbfft (void)
+{
+	delete [] twids;
+	delete [] swaps;
+}
+
+
+void samplv1_smbfft::process ( float *pframes, int sign ) const
+{
+	uint32_t i, j, b;
+
+	for (i = 0; i < nswaps; i += 2) {
+		float *p1 = pframes + (swaps[i] << 1);
+		float *p2 = pframes + (swaps[i + 1] << 1);
+		const float tr = p1[0];
+		const float ti = p1[1];
+		p1[0] = p2[0]; p1[1] = p2[1];
+		p2[0] = tr; p2[1] = ti;
+	}
+
+	const uint32_t nsize2 = (nsize << 1);
+	const float *w = twids;
+	for (uint32_t h = 1; h < nsize; h <<= 1) {
+		const uint32_t le2 = (h << 1);	// floats per half-block.
+		const uint32_t le  = (h << 2);	// floats per block.
+		const float *wr = w;
+		const float *wi = w + le2;
+	#if defined(__SSE__)
+		if (h > 1) {
+			const __m128 vs = _mm_set1_ps(float(sign));
+			for (b = 0; b < nsize2; b += le) {
+				float *p1 = pframes + b;
+				float *p2 = p1 + le2;
+				for (j = 0; j < le2; j += 4) {
+					const __m128 a = _mm_loadu_ps(p1 + j);
+					const __m128 c = _mm_loadu_ps(p2 + j);
+					const __m128 cs = _mm_shuffle_ps(c, c, _MM_SHUFFLE(2, 3, 0, 1));
+					const __m128 t = _mm_add_ps(
+						_mm_mul_ps(c, _mm_loadu_ps(wr + j)),
+						_mm_mul_ps(_mm_mul_ps(cs, _mm_loadu_ps(wi + j)), vs));
+					_mm_storeu_ps(p2 + j, _mm_sub_ps(a, t));
+					_mm_storeu_ps(p1 + j, _mm_add_ps(a, t));
+				}
+			}
+			w += le;
+			continue;
+		}
+	#endif
+		for (b = 0; b < nsize2; b += le) {
+			float *p1 = pframes + b;
+			float *p2 = p1 + le2;
+			for (j = 0; j < le2; j += 2) {
+				const float ur = wr[j];
+				const float ui = float(sign) * wi[j + 1];
+				const float tr = p2[j] * ur - p2[j + 1] * ui;
+				const float ti = p2[j] * ui + p2[j + 1] * ur;
+				p2[j] = p1[j] - tr; p2[j + 1] = p1[j + 1] - ti;
+				p1[j] += tr; p1[j + 1] += ti;
+			}
 		}
+		w += le;
 	}
+}
+
+
+samplv1_smbfft *samplv1_smbfft::create ( uint32_t nsize )
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+
+	samplv1_smbfft *fft = g_list;
+	while (fft) {
+		if (fft->nsize == nsize) {
+			++fft->refc;
+			return fft;
+		}
+		fft = fft->next;
+	}
+
+	fft = new samplv1_smbfft(nsize);
+	fft->refc = 1;
+	fft->next = g_list;
+	g_list = fft;
+
+	return fft;
+}
 
-	const uint32_t nsize = uint32_t(::rintf(::log2f(nframes)));
-	for (k = 0, le = 2; k < nsize; ++k) {
-		le <<= 1;
-		le2 = (le >> 1);
-		ur = 1.0f;
-		ui = 0.0f;
-		arg = M_PI / (le2 >> 1);
-		wr = ::cosf(arg);
-		wi = - sign * ::sinf(arg);
-		for (j = 0; j < le2; j += 2) {
-			p1r = pframes + j; p1i = p1r + 1;
-			p2r = p1r + le2; p2i = p2r + 1;
-			for (i = j; i < nsize2; i += le) {
-				tr = *p2r * ur - *p2i * ui;
-				ti = *p2r * ui + *p2i * ur;
-				*p2r = *p1r - tr; *p2i = *p1i - ti;
-				*p1r += tr; *p1i += ti;
-				p1r += le; p1i += le;
-				p2r += le; p2i += le;
+
+void samplv1_smbfft::destroy ( samplv1_smbfft *fft )
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+
+	if (fft && --fft->refc == 0) {
+		samplv1_smbfft *p = g_list;
+		samplv1_smbfft *q = nullptr;
+		while (p) {
+			if (p == fft) {
+				if (q)
+					q->next = fft->next;
+				else
+					g_list = fft->next;
+				break;
 			}
-			tr = ur * wr - ui * wi;
-			ui = ur * wi + ui * wr;
-			ur = tr;
+			q = p;
+			p = p->next;
 		}
+		delete fft;
 	}
 }
 
 #endif	// CONFIG_FFTW3
 
+
+// FFT wisdom persistence file (FFTW only).
+void samplv1_pshifter::setWisdomFile ( const char *filename )
+{
+#ifdef CONFIG_FFTW3
+	samplv1_fftw_plans::setWisdomFile(filename);
+#else
+	(void) filename;
+#endif
+}
+
+
 //---------------------------------------------------------------------------
 // samplv1_smbernsee_pshifter - S.M.Bernsee pitch-shift processor.
 //
@@ -235,8 +480,8 @@ samplv1_smbernsee_pshifter::samplv1_smbernsee_pshifter (
 	m_ififo = new float [m_nsize];
 	m_ofifo = new float [m_nsize];
 #ifdef CONFIG_FFTW3
-	m_idata = new float [m_nsize << 1];
-	m_odata = new float [m_nsize << 1];
+	m_idata = ::fftwf_alloc_real(m_nsize << 1);
+	m_odata = ::fftwf_alloc_real(m_nsize << 1);
 #else
 	m_fdata = new float [m_nsize << 1];
 #endif
@@ -265,9 +510,11 @@ samplv1_smbernsee_pshifter::samplv1_smbernsee_pshifter (
 	::memset(m_amagn, 0, m_nsize * sizeof(float));
 
 #ifdef CONFIG_FFTW3
-	// create plans
-	m_aplan = ::fftwf_plan_r2r_1d(nsize, m_idata, m_odata, FFTW_R2HC, FFTW_ESTIMATE);
-	m_splan = ::fftwf_plan_r2r_1d(nsize, m_idata, m_odata, FFTW_HC2R, FFTW_ESTIMATE);
+	// get shared plans (cached)
+	m_plans = samplv1_fftw_plans::get(m_nsize);
+#else
+	// get shared tables (cached)
+	m_fft = samplv1_smbfft::create(m_nsize);
 #endif
 
 	// pre-compute windowing table...
@@ -279,10 +526,9 @@ samplv1_smbernsee_pshifter::samplv1_smbernsee_pshifter (
 // Destructor.
 samplv1_smbernsee_pshifter::~samplv1_smbernsee_pshifter (void)
 {
-#ifdef CONFIG_FFTW3
-	// destroy plans
-	::fftwf_destroy_plan(m_splan);
-	::fftwf_destroy_plan(m_aplan);
+#ifndef CONFIG_FFTW3
+	// release shared tables
+	samplv1_smbfft::destroy(m_fft);
 #endif
 	// de-allocate working arrays
 	delete [] m_smagn;
@@ -293,8 +539,8 @@ samplv1_smbernsee_pshifter::~samplv1_smbernsee_pshifter (void)
 	delete [] m_phase;
 	delete [] m_plast;
 #ifdef CONFIG_FFTW3
-	delete [] m_odata;
-	delete [] m_idata;
+	::fftwf_free(m_odata);
+	::fftwf_free(m_idata);
 #else
 	delete [] m_fdata;
 #endif
@@ -359,9 +605,9 @@ void samplv1_smbernsee_pshifter::process_k (
 			// analysis direct transform...
 			//
 		#ifdef CONFIG_FFTW3
-			::fftwf_execute(m_aplan);
+			::fftwf_execute_r2r(m_plans->aplan, m_idata, m_odata);
 		#else
-			smbFft(m_fdata, m_nsize, +1);
+			m_fft->process(m_fdata, +1);
 		#endif
 
 			// this is the analysis step...
@@ -458,12 +704,12 @@ void samplv1_smbernsee_pshifter::process_k (
 			// synthesis inverse transform...
 			//
 		#ifdef CONFIG_FFTW3
-			::fftwf_execute(m_splan);
+			::fftwf_execute_r2r(m_plans->splan, m_idata, m_odata);
 		#else
 			// zero negative frequencies
 			for (j = m_nsize + 2; j < (m_nsize << 1); ++j)
 				m_fdata[j] = 0.0f;
-			smbFft(m_fdata, m_nsize, -1);
+			m_fft->process(m_fdata, -1);
 		#endif
 
 			// do windowing and add to output accumulator
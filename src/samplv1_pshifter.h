@@ -51,6 +51,9 @@ public:
 	static void setDefaultType(Type type);
 	static Type defaultType();
 
+	// FFT wisdom persistence file (FFTW only).
+	static void setWisdomFile(const char *filename);
+
 	// Factory methods.
 	static samplv1_pshifter *create(
 		uint16_t nchannels, float srate,
@@ -99,6 +102,9 @@ public:
 
 #ifdef CONFIG_FFTW3
 #include <fftw3.h>
+class samplv1_fftw_plans;
+#else
+class samplv1_smbfft;
 #endif
 
 class samplv1_smbernsee_pshifter : public samplv1_pshifter
@@ -144,8 +150,9 @@ private:
 	float *m_sfreq;
 	float *m_smagn;
 #ifdef CONFIG_FFTW3
-	fftwf_plan m_aplan;
-	fftwf_plan m_splan;
+	samplv1_fftw_plans *m_plans;
+#else
+	samplv1_smbfft *m_fft;
 #endif
 };
 
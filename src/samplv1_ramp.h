@@ -87,6 +87,26 @@ public:
 		return (n < m_frames ? (m_value0[i] + float(n) * m_delta[i]) : m_value1[i]);
 	}
 
+	// block render (closed form, as value(n0 + j) for j < nframes).
+	void render(float *out, uint32_t n0, uint32_t nframes, uint16_t i = 0) const
+	{
+		uint32_t j = 0;
+
+		if (n0 < m_frames) {
+			uint32_t nramp = m_frames - n0;
+			if (nramp > nframes)
+				nramp = nframes;
+			const float v0 = m_value0[i] + float(n0) * m_delta[i];
+			const float dv = m_delta[i];
+			for ( ; j < nramp; ++j)
+				out[j] = v0 + float(j) * dv;
+		}
+
+		const float v1 = m_value1[i];
+		for ( ; j < nframes; ++j)
+			out[j] = v1;
+	}
+
 protected:
 
 	virtual bool probe() const = 0;
@@ -1,7 +1,7 @@
 // samplv1_resampler.cpp
 //
 /****************************************************************************
-   Copyright (C) 2017-2019, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2017-2020, rncbc aka Rui Nuno Capela. All rights reserved.
    Copyright (C) 2006-2012 Fons Adriaensen <fons@linuxaudio.org>
 
    This program is free software; you can redistribute it and/or
@@ -22,11 +22,18 @@
 
 #include "samplv1_resampler.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <math.h>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 
 // ----------------------------------------------------------------------------
 // samplv1_resampler
@@ -57,13 +64,16 @@ samplv1_resampler::Mutex  samplv1_resampler::Table::g_mutex;
 
 samplv1_resampler::Table::Table (
 	float fr0, unsigned int hl0, unsigned int np0 )
-	: next(nullptr), refc(0), ctab(nullptr), fr(fr0), hl(hl0), np(np0)
+	: next(nullptr), refc(0), ctab(nullptr), fr(fr0), hl(hl0), np(np0),
+		cbuf(nullptr)
 {
 	unsigned int i, j;
 	float t;
 	float *ptab;
 
-	ctab = new float [hl * (np + 1)];
+	// 32-byte aligned, for the SIMD inner product...
+	cbuf = new float [hl * (np + 1) + 8];
+	ctab = (float *) ((uintptr_t(cbuf) + 31) & ~uintptr_t(31));
 	ptab = ctab;
 	for (j = 0; j <= np; ++j) {
 		t = float(j) / float(np);
@@ -78,7 +88,7 @@ samplv1_resampler::Table::Table (
 
 samplv1_resampler::Table::~Table (void)
 {
-	delete [] ctab;
+	delete [] cbuf;
 }
 
 
@@ -147,6 +157,53 @@ void samplv1_resampler::Table::destroy ( samplv1_resampler::Table *table )
 // samplv1_resampler
 
 
+// single channel inner product (q2 walks backwards).
+static inline float dot1 ( const float *q1, const float *q2,
+	const float *c1, const float *c2, unsigned int hl )
+{
+	unsigned int i = 0;
+	float s = 1e-20f;
+
+#if defined(__AVX__)
+	if (hl >= 8) {
+		__m256 v = _mm256_setzero_ps();
+		for (; i + 8 <= hl; i += 8) {
+			__m256 x2 = _mm256_loadu_ps(q2 - 8 - i);
+			x2 = _mm256_permute2f128_ps(x2, x2, 1);
+			x2 = _mm256_permute_ps(x2, 0x1b);
+			v = _mm256_add_ps(v, _mm256_add_ps(
+				_mm256_mul_ps(_mm256_loadu_ps(q1 + i), _mm256_loadu_ps(c1 + i)),
+				_mm256_mul_ps(x2, _mm256_loadu_ps(c2 + i))));
+		}
+		const __m128 v4 = _mm_add_ps(
+			_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		float sv[4];
+		_mm_storeu_ps(sv, v4);
+		s += (sv[0] + sv[1]) + (sv[2] + sv[3]);
+	}
+#endif
+#if defined(__SSE__)
+	if (i + 4 <= hl) {
+		__m128 v = _mm_setzero_ps();
+		for (; i + 4 <= hl; i += 4) {
+			__m128 x2 = _mm_loadu_ps(q2 - 4 - i);
+			x2 = _mm_shuffle_ps(x2, x2, 0x1b);
+			v = _mm_add_ps(v, _mm_add_ps(
+				_mm_mul_ps(_mm_loadu_ps(q1 + i), _mm_loadu_ps(c1 + i)),
+				_mm_mul_ps(x2, _mm_loadu_ps(c2 + i))));
+		}
+		float sv[4];
+		_mm_storeu_ps(sv, v);
+		s += (sv[0] + sv[1]) + (sv[2] + sv[3]);
+	}
+#endif
+	for (; i < hl; ++i)
+		s += q1[i] * c1[i] + q2[-1 - int(i)] * c2[i];
+
+	return s - 1e-20f;
+}
+
+
 static unsigned int gcd ( unsigned int a, unsigned int b )
 {
 	if (a == 0) return b;
@@ -336,6 +393,10 @@ bool samplv1_resampler::process (void)
 				if (nz < 2 * hl) {
 					float *c1 = m_table->ctab + hl * ph;
 					float *c2 = m_table->ctab + hl * (np - ph);
+					if (m_nchan == 1) {
+						*out_data++ = dot1(p1, p2, c1, c2, hl);
+					}
+					else
 					for (c = 0; c < m_nchan; ++c) {
 						float *q1 = p1 + c;
 						float *q2 = p2 + c;
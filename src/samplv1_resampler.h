@@ -1,7 +1,7 @@
 // samplv1_resampler.h
 //
 /****************************************************************************
-   Copyright (C) 2017-2019, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2017-2020, rncbc aka Rui Nuno Capela. All rights reserved.
    Copyright (C) 2006-2012 Fons Adriaensen <fons@linuxaudio.org>
 
    This program is free software; you can redistribute it and/or
@@ -78,7 +78,7 @@ public:
 
 		Table        *next;
 		unsigned int  refc;
-		float        *ctab;
+		float        *ctab;		// aligned (SIMD).
 		float         fr;
 		unsigned int  hl;
 		unsigned int  np;
@@ -88,6 +88,8 @@ public:
 
 	private:
 
+		float        *cbuf;
+
 		static Table *g_list;
 		static Mutex  g_mutex;
 	};
@@ -25,22 +25,281 @@
 
 #include <sndfile.h>
 
+#include <thread>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
 
 //-------------------------------------------------------------------------
 // samplv1_sample - sampler wave table.
 //
 
+// default interpolation mode.
+static samplv1_sample::Interp g_sample_interp = samplv1_sample::Cubic;
+
+void samplv1_sample::setDefaultInterp ( Interp interp )
+{
+	g_sample_interp = interp;
+}
+
+samplv1_sample::Interp samplv1_sample::defaultInterp (void)
+{
+	return g_sample_interp;
+}
+
+
+// default storage format.
+static samplv1_sample::Storage g_sample_storage = samplv1_sample::Float32;
+
+void samplv1_sample::setDefaultStorage ( Storage storage )
+{
+	g_sample_storage = storage;
+}
+
+samplv1_sample::Storage samplv1_sample::defaultStorage (void)
+{
+	return g_sample_storage;
+}
+
+
+// parallel task pool (process-wide, bounded; callers included).
+class samplv1_sample_pool
+{
+public:
+
+	// parallel job (tasks claimed by index).
+	struct Job
+	{
+		Job(uint32_t n, const std::function<void(uint32_t)>& f)
+			: ntasks(n), itask(0), nusers(0), func(f) {}
+
+		uint32_t ntasks;
+		std::atomic<uint32_t> itask;
+		uint32_t nusers;
+		const std::function<void(uint32_t)>& func;
+	};
+
+	// singleton instance (started on first use).
+	static samplv1_sample_pool& getInstance()
+	{
+		static samplv1_sample_pool s_pool;
+		return s_pool;
+	}
+
+	// run a job to completion (the caller works on it too).
+	void run(Job& job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back(&job);
+		}
+
+		m_cond.notify_all();
+
+		work(job);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobs.remove(&job);
+		m_done.wait(lock, [&job] { return job.nusers == 0; });
+	}
+
+protected:
+
+	// ctor.
+	samplv1_sample_pool() : m_running(true)
+	{
+		const uint32_t MAX_THREADS = 16;
+
+		uint32_t nthreads = std::thread::hardware_concurrency();
+		if (nthreads > MAX_THREADS)
+			nthreads = MAX_THREADS;
+
+		// the caller makes the first one...
+		for (uint32_t n = 1; n < nthreads; ++n)
+			m_threads.emplace_back(&samplv1_sample_pool::worker, this);
+	}
+
+	// dtor.
+	~samplv1_sample_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+		}
+
+		m_cond.notify_all();
+
+		for (std::thread& thread : m_threads)
+			thread.join();
+	}
+
+	// claim and run tasks, till none left.
+	static void work(Job& job)
+	{
+		uint32_t i;
+		while ((i = job.itask.fetch_add(1)) < job.ntasks)
+			job.func(i);
+	}
+
+	// worker thread procedure.
+	void worker()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_running) {
+			Job *job = nullptr;
+			std::list<Job *>::const_iterator iter = m_jobs.begin();
+			for ( ; iter != m_jobs.end(); ++iter) {
+				if ((*iter)->itask.load() < (*iter)->ntasks) {
+					job = *iter;
+					break;
+				}
+			}
+			if (job == nullptr) {
+				m_cond.wait(lock);
+				continue;
+			}
+			++job->nusers;
+			lock.unlock();
+			work(*job);
+			lock.lock();
+			--job->nusers;
+			m_done.notify_all();
+		}
+	}
+
+private:
+
+	// instance variables.
+	bool m_running;
+
+	std::list<Job *> m_jobs;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::condition_variable m_done;
+
+	std::vector<std::thread> m_threads;
+};
+
+
+// parallel task runner (on the shared pool; nested calls just join in).
+template <typename Func>
+static void samplv1_sample_parallel ( uint32_t ntasks, Func func )
+{
+	if (ntasks < 2) {
+		if (ntasks > 0)
+			func(0);
+		return;
+	}
+
+	const std::function<void(uint32_t)> f(func);
+	samplv1_sample_pool::Job job(ntasks, f);
+	samplv1_sample_pool::getInstance().run(job);
+}
+
+
+// sample file decoder (chunked, one file handle per extra task).
+static uint32_t samplv1_sample_decode ( const char *filename, SNDFILE *file,
+	bool seekable, float *buffer, uint16_t nchannels, uint32_t nframes )
+{
+	const uint32_t CHUNK_FRAMES = (1 << 18);
+
+	const uint32_t nchunks = (nframes / CHUNK_FRAMES);
+	if (nchunks < 2 || !seekable) {
+		const sf_count_t nread = ::sf_readf_float(file, buffer, nframes);
+		return (nread > 0 ? uint32_t(nread) : 0);
+	}
+
+	const uint32_t nsize = (nframes + nchunks - 1) / nchunks;
+	std::atomic<uint32_t> nread(nframes);
+	samplv1_sample_parallel(nchunks, [&] (uint32_t i) {
+		const uint32_t offset = i * nsize;
+		uint32_t ncount = nsize;
+		if (offset + ncount > nframes)
+			ncount = nframes - offset;
+		SNDFILE *file2 = file;
+		if (i > 0) {
+			SF_INFO info;
+			::memset(&info, 0, sizeof(info));
+			file2 = ::sf_open(filename, SFM_READ, &info);
+		}
+		sf_count_t nread2 = -1;
+		if (file2 && ::sf_seek(file2, offset, SEEK_SET) == sf_count_t(offset))
+			nread2 = ::sf_readf_float(file2, buffer + offset * nchannels, ncount);
+		if (nread2 < sf_count_t(ncount)) {
+			// short read: trim at this chunk...
+			const uint32_t nread1 = offset + (nread2 > 0 ? uint32_t(nread2) : 0);
+			uint32_t nread0 = nread.load();
+			while (nread1 < nread0
+				&& !nread.compare_exchange_weak(nread0, nread1))
+				;
+		}
+		if (file2 && file2 != file)
+			::sf_close(file2);
+	});
+
+	return nread.load();
+}
+
+
+// half-band decimator (zero-phase, windowed-sinc).
+static void samplv1_sample_decimate (
+	const float *src, uint32_t nsrc, float *dst, uint32_t ndst )
+{
+	const int NTAPS = 16; // odd taps, per side.
+
+	float coefs[NTAPS];
+	float csum = 0.0f;
+	for (int j = 0; j < NTAPS; ++j) {
+		const float m = float(2 * j + 1);
+		const float x = float(M_PI) * m / float(4 * NTAPS);
+		const float w = 0.384f + 0.5f * ::cosf(2.0f * x) + 0.116f * ::cosf(4.0f * x);
+		coefs[j] = ((j & 1) ? -1.0f : 1.0f) * w / (float(M_PI) * m);
+		csum += coefs[j];
+	}
+	// normalize for unity gain at DC...
+	for (int j = 0; j < NTAPS; ++j)
+		coefs[j] *= 0.25f / csum;
+
+	const int nsrc1 = int(nsrc);
+	for (uint32_t n = 0; n < ndst; ++n) {
+		const int i = int(n << 1);
+		float y = (i < nsrc1 ? 0.5f * src[i] : 0.0f);
+		for (int j = 0; j < NTAPS; ++j) {
+			const int m = 2 * j + 1;
+			const int i1 = i - m;
+			const int i2 = i + m;
+			if (i1 >= 0 && i1 < nsrc1)
+				y += coefs[j] * src[i1];
+			if (i2 < nsrc1)
+				y += coefs[j] * src[i2];
+		}
+		dst[n] = y;
+	}
+}
+
+
 // ctor.
-samplv1_sample::samplv1_sample ( float srate )
-	: m_srate(srate), m_ntabs(0), m_filename(nullptr),
+samplv1_sample::samplv1_sample ( float srate, const samplv1_epoch *epoch )
+	: m_srate(srate), m_interp(Cubic), m_otabs(0), m_ntabs(0), m_itab0(0),
+		m_npad(0), m_filename(nullptr),
 		m_nchannels(0), m_rate0(0.0f), m_freq0(1.0f), m_ratio(0.0f),
 		m_nframes(0), m_pframes(nullptr), m_reverse(false),
+		m_pframes16(nullptr), m_scale16(nullptr),
+		m_zcross(nullptr),
+		m_peaks(nullptr), m_npeaks(0),
 		m_offset(false), m_offset_start(0), m_offset_end(0),
 		m_offset_phase0(nullptr), m_offset_end2(0),
 		m_loop(false), m_loop_start(0), m_loop_end(0),
 		m_loop_phase1(nullptr), m_loop_phase2(nullptr),
-		m_loop_xfade(0), m_loop_xzero(true)
+		m_loop_xfade(0), m_loop_xzero(true),
+		m_loop_xfades(nullptr), m_epoch(epoch)
 {
+	for (int i = 0; i < SINC_TABS; ++i)
+		m_sinc[i] = nullptr;
 }
 
 
@@ -82,85 +341,174 @@ bool samplv1_sample::open ( const char *filename, float freq0, uint16_t otabs )
 	m_rate0     = float(info.samplerate);
 	m_nframes   = info.frames;
 
-	float *buffer = new float [m_nchannels * m_nframes];
+	const uint16_t nchannels = m_nchannels;
+
+	float *buffer = new float [nchannels * m_nframes];
+
+	// decode (chunked, each on its own file handle)...
+	const uint32_t nread = samplv1_sample_decode(
+		m_filename, file, info.seekable, buffer, nchannels, m_nframes);
+
+	::sf_close(file);
+
+	// deinterleave and resample (one channel per task)...
+	float **pchans = new float * [nchannels];
+	for (uint16_t k = 0; k < nchannels; ++k)
+		pchans[k] = nullptr;
 
-	const int nread = ::sf_readf_float(file, buffer, m_nframes);
 	if (nread > 0) {
-		// resample start...
-		const uint32_t ninp = uint32_t(nread);
+		const uint32_t ninp = nread;
 		const uint32_t rinp = uint32_t(m_rate0);
 		const uint32_t rout = uint32_t(m_srate);
-		if (rinp != rout) {
-			samplv1_resampler resampler;
-			const uint32_t nout = uint32_t(float(ninp) * m_srate / m_rate0);
-			const uint32_t FILTSIZE = 32; // resample medium quality
-			if (resampler.setup(rinp, rout, m_nchannels, FILTSIZE)) {
-				float *inpb = buffer;
-				float *outb = new float [m_nchannels * nout];
-				resampler.inp_count = ninp;
-				resampler.inp_data  = inpb;
-				resampler.out_count = nout;
-				resampler.out_data  = outb;
-				resampler.process();
-				buffer = outb;
-				delete [] inpb;
-				// identical rates now...
-				m_rate0 = float(rout);
-				m_nframes = (nout - resampler.out_count);
+		// same resampler setup for all channels (shared filter table);
+		// if it can't be done, keep the original sample rate...
+		const uint32_t FILTSIZE = 32; // resample medium quality
+		samplv1_resampler resampler0;
+		const bool resample = (rinp != rout
+			&& resampler0.setup(rinp, rout, 1, FILTSIZE));
+		const uint32_t nout = (resample
+			? uint32_t(float(ninp) * m_srate / m_rate0) : ninp);
+		std::atomic<uint32_t> nframes(nout);
+		samplv1_sample_parallel(nchannels, [&] (uint32_t k) {
+			float *inpb = new float [ninp];
+			for (uint32_t j = 0; j < ninp; ++j)
+				inpb[j] = buffer[j * nchannels + k];
+			if (resample) {
+				samplv1_resampler resampler;
+				if (resampler.setup(rinp, rout, 1, FILTSIZE)) {
+					float *outb = new float [nout];
+					resampler.inp_count = ninp;
+					resampler.inp_data  = inpb;
+					resampler.out_count = nout;
+					resampler.out_data  = outb;
+					resampler.process();
+					delete [] inpb;
+					inpb = outb;
+					const uint32_t nout2 = (nout - resampler.out_count);
+					uint32_t nout1 = nframes.load();
+					while (nout2 < nout1
+						&& !nframes.compare_exchange_weak(nout1, nout2))
+						;
+				} else {
+					// silent, but still the same length and rate...
+					float *outb = new float [nout];
+					::memset(outb, 0, nout * sizeof(float));
+					delete [] inpb;
+					inpb = outb;
+				}
 			}
-		}
-		else m_nframes = ninp;
-		// resample end.
+			pchans[k] = inpb;
+		});
+		// identical rates now (only if resampled)...
+		if (resample)
+			m_rate0 = float(rout);
+		m_nframes = nframes.load();
 	}
 
+	delete [] buffer;
+
 	m_freq0 = freq0;
 	m_ratio = m_rate0 / (m_freq0 * m_srate);
 
-	m_ntabs = (otabs << 1);
+	// sinc interpolation mode: single original table only...
+	m_interp = g_sample_interp;
+	m_otabs = otabs;
+	if (m_interp == Sinc) {
+		sinc_create();
+		m_ntabs = 0;
+		m_itab0 = 0;
+		m_npad = SINC_HMAX;
+	}
+	else
+	// mip-map mode: decimated octave levels, upward only...
+	if (m_interp == Mipmap) {
+		m_ntabs = otabs;
+		m_itab0 = 0;
+		m_npad = 0;
+	} else {
+		m_ntabs = (otabs << 1);
+		m_itab0 = otabs;
+		m_npad = 0;
+	}
 
 	const uint16_t ntabs = (m_ntabs + 1);
-	const uint32_t nsize = (m_nframes + 4);
-	m_pframes = new float ** [ntabs];
+	float ***ptabs = new float ** [ntabs];
 
 	m_offset_phase0 = new float [ntabs];
 	m_loop_phase1 = new float [ntabs];
 	m_loop_phase2 = new float [ntabs];
 
-	samplv1_pshifter *pshifter = nullptr;
-	if (m_ntabs > 0)
-		pshifter = samplv1_pshifter::create(m_nchannels, m_srate);
-
 	for (uint16_t itab = 0; itab < ntabs; ++itab) {
-		float **pframes = new float * [m_nchannels];
-		for (uint16_t k = 0; k < m_nchannels; ++k) {
+		const uint32_t nframes = length(itab);
+		const uint32_t nsize = (m_npad + nframes + m_npad + 4);
+		float **pframes = new float * [nchannels];
+		for (uint16_t k = 0; k < nchannels; ++k) {
 			pframes[k] = new float [nsize];
 			::memset(pframes[k], 0, nsize * sizeof(float));
+			pframes[k] += m_npad;
+			if ((m_interp != Mipmap || itab == 0) && pchans[k])
+				::memcpy(pframes[k], pchans[k], m_nframes * sizeof(float));
 		}
-		uint32_t i = 0;
-		for (uint32_t j = 0; j < m_nframes; ++j) {
-			for (uint16_t k = 0; k < m_nchannels; ++k)
-				pframes[k][j] = buffer[i++];
-		}
-		const uint16_t itab0 = (m_ntabs >> 1);
-		if (itab != itab0 && pshifter) {
-			const float pshift = 1.0f / ftab(itab);
-			pshifter->process(pframes, m_nframes, pshift);
-		}
-		m_pframes[itab] = pframes;
+		ptabs[itab] = pframes;
 		m_offset_phase0[itab] = 0.0f;
 		m_loop_phase1[itab] = 0.0f;
 		m_loop_phase2[itab] = 0.0f;
 	}
 
-	if (pshifter)
-		samplv1_pshifter::destroy(pshifter);
+	for (uint16_t k = 0; k < nchannels; ++k) {
+		if (pchans[k])
+			delete [] pchans[k];
+	}
+	delete [] pchans;
+
+	if (m_interp == Mipmap) {
+		// decimate each level from the previous one (one channel per task)...
+		for (uint16_t itab = 1; itab < ntabs; ++itab) {
+			float **pframes1 = ptabs[itab - 1];
+			float **pframes = ptabs[itab];
+			const uint32_t nframes1 = length(itab - 1);
+			const uint32_t nframes = length(itab);
+			samplv1_sample_parallel(nchannels, [&] (uint32_t k) {
+				samplv1_sample_decimate(
+					pframes1[k], nframes1, pframes[k], nframes);
+			});
+		}
+	}
+	else
+	if (m_ntabs > 0) {
+		// pitch-shift each table (and channel, unless coupled) per task...
+		const bool coupled
+			= (samplv1_pshifter::defaultType() == samplv1_pshifter::RubberBand);
+		const uint32_t nchans = (coupled ? 1 : nchannels);
+		const uint32_t ntasks = m_ntabs * nchans;
+		samplv1_sample_parallel(ntasks, [&] (uint32_t i) {
+			uint16_t itab = (i / nchans);
+			if (itab >= m_itab0)
+				++itab;
+			const uint16_t k = (i % nchans);
+			samplv1_pshifter *pshifter
+				= samplv1_pshifter::create(coupled ? nchannels : 1, m_srate);
+			if (pshifter) {
+				const float pshift = 1.0f / ftab(itab);
+				float **pframes = ptabs[itab];
+				pshifter->process(coupled ? pframes : pframes + k, m_nframes, pshift);
+				samplv1_pshifter::destroy(pshifter);
+			}
+		});
+	}
 
-	delete [] buffer;
-	::sf_close(file);
+	// publish when complete...
+	m_pframes = ptabs;
+
+	if (g_sample_storage == Int16)
+		pack16();
 
 	if (m_reverse)
 		reverse_sync();
 
+	zero_crossing_build();
+	peaks_build();
+
 	reset(freq0);
 
 	updateOffset();
@@ -171,6 +519,10 @@ bool samplv1_sample::open ( const char *filename, float freq0, uint16_t otabs )
 
 void samplv1_sample::close (void)
 {
+	loop_xfade_free();
+	peaks_free();
+	zero_crossing_free();
+
 	if (m_loop_phase2) {
 		delete [] m_loop_phase2;
 		m_loop_phase2 = nullptr;
@@ -191,19 +543,42 @@ void samplv1_sample::close (void)
 		for (uint16_t itab = 0; itab < ntabs; ++itab) {
 			float **pframes = m_pframes[itab];
 			for (uint16_t k = 0; k < m_nchannels; ++k)
-				delete [] pframes[k];
+				delete [] (pframes[k] - m_npad);
 			delete [] pframes;
 		}
 		delete [] m_pframes;
 		m_pframes = nullptr;
 	}
 
+	if (m_pframes16) {
+		const uint16_t ntabs = m_ntabs + 1;
+		for (uint16_t itab = 0; itab < ntabs; ++itab) {
+			int16_t **pframes16 = m_pframes16[itab];
+			for (uint16_t k = 0; k < m_nchannels; ++k)
+				delete [] (pframes16[k] - m_npad);
+			delete [] pframes16;
+		}
+		delete [] m_pframes16;
+		m_pframes16 = nullptr;
+	}
+
+	if (m_scale16) {
+		delete [] m_scale16;
+		m_scale16 = nullptr;
+	}
+
 	m_nframes   = 0;
 	m_ratio     = 0.0f;
 	m_freq0     = 1.0f;
 	m_rate0     = 0.0f;
 	m_nchannels = 0;
 	m_ntabs     = 0;
+	m_otabs     = 0;
+	m_itab0     = 0;
+	m_npad      = 0;
+	m_interp    = Cubic;
+
+	sinc_destroy();
 
 //	setOffsetRange(0, 0);
 //	setLoopRange(0, 0);
@@ -215,31 +590,220 @@ void samplv1_sample::close (void)
 }
 
 
+// copy (all tables and settings, as they are).
+void samplv1_sample::copy ( const samplv1_sample& sample )
+{
+	if (&sample == this)
+		return;
+
+	close();
+
+	if (sample.m_filename)
+		m_filename = ::strdup(sample.m_filename);
+
+	m_srate     = sample.m_srate;
+	m_interp    = sample.m_interp;
+	m_otabs     = sample.m_otabs;
+	m_ntabs     = sample.m_ntabs;
+	m_itab0     = sample.m_itab0;
+	m_npad      = sample.m_npad;
+	m_nchannels = sample.m_nchannels;
+	m_rate0     = sample.m_rate0;
+	m_freq0     = sample.m_freq0;
+	m_ratio     = sample.m_ratio;
+	m_nframes   = sample.m_nframes;
+	m_reverse   = sample.m_reverse;
+
+	m_offset       = sample.m_offset.load();
+	m_offset_start = sample.m_offset_start.load();
+	m_offset_end   = sample.m_offset_end.load();
+
+	m_loop       = sample.m_loop.load();
+	m_loop_start = sample.m_loop_start.load();
+	m_loop_end   = sample.m_loop_end.load();
+	m_loop_xfade = sample.m_loop_xfade.load();
+	m_loop_xzero = sample.m_loop_xzero.load();
+
+	if (!sample.isOpen())
+		return;
+
+	const uint16_t ntabs = (m_ntabs + 1);
+
+	if (sample.m_pframes) {
+		float ***ptabs = new float ** [ntabs];
+		for (uint16_t itab = 0; itab < ntabs; ++itab) {
+			const uint32_t nsize = (m_npad + length(itab) + m_npad + 4);
+			float **pframes = new float * [m_nchannels];
+			for (uint16_t k = 0; k < m_nchannels; ++k) {
+				float *frames = new float [nsize];
+				::memcpy(frames, sample.m_pframes[itab][k] - m_npad,
+					nsize * sizeof(float));
+				pframes[k] = frames + m_npad;
+			}
+			ptabs[itab] = pframes;
+		}
+		m_pframes = ptabs;
+	}
+
+	if (sample.m_pframes16) {
+		int16_t ***ptabs16 = new int16_t ** [ntabs];
+		m_scale16 = new float [ntabs];
+		for (uint16_t itab = 0; itab < ntabs; ++itab) {
+			const uint32_t nsize = (m_npad + length(itab) + m_npad + 4);
+			int16_t **pframes16 = new int16_t * [m_nchannels];
+			for (uint16_t k = 0; k < m_nchannels; ++k) {
+				int16_t *frames16 = new int16_t [nsize];
+				::memcpy(frames16, sample.m_pframes16[itab][k] - m_npad,
+					nsize * sizeof(int16_t));
+				pframes16[k] = frames16 + m_npad;
+			}
+			ptabs16[itab] = pframes16;
+			m_scale16[itab] = sample.m_scale16[itab];
+		}
+		m_pframes16 = ptabs16;
+	}
+
+	if (m_interp == Sinc)
+		sinc_create();
+
+	m_offset_phase0 = new float [ntabs];
+	m_loop_phase1 = new float [ntabs];
+	m_loop_phase2 = new float [ntabs];
+
+	for (uint16_t itab = 0; itab < ntabs; ++itab) {
+		m_offset_phase0[itab] = 0.0f;
+		m_loop_phase1[itab] = 0.0f;
+		m_loop_phase2[itab] = 0.0f;
+	}
+
+	zero_crossing_build();
+	peaks_build();
+
+	updateOffset();
+	updateLoop();
+}
+
+
 // reverse sample buffer.
+template <typename T>
+static void samplv1_sample_reverse ( T *frames, uint32_t nframes )
+{
+	const uint32_t nsize1 = (nframes - 1);
+	const uint32_t nsize2 = (nframes >> 1);
+	for (uint32_t i = 0; i < nsize2; ++i) {
+		const uint32_t j = nsize1 - i;
+		const T sample = frames[i];
+		frames[i] = frames[j];
+		frames[j] = sample;
+	}
+}
+
+
 void samplv1_sample::reverse_sync (void)
 {
-	if (m_nframes > 0 && m_pframes) {
+	if (m_nframes > 0 && isOpen()) {
 		const uint16_t ntabs  = (m_ntabs + 1);
-		const uint32_t nsize1 = (m_nframes - 1);
-		const uint32_t nsize2 = (m_nframes >> 1);
 		for (uint16_t itab = 0; itab < ntabs; ++itab) {
-			float **pframes = m_pframes[itab];
+			const uint32_t nframes = length(itab);
 			for (uint16_t k = 0; k < m_nchannels; ++k) {
-				float *frames = pframes[k];
-				for (uint32_t i = 0; i < nsize2; ++i) {
-					const uint32_t j = nsize1 - i;
-					const float sample = frames[i];
-					frames[i] = frames[j];
-					frames[j] = sample;
-				}
+				if (m_pframes16)
+					samplv1_sample_reverse(m_pframes16[itab][k], nframes);
+				else
+					samplv1_sample_reverse(m_pframes[itab][k], nframes);
+			}
+		}
+		// zero-crossings have moved...
+		if (m_zcross.load(std::memory_order_acquire))
+			zero_crossing_build();
+		// and so the peaks (in-place)...
+		if (m_peaks)
+			peaks_update();
+		// and the loop cross-fade seams...
+		loop_xfade_build(true);
+	}
+}
+
+
+// compact storage conversion (16bit integer, peak scaled per table).
+void samplv1_sample::pack16 (void)
+{
+	if (m_pframes == nullptr)
+		return;
+
+	const uint16_t ntabs = (m_ntabs + 1);
+	m_pframes16 = new int16_t ** [ntabs];
+	m_scale16 = new float [ntabs];
+
+	for (uint16_t itab = 0; itab < ntabs; ++itab) {
+		const uint32_t nframes = length(itab);
+		const uint32_t nsize = (m_npad + nframes + m_npad + 4);
+		float **pframes = m_pframes[itab];
+		float vmax = 0.0f;
+		for (uint16_t k = 0; k < m_nchannels; ++k) {
+			const float *frames = pframes[k];
+			for (uint32_t i = 0; i < nframes; ++i) {
+				const float v = ::fabsf(frames[i]);
+				if (vmax < v)
+					vmax = v;
 			}
 		}
+		const float scale = (vmax > 0.0f ? vmax / 32767.0f : 1.0f);
+		const float scale1 = 1.0f / scale;
+		int16_t **pframes16 = new int16_t * [m_nchannels];
+		for (uint16_t k = 0; k < m_nchannels; ++k) {
+			int16_t *frames16 = new int16_t [nsize];
+			::memset(frames16, 0, nsize * sizeof(int16_t));
+			frames16 += m_npad;
+			const float *frames = pframes[k];
+			for (uint32_t i = 0; i < nframes; ++i)
+				frames16[i] = int16_t(::lrintf(frames[i] * scale1));
+			pframes16[k] = frames16;
+			delete [] (pframes[k] - m_npad);
+		}
+		delete [] pframes;
+		m_pframes16[itab] = pframes16;
+		m_scale16[itab] = scale;
+	}
+
+	delete [] m_pframes;
+	m_pframes = nullptr;
+}
+
+
+// sinc interpolation kernels.
+void samplv1_sample::sinc_create (void)
+{
+	sinc_destroy();
+
+	// unity (and downward) ratio...
+	const float frel = 1.0f - 2.6f / float(SINC_HLEN);
+	m_sinc[0] = samplv1_resampler::Table::create(frel, SINC_HLEN, SINC_PHASES);
+
+	// upward ratios, on quarter-octave steps (mid-step cutoff)...
+	for (int i = 1; i < SINC_TABS; ++i) {
+		const float r = ::powf(2.0f, (float(i) - 0.5f) / 4.0f);
+		uint32_t hl = uint32_t(::ceilf(float(SINC_HLEN) * r));
+		if (hl > SINC_HMAX)
+			hl = SINC_HMAX;
+		m_sinc[i] = samplv1_resampler::Table::create(frel / r, hl, SINC_PHASES);
+	}
+}
+
+
+void samplv1_sample::sinc_destroy (void)
+{
+	for (int i = 0; i < SINC_TABS; ++i) {
+		if (m_sinc[i]) {
+			samplv1_resampler::Table::destroy(
+				const_cast<samplv1_resampler::Table *> (m_sinc[i]));
+			m_sinc[i] = nullptr;
+		}
 	}
 }
 
 
 // offset range.
-void samplv1_sample::setOffsetRange ( uint32_t start, uint32_t end )
+void samplv1_sample::setOffsetRange ( uint32_t start, uint32_t end, bool sync )
 {
 	if (start > m_nframes)
 		start = m_nframes;
@@ -255,19 +819,8 @@ void samplv1_sample::setOffsetRange ( uint32_t start, uint32_t end )
 		m_offset_end = m_nframes;
 	}
 
-	if (m_offset_phase0) {
-		const uint16_t ntabs = m_ntabs + 1;
-		if (m_offset && m_offset_start < m_offset_end) {
-			for (uint16_t itab = 0; itab < ntabs; ++itab)
-				m_offset_phase0[itab] = float(zero_crossing(itab, m_offset_start));
-			m_offset_end2 = zero_crossing((ntabs >> 1), m_offset_end);
-		} else {
-			for (uint16_t itab = 0; itab < ntabs; ++itab)
-				m_offset_phase0[itab] = 0.0f;
-			m_offset_end2 = m_nframes;
-		}
-	}
-	else m_offset_end2 = m_nframes;
+	if (sync)
+		updateOffsetPhases();
 
 	// offset/loop range stabilizer...
 	if (m_offset_start < m_offset_end) {
@@ -283,7 +836,7 @@ void samplv1_sample::setOffsetRange ( uint32_t start, uint32_t end )
 			++loop_update;
 		}
 		if (loop_update > 0 && loop_start < loop_end)
-			setLoopRange(loop_start, loop_end);
+			setLoopRange(loop_start, loop_end, sync);
 	}
 }
 
@@ -295,8 +848,29 @@ void samplv1_sample::updateOffset (void)
 }
 
 
+// offset phases updater (points as they are).
+void samplv1_sample::updateOffsetPhases (void)
+{
+	if (m_offset_phase0) {
+		const uint16_t ntabs = m_ntabs + 1;
+		if (m_offset && m_offset_start < m_offset_end) {
+			for (uint16_t itab = 0; itab < ntabs; ++itab) {
+				const uint32_t start = (m_offset_start >> tshift(itab));
+				m_offset_phase0[itab] = float(zero_crossing(itab, start));
+			}
+			m_offset_end2 = zero_crossing(m_itab0, m_offset_end);
+		} else {
+			for (uint16_t itab = 0; itab < ntabs; ++itab)
+				m_offset_phase0[itab] = 0.0f;
+			m_offset_end2 = m_nframes;
+		}
+	}
+	else m_offset_end2 = m_nframes;
+}
+
+
 // loop range.
-void samplv1_sample::setLoopRange ( uint32_t start, uint32_t end )
+void samplv1_sample::setLoopRange ( uint32_t start, uint32_t end, bool sync )
 {
 	if (m_offset_start < m_offset_end) {
 		if (start < m_offset_start)
@@ -322,23 +896,28 @@ void samplv1_sample::setLoopRange ( uint32_t start, uint32_t end )
 		m_loop_end = m_nframes;
 	}
 
+	if (sync)
+		updateLoopPhases();
+
+	loop_xfade_build();
+}
+
+
+// loop updater.
+void samplv1_sample::updateLoop (void)
+{
+	setLoopRange(m_loop_start, m_loop_end);
+}
+
+
+// loop phases updater (points as they are).
+void samplv1_sample::updateLoopPhases (void)
+{
 	if (m_loop_phase1 && m_loop_phase2) {
 		const uint16_t ntabs = m_ntabs + 1;
 		for (uint16_t itab = 0; itab < ntabs; ++itab) {
 			if (m_loop && m_loop_start < m_loop_end) {
-				uint32_t start = m_loop_start;
-				uint32_t end = m_loop_end;
-				if (m_loop_xzero) {
-					int slope = 0;
-					end = zero_crossing(itab, m_loop_end, &slope);
-					start = zero_crossing(itab, m_loop_start, &slope);
-					if (start >= end) {
-						start = m_loop_start;
-						end = m_loop_end;
-					}
-				}
-				m_loop_phase1[itab] = float(end - start);
-				m_loop_phase2[itab] = float(end);
+				loop_phases(itab, m_loop_phase1[itab], m_loop_phase2[itab]);
 			} else {
 				m_loop_phase1[itab] = 0.0f;
 				m_loop_phase2[itab] = 0.0f;
@@ -348,10 +927,157 @@ void samplv1_sample::setLoopRange ( uint32_t start, uint32_t end )
 }
 
 
-// loop updater.
-void samplv1_sample::updateLoop (void)
+// loop phases (per table, zero-crossing aliased).
+void samplv1_sample::loop_phases (
+	uint16_t itab, float& phase1, float& phase2 ) const
 {
-	setLoopRange(m_loop_start, m_loop_end);
+	const uint16_t shift = tshift(itab);
+	const uint32_t loop_start = (m_loop_start >> shift);
+	const uint32_t loop_end = (m_loop_end >> shift);
+	uint32_t start = loop_start;
+	uint32_t end = loop_end;
+	if (m_loop_xzero) {
+		int slope = 0;
+		end = zero_crossing(itab, loop_end, &slope);
+		start = zero_crossing(itab, loop_start, &slope);
+		if (start >= end) {
+			start = loop_start;
+			end = loop_end;
+		}
+	}
+	phase1 = float(end - start);
+	phase2 = float(end);
+}
+
+
+// baked loop cross-fade seams (not for the real-time thread).
+void samplv1_sample::loop_xfade_build ( bool force )
+{
+	// serialized; eg. UI edits vs. scheduled port automation...
+	std::lock_guard<std::mutex> lock(m_loop_xfades_mutex);
+
+	LoopXFades *xfades = m_loop_xfades.load(std::memory_order_acquire);
+
+	if (m_loop_xfade > 0 && m_loop_start < m_loop_end && isOpen()) {
+		// unchanged as baked?
+		if (xfades && !force
+			&& xfades->xfade == m_loop_xfade
+			&& xfades->loop_start == m_loop_start
+			&& xfades->loop_end == m_loop_end
+			&& xfades->loop_xzero == m_loop_xzero)
+			return;
+	}
+	else if (xfades == nullptr)
+		return;
+
+	// get rid of the previously retired ones, first...
+	loop_xfade_cleanup();
+
+	xfades = nullptr;
+
+	if (m_loop_xfade > 0 && m_loop_start < m_loop_end && isOpen()) {
+		const uint16_t ntabs = m_ntabs + 1;
+		xfades = new LoopXFades;
+		xfades->xfade = m_loop_xfade;
+		xfades->loop_start = m_loop_start;
+		xfades->loop_end = m_loop_end;
+		xfades->loop_xzero = m_loop_xzero;
+		xfades->ntabs = ntabs;
+		xfades->nchannels = m_nchannels;
+		xfades->tabs = new LoopXFade [ntabs];
+		for (uint16_t itab = 0; itab < ntabs; ++itab) {
+			LoopXFade& xfade = xfades->tabs[itab];
+			loop_phases(itab, xfade.phase1, xfade.phase2);
+			xfade.start  = 0;
+			xfade.frames = nullptr;
+			const uint32_t nloop = uint32_t(xfade.phase1);
+			const uint32_t nend = uint32_t(xfade.phase2);
+			uint32_t nfade = (m_loop_xfade >> tshift(itab));
+			if (nfade > nloop)
+				nfade = nloop;
+			if (nfade < 1)
+				continue;
+			xfade.start = nend - nfade;
+			const int32_t nframes = int32_t(length(itab));
+			const int32_t npad = LOOP_XFADE_PAD;
+			const int32_t nsize = npad + int32_t(nfade) + npad;
+			const int32_t i0 = int32_t(xfade.start) - npad;
+			const float gain1 = 1.0f / float(nfade);
+			xfade.frames = new float * [m_nchannels];
+			for (uint16_t k = 0; k < m_nchannels; ++k) {
+				float *frames = new float [nsize];
+				for (int32_t j = 0; j < nsize; ++j) {
+					const int32_t i = i0 + j;
+					const int32_t i1 = i - int32_t(nloop);
+					const float x0 = (i >= 0 && i < nframes
+						? frame(itab, k, i) : 0.0f);
+					const float x1 = (i1 >= 0 && i1 < nframes
+						? frame(itab, k, i1) : 0.0f);
+					if (i < int32_t(xfade.start))
+						frames[j] = x0; // before the seam.
+					else
+					if (i < int32_t(nend)) {
+						const float g = float(int32_t(nend) - i) * gain1;
+						frames[j] = g * x0 + (1.0f - g) * x1;
+					}
+					else frames[j] = x1; // past the loop end, wrapped.
+				}
+				xfade.frames[k] = frames + npad;
+			}
+		}
+	}
+
+	// publish it; the old one may still be playing (retire)...
+	xfades = m_loop_xfades.exchange(xfades, std::memory_order_acq_rel);
+	if (xfades)
+		m_loop_xfades_gc.push_back({xfades, m_epoch ? m_epoch->current() : 0});
+}
+
+
+// retired seams cleanup (the audio thread is done with them; locked).
+void samplv1_sample::loop_xfade_cleanup (void)
+{
+	std::vector<LoopXFadesGc>::iterator iter = m_loop_xfades_gc.begin();
+	while (iter != m_loop_xfades_gc.end()) {
+		// no epoch? no way to tell, keep it till closed...
+		if (m_epoch && m_epoch->elapsed(iter->epoch)) {
+			loop_xfade_delete(iter->xfades);
+			iter = m_loop_xfades_gc.erase(iter);
+		}
+		else ++iter;
+	}
+}
+
+
+void samplv1_sample::loop_xfade_delete ( LoopXFades *xfades )
+{
+	for (uint16_t itab = 0; itab < xfades->ntabs; ++itab) {
+		float **frames = xfades->tabs[itab].frames;
+		if (frames) {
+			for (uint16_t k = 0; k < xfades->nchannels; ++k)
+				delete [] (frames[k] - LOOP_XFADE_PAD);
+			delete [] frames;
+		}
+	}
+
+	delete [] xfades->tabs;
+	delete xfades;
+}
+
+
+void samplv1_sample::loop_xfade_free (void)
+{
+	std::lock_guard<std::mutex> lock(m_loop_xfades_mutex);
+
+	LoopXFades *xfades = m_loop_xfades.exchange(nullptr);
+	if (xfades)
+		loop_xfade_delete(xfades);
+
+	std::vector<LoopXFadesGc>::const_iterator iter = m_loop_xfades_gc.begin();
+	for ( ; iter != m_loop_xfades_gc.end(); ++iter)
+		loop_xfade_delete(iter->xfades);
+
+	m_loop_xfades_gc.clear();
 }
 
 
@@ -360,9 +1086,38 @@ uint32_t samplv1_sample::zero_crossing ( uint16_t itab, uint32_t i, int *slope )
 {
 	const int s0 = (slope ? *slope : 0);
 
+	const uint32_t nframes = length(itab);
+
+	// indexed look-up (binary search)...
+	const ZeroCrosses *zcrosses = m_zcross.load(std::memory_order_acquire);
+	if (zcrosses && itab < zcrosses->ntabs) {
+		const ZeroCross *zcross = zcrosses->runs[itab];
+		const uint32_t nzcross = zcrosses->nruns[itab];
+		const uint32_t i0 = (i > 0 ? i : 1);
+		uint32_t lo = 0;
+		uint32_t hi = nzcross;
+		while (lo < hi) {
+			const uint32_t mid = (lo + hi) >> 1;
+			if (zcross[mid].end <= i0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		for ( ; lo < nzcross; ++lo) {
+			const ZeroCross& zc = zcross[lo];
+			if ((0 >= s0 && (zc.flags & ZeroCross::Falling)) ||
+				(s0 >= 0 && (zc.flags & ZeroCross::Rising))) {
+				if (slope && s0 == 0)
+					*slope = (zc.flags & ZeroCross::Negative ? -1 : +1);
+				return (zc.start > i0 ? zc.start : i0);
+			}
+		}
+		return nframes;
+	}
+
 	if (i > 0) --i;
 	float v0 = zero_crossing_k(itab, i);
-	for (++i; i < m_nframes; ++i) {
+	for (++i; i < nframes; ++i) {
 		const float v1 = zero_crossing_k(itab, i);
 		if ((0 >= s0 && v0 >= 0.0f && 0.0f >= v1) ||
 			(s0 >= 0 && v1 >= 0.0f && 0.0f >= v0)) {
@@ -372,7 +1127,96 @@ uint32_t samplv1_sample::zero_crossing ( uint16_t itab, uint32_t i, int *slope )
 		v0 = v1;
 	}
 
-	return m_nframes;
+	return nframes;
+}
+
+
+// zero-crossing index (per table, run-length encoded).
+void samplv1_sample::zero_crossing_build (void)
+{
+	ZeroCrosses *zcrosses = nullptr;
+
+	// build it aside, the audio thread may be searching the current one...
+	if (isOpen() && m_nframes > 1) {
+		const uint16_t ntabs = (m_ntabs + 1);
+		zcrosses = new ZeroCrosses;
+		zcrosses->ntabs = ntabs;
+		zcrosses->runs  = new ZeroCross * [ntabs];
+		zcrosses->nruns = new uint32_t [ntabs];
+		samplv1_sample_parallel(ntabs, [&] (uint32_t itab) {
+			const uint32_t nframes = length(itab);
+			std::vector<ZeroCross> runs;
+			float v0 = zero_crossing_k(itab, 0);
+			for (uint32_t i = 1; i < nframes; ++i) {
+				const float v1 = zero_crossing_k(itab, i);
+				uint32_t flags = 0;
+				if (v0 >= 0.0f && 0.0f >= v1)
+					flags |= ZeroCross::Falling;
+				if (v1 >= 0.0f && 0.0f >= v0)
+					flags |= ZeroCross::Rising;
+				if (flags) {
+					if (v1 < v0)
+						flags |= ZeroCross::Negative;
+					if (!runs.empty()
+						&& runs.back().end == i && runs.back().flags == flags)
+						++runs.back().end;
+					else
+						runs.push_back({i, i + 1, flags});
+				}
+				v0 = v1;
+			}
+			const uint32_t nruns = runs.size();
+			zcrosses->runs[itab] = new ZeroCross [nruns > 0 ? nruns : 1];
+			for (uint32_t j = 0; j < nruns; ++j)
+				zcrosses->runs[itab][j] = runs[j];
+			zcrosses->nruns[itab] = nruns;
+		});
+	}
+
+	std::lock_guard<std::mutex> lock(m_zcross_mutex);
+
+	// get rid of the previously retired ones, first...
+	std::vector<ZeroCrossesGc>::iterator iter = m_zcross_gc.begin();
+	while (iter != m_zcross_gc.end()) {
+		// no epoch? no way to tell, keep it till closed...
+		if (m_epoch && m_epoch->elapsed(iter->epoch)) {
+			zero_crossing_delete(iter->zcross);
+			iter = m_zcross_gc.erase(iter);
+		}
+		else ++iter;
+	}
+
+	// publish it; the old one may still be searched (retire)...
+	zcrosses = m_zcross.exchange(zcrosses, std::memory_order_acq_rel);
+	if (zcrosses)
+		m_zcross_gc.push_back({zcrosses, m_epoch ? m_epoch->current() : 0});
+}
+
+
+void samplv1_sample::zero_crossing_free (void)
+{
+	std::lock_guard<std::mutex> lock(m_zcross_mutex);
+
+	ZeroCrosses *zcrosses = m_zcross.exchange(nullptr);
+	if (zcrosses)
+		zero_crossing_delete(zcrosses);
+
+	std::vector<ZeroCrossesGc>::const_iterator iter = m_zcross_gc.begin();
+	for ( ; iter != m_zcross_gc.end(); ++iter)
+		zero_crossing_delete(iter->zcross);
+
+	m_zcross_gc.clear();
+}
+
+
+void samplv1_sample::zero_crossing_delete ( ZeroCrosses *zcrosses )
+{
+	for (uint16_t itab = 0; itab < zcrosses->ntabs; ++itab)
+		delete [] zcrosses->runs[itab];
+
+	delete [] zcrosses->runs;
+	delete [] zcrosses->nruns;
+	delete zcrosses;
 }
 
 
@@ -380,14 +1224,152 @@ uint32_t samplv1_sample::zero_crossing ( uint16_t itab, uint32_t i, int *slope )
 float samplv1_sample::zero_crossing_k ( uint16_t itab, uint32_t i ) const
 {
 	float ret = 0.0f;
-	if (m_pframes && m_nchannels > 0) {
-		float **pframes = m_pframes[itab];
+	if (isOpen() && m_nchannels > 0) {
 		for (uint16_t k = 0; k < m_nchannels; ++k)
-			ret += pframes[k][i];
+			ret += frame(itab, k, i);
 		ret /= float(m_nchannels);
 	}
 	return ret;
 }
 
 
+// waveform peak pyramid (display).
+void samplv1_sample::peaks_build (void)
+{
+	peaks_free();
+
+	if (!isOpen() || m_nframes < 1 || m_nchannels < 1)
+		return;
+
+	uint16_t npeaks = 1;
+	while ((m_nframes - 1) >> (npeaks + PEAK_SHIFT))
+		++npeaks;
+
+	Peak ***peaks = new Peak ** [npeaks];
+	for (uint16_t level = 0; level < npeaks; ++level) {
+		const uint16_t shift = level + PEAK_SHIFT;
+		const uint32_t npeak = ((m_nframes - 1) >> shift) + 1;
+		peaks[level] = new Peak * [m_nchannels];
+		for (uint16_t k = 0; k < m_nchannels; ++k)
+			peaks[level][k] = new Peak [npeak];
+	}
+
+	m_npeaks = npeaks;
+	m_peaks = peaks;
+
+	peaks_update();
+}
+
+
+void samplv1_sample::peaks_update (void)
+{
+	if (m_peaks == nullptr)
+		return;
+
+	// one task per channel, each one building its own levels...
+	samplv1_sample_parallel(m_nchannels, [&] (uint32_t k) {
+		// level 0: straight from the (center) sample table...
+		Peak *peaks = m_peaks[0][k];
+		const uint32_t nframes = m_nframes;
+		const uint32_t nblock = (1 << PEAK_SHIFT);
+		for (uint32_t i = 0, j = 0; i < nframes; i += nblock, ++j) {
+			const uint32_t i2 = (i + nblock < nframes ? i + nblock : nframes);
+			float vmin = frame(k, i);
+			float vmax = vmin;
+			for (uint32_t i1 = i + 1; i1 < i2; ++i1) {
+				const float v = frame(k, i1);
+				if (vmin > v)
+					vmin = v;
+				if (vmax < v)
+					vmax = v;
+			}
+			peaks[j].vmin = vmin;
+			peaks[j].vmax = vmax;
+		}
+		// upper levels: pair-wise reduction of the one below...
+		for (uint16_t level = 1; level < m_npeaks; ++level) {
+			const Peak *peaks0 = m_peaks[level - 1][k];
+			const uint32_t npeak0 = ((nframes - 1) >> (level + PEAK_SHIFT - 1)) + 1;
+			peaks = m_peaks[level][k];
+			for (uint32_t j = 0; j < npeak0; j += 2) {
+				Peak& peak1 = peaks[j >> 1];
+				peak1 = peaks0[j];
+				if (j + 1 < npeak0) {
+					if (peak1.vmin > peaks0[j + 1].vmin)
+						peak1.vmin = peaks0[j + 1].vmin;
+					if (peak1.vmax < peaks0[j + 1].vmax)
+						peak1.vmax = peaks0[j + 1].vmax;
+				}
+			}
+		}
+	});
+}
+
+
+void samplv1_sample::peaks_free (void)
+{
+	if (m_peaks) {
+		for (uint16_t level = 0; level < m_npeaks; ++level) {
+			for (uint16_t k = 0; k < m_nchannels; ++k)
+				delete [] m_peaks[level][k];
+			delete [] m_peaks[level];
+		}
+		delete [] m_peaks;
+		m_peaks = nullptr;
+	}
+
+	m_npeaks = 0;
+}
+
+
+// waveform peak range (min/max over frames [start, end)).
+void samplv1_sample::peak ( uint16_t k, uint32_t start, uint32_t end,
+	float& vmin, float& vmax ) const
+{
+	vmin = vmax = 0.0f;
+
+	if (!isOpen() || k >= m_nchannels || start >= m_nframes)
+		return;
+
+	if (end > m_nframes)
+		end = m_nframes;
+	if (end <= start)
+		end = start + 1;
+
+	const uint32_t nspan = end - start;
+
+	// too narrow: scan the sample frames directly...
+	if (m_peaks == nullptr || (nspan >> PEAK_SHIFT) == 0) {
+		vmin = vmax = frame(k, start);
+		for (uint32_t i = start + 1; i < end; ++i) {
+			const float v = frame(k, i);
+			if (vmin > v)
+				vmin = v;
+			if (vmax < v)
+				vmax = v;
+		}
+		return;
+	}
+
+	// coarsest level whose blocks are not wider than the span,
+	// so that at most three blocks get visited...
+	uint16_t level = 0;
+	while (level + 1 < m_npeaks && (nspan >> (level + 1 + PEAK_SHIFT)) > 0)
+		++level;
+
+	const uint16_t shift = level + PEAK_SHIFT;
+	const Peak *peaks = m_peaks[level][k];
+	const uint32_t j2 = ((end - 1) >> shift);
+	uint32_t j = (start >> shift);
+	vmin = peaks[j].vmin;
+	vmax = peaks[j].vmax;
+	while (++j <= j2) {
+		if (vmin > peaks[j].vmin)
+			vmin = peaks[j].vmin;
+		if (vmax < peaks[j].vmax)
+			vmax = peaks[j].vmax;
+	}
+}
+
+
 // end of samplv1_sample.cpp
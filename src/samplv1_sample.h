@@ -29,6 +29,17 @@
 
 #include <math.h>
 
+#include <atomic>
+#include <vector>
+#include <mutex>
+
+#include "samplv1_resampler.h"
+#include "samplv1_epoch.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // forward decls.
 class samplv1;
 
@@ -41,8 +52,22 @@ class samplv1_sample
 {
 public:
 
-	// ctor.
-	samplv1_sample(float srate = 44100.0f);
+	// interpolation modes.
+	enum Interp { Cubic = 0, Sinc = 1, Mipmap = 2 };
+
+	// default interpolation mode (applies on next open).
+	static void setDefaultInterp(Interp interp);
+	static Interp defaultInterp();
+
+	// in-memory storage formats.
+	enum Storage { Float32 = 0, Int16 = 1 };
+
+	// default storage format (applies on next open).
+	static void setDefaultStorage(Storage storage);
+	static Storage defaultStorage();
+
+	// ctor (epoch: the audio cycle counter of the engine playing it).
+	samplv1_sample(float srate = 44100.0f, const samplv1_epoch *epoch = nullptr);
 
 	// dtor.
 	~samplv1_sample();
@@ -67,18 +92,18 @@ public:
 		{ return m_reverse; }
 
 	// offset mode.
-	void setOffset(bool offset)
+	void setOffset(bool offset, bool sync = true)
 	{
 		m_offset = offset;
 
-		updateOffset();
+		if (sync) updateOffset();
 	}
 
 	bool isOffset() const
 		{ return m_offset; }
 
-	// offset range.
-	void setOffsetRange(uint32_t start, uint32_t end);
+	// offset range (sync=false: just the points, phases deferred).
+	void setOffsetRange(uint32_t start, uint32_t end, bool sync = true);
 
 	uint32_t offsetStart() const
 		{ return m_offset_start; }
@@ -89,18 +114,18 @@ public:
 		{ return (m_offset && m_offset_phase0 ? m_offset_phase0[itab] : 0.0f); }
 
 	// loop mode.
-	void setLoop(bool loop)
+	void setLoop(bool loop, bool sync = true)
 	{
 		m_loop = loop;
 
-		updateLoop();
+		if (sync) updateLoop();
 	}
 
 	bool isLoop() const
 		{ return m_loop; }
 
-	// loop range.
-	void setLoopRange(uint32_t start, uint32_t end);
+	// loop range (sync=false: just the points, phases deferred).
+	void setLoopRange(uint32_t start, uint32_t end, bool sync = true);
 
 	uint32_t loopStart() const
 		{ return m_loop_start; }
@@ -114,20 +139,55 @@ public:
 
 	// loop cross-fade (in number of frames)
 	void setLoopCrossFade(uint32_t xfade)
-		{ m_loop_xfade = xfade; }
+	{
+		m_loop_xfade = xfade;
+
+		loop_xfade_build();
+	}
+
 	uint32_t loopCrossFade() const
 		{ return m_loop_xfade; }
 
 	// loop zero-crossing detection
 	void setLoopZeroCrossing(bool xzero)
-		{ m_loop_xzero = xzero; }
+	{
+		m_loop_xzero = xzero;
+
+		loop_xfade_build();
+	}
+
 	bool isLoopZeroCrossing() const
 		{ return m_loop_xzero; }
 
+	// baked loop cross-fade seam (per table): the last loop frames
+	// already blended with the ones before the loop start, padded
+	// on both sides for the interpolation taps.
+	struct LoopXFade
+	{
+		float    phase1;	// loop length (as baked).
+		float    phase2;	// loop end (as baked).
+		uint32_t start;		// first cross-faded frame index.
+		float  **frames;	// per channel, frames[k][0] is at start.
+	};
+
+	const LoopXFade *loopXFade(uint16_t itab) const
+	{
+		const LoopXFades *xfades
+			= m_loop_xfades.load(std::memory_order_acquire);
+		return (xfades && itab < xfades->ntabs ? &xfades->tabs[itab] : nullptr);
+	}
+
+	// offset/loop phases update (deferred sync; points as they are).
+	void updateOffsetPhases();
+	void updateLoopPhases();
+
 	// init.
 	bool open(const char *filename, float freq0 = 1.0f, uint16_t otabs = 0);
 	void close();
 
+	// copy (all tables and settings, as they are).
+	void copy(const samplv1_sample& sample);
+
 	// accessors.
 	const char *filename() const
 		{ return m_filename; }
@@ -140,6 +200,17 @@ public:
 	uint32_t length() const
 		{ return m_nframes; }
 
+	// sample table length (mip-map levels are decimated).
+	uint32_t length(uint16_t itab) const
+	{
+		const uint16_t shift = tshift(itab);
+		return (m_nframes + (1 << shift) - 1) >> shift;
+	}
+
+	// sample table decimation shift (mip-map level).
+	uint16_t tshift(uint16_t itab) const
+		{ return (m_interp == Mipmap ? itab : 0); }
+
 	// resampler ratio
 	float ratio() const
 		{ return m_ratio; }
@@ -154,7 +225,11 @@ public:
 	// sample table index.
 	uint16_t itab(float freq) const
 	{
-		int ret = int(m_ntabs >> 1) + fast_ilog2f(freq / m_freq0);
+		int ret = int(m_itab0);
+		if (m_interp == Mipmap)
+			ret += fast_ilog2f(float(M_SQRT2) * freq / m_freq0);
+		else
+			ret += fast_ilog2f(freq / m_freq0);
 
 		if (ret < 0)
 			ret = 0;
@@ -169,7 +244,9 @@ public:
 	float ftab(uint16_t itab) const
 	{
 		float ret = 1.0f;
-		const uint16_t itab0 = (m_ntabs >> 1);
+		if (m_interp == Mipmap)
+			return ret / float(1 << itab);
+		const uint16_t itab0 = m_itab0;
 		if (itab < itab0)
 			ret *= float((itab0 - itab) << 1);
 		else
@@ -178,29 +255,94 @@ public:
 		return ret;
 	}
 
-	// number of pitch-shifted octaves.
+	// number of pitch-shifted octaves (as requested).
 	uint16_t otabs() const
-		{ return m_ntabs >> 1; }
+		{ return m_otabs; }
+
+	// band-limited sinc interpolation kernel (by pitch ratio).
+	const samplv1_resampler::Table *sinc(float delta) const
+	{
+		if (m_sinc[0] == nullptr)
+			return nullptr;
+		if (delta <= 1.0f)
+			return m_sinc[0];
+
+		// quarter-octave steps above unity...
+		const float delta2 = delta * delta;
+		int ret = 1 + fast_ilog2f(delta2 * delta2);
+		if (ret > SINC_TABS - 1)
+			ret = SINC_TABS - 1;
+
+		return m_sinc[ret];
+	}
 
-	// frame value.
+	// frame buffers (nullptr if not stored in that format).
 	float *frames(uint16_t itab, uint16_t k) const
-		{ return m_pframes[itab][k]; }
+		{ return (m_pframes ? m_pframes[itab][k] : nullptr); }
 	float *frames(uint16_t k) const
-		{ return frames(m_ntabs >> 1, k); }
+		{ return frames(m_itab0, k); }
 
-	// predicate.
-	bool isOver(uint32_t index) const
-		{ return !m_pframes || (index >= m_offset_end2); }
+	int16_t *frames16(uint16_t itab, uint16_t k) const
+		{ return (m_pframes16 ? m_pframes16[itab][k] : nullptr); }
+	float scale16(uint16_t itab) const
+		{ return m_scale16[itab]; }
+
+	// frame value (any storage format).
+	float frame(uint16_t itab, uint16_t k, uint32_t i) const
+	{
+		if (m_pframes16)
+			return m_scale16[itab] * float(m_pframes16[itab][k][i]);
+		else
+			return m_pframes[itab][k][i];
+	}
+
+	float frame(uint16_t k, uint32_t i) const
+		{ return frame(m_itab0, k, i); }
+
+	// waveform peak range (min/max over frames [start, end)).
+	void peak(uint16_t k, uint32_t start, uint32_t end,
+		float& vmin, float& vmax) const;
+
+	// predicates.
+	bool isOpen() const
+		{ return (m_pframes || m_pframes16); }
+
+	bool isOver(uint16_t itab, uint32_t index) const
+		{ return !isOpen() || ((index << tshift(itab)) >= m_offset_end2); }
 
 protected:
 
 	// reverse sample buffer.
 	void reverse_sync();
 
+	// loop phases (per table, zero-crossing aliased).
+	void loop_phases(uint16_t itab, float& phase1, float& phase2) const;
+
+	// baked loop cross-fade seams.
+	void loop_xfade_build(bool force = false);
+	void loop_xfade_cleanup();
+	void loop_xfade_free();
+
+	// compact storage conversion.
+	void pack16();
+
+	// sinc interpolation kernels.
+	void sinc_create();
+	void sinc_destroy();
+
 	// zero-crossing aliasing .
 	uint32_t zero_crossing(uint16_t itab, uint32_t i, int *slope = nullptr) const;
 	float zero_crossing_k(uint16_t itab, uint32_t i) const;
 
+	// zero-crossing index (per table).
+	void zero_crossing_build();
+	void zero_crossing_free();
+
+	// waveform peak pyramid (display).
+	void peaks_build();
+	void peaks_update();
+	void peaks_free();
+
 	// offset/loop update.
 	void updateOffset();
 	void updateLoop();
@@ -215,9 +357,21 @@ protected:
 
 private:
 
+	// sinc interpolation kernels (unity + 4 octaves up).
+	enum { SINC_HLEN = 16, SINC_HMAX = 64, SINC_PHASES = 256, SINC_TABS = 17 };
+
+	// baked loop cross-fade seam padding (max. interpolation taps).
+	enum { LOOP_XFADE_PAD = SINC_HMAX + 4 };
+
 	// instance variables.
 	float    m_srate;
+	Interp   m_interp;
+	uint16_t m_otabs;
 	uint16_t m_ntabs;
+	uint16_t m_itab0;
+	uint32_t m_npad;
+
+	const samplv1_resampler::Table *m_sinc[SINC_TABS];
 
 	char    *m_filename;
 	uint16_t m_nchannels;
@@ -229,19 +383,100 @@ private:
 	float ***m_pframes;
 	bool     m_reverse;
 
-	bool     m_offset;
-	uint32_t m_offset_start;
-	uint32_t m_offset_end;
-	float   *m_offset_phase0;
-	uint32_t m_offset_end2;
+	int16_t ***m_pframes16;
+	float     *m_scale16;
 
-	bool     m_loop;
-	uint32_t m_loop_start;
-	uint32_t m_loop_end;
-	float   *m_loop_phase1;
-	float   *m_loop_phase2;
-	uint32_t m_loop_xfade;
-	bool     m_loop_xzero;
+	// zero-crossing index runs, sorted (per table).
+	struct ZeroCross
+	{
+		enum { Falling = 1, Rising = 2, Negative = 4 };
+
+		uint32_t start;
+		uint32_t end;
+		uint32_t flags;
+	};
+
+	// zero-crossing index (all tables), published as a whole.
+	struct ZeroCrosses
+	{
+		uint16_t    ntabs;
+		ZeroCross **runs;
+		uint32_t   *nruns;
+	};
+
+	std::atomic<ZeroCrosses *> m_zcross;
+
+	// retired indexes, freed after a grace period (epoch).
+	struct ZeroCrossesGc
+	{
+		ZeroCrosses *zcross;
+		uint32_t     epoch;
+	};
+
+	std::vector<ZeroCrossesGc> m_zcross_gc;
+	std::mutex m_zcross_mutex;
+
+	// waveform peak pyramid, min/max per power-of-two block
+	// of frames, level 0 being 1 << PEAK_SHIFT frames wide.
+	enum { PEAK_SHIFT = 4 };
+
+	struct Peak
+	{
+		float vmin;
+		float vmax;
+	};
+
+	Peak  ***m_peaks;
+	uint16_t m_npeaks;
+
+	// offset/loop points are set off the real-time thread, while
+	// the audio thread reads them on deferred phase updates...
+	std::atomic<bool>     m_offset;
+	std::atomic<uint32_t> m_offset_start;
+	std::atomic<uint32_t> m_offset_end;
+	float                *m_offset_phase0;
+	std::atomic<uint32_t> m_offset_end2;
+
+	std::atomic<bool>     m_loop;
+	std::atomic<uint32_t> m_loop_start;
+	std::atomic<uint32_t> m_loop_end;
+	float                *m_loop_phase1;
+	float                *m_loop_phase2;
+	std::atomic<uint32_t> m_loop_xfade;
+	std::atomic<bool>     m_loop_xzero;
+
+	// baked loop cross-fade seams (all tables).
+	struct LoopXFades
+	{
+		uint32_t xfade;
+		uint32_t loop_start;
+		uint32_t loop_end;
+		bool     loop_xzero;
+
+		uint16_t ntabs;
+		uint16_t nchannels;
+
+		LoopXFade *tabs;
+	};
+
+	std::atomic<LoopXFades *> m_loop_xfades;
+
+	// retired seams, freed after a grace period (epoch).
+	struct LoopXFadesGc
+	{
+		LoopXFades *xfades;
+		uint32_t    epoch;
+	};
+
+	std::vector<LoopXFadesGc> m_loop_xfades_gc;
+
+	// seam rebuilds and retirement, from any non real-time thread.
+	std::mutex m_loop_xfades_mutex;
+
+	const samplv1_epoch *m_epoch;
+
+	static void loop_xfade_delete(LoopXFades *xfades);
+	static void zero_crossing_delete(ZeroCrosses *zcrosses);
 };
 
 
@@ -267,6 +502,15 @@ public:
 		start(m_sample ? m_sample->freq() : 1.0f);
 	}
 
+	// rebind (very same tables, another owner; audio thread).
+	void rebind(samplv1_sample *sample)
+	{
+		m_sample = sample;
+
+		m_sinc  = nullptr;
+		m_xfade = nullptr;
+	}
+
 	// reset loop.
 	void setLoop(bool loop)
 	{
@@ -287,11 +531,16 @@ public:
 		m_itab   = (m_sample ? m_sample->itab(freq) : 0);
 		m_ftab   = (m_sample ? m_sample->ftab(m_itab) : 1.0f);
 
+		m_sinc   = (m_sample ? m_sample->sinc(1.0f) : nullptr);
+
 		m_phase0 = (m_sample ? m_sample->offsetPhase0(m_itab) : 0.0f);
 		m_phase  = m_phase0;
 		m_index  = 0;
 		m_alpha  = 0.0f;
 
+		m_xfade  = nullptr;
+		m_xindex = 0;
+
 		m_phase1 = 0.0f;
 		m_index1 = 0;
 		m_alpha1 = 0.0f;
@@ -306,49 +555,32 @@ public:
 		const float ratio = (m_sample ? m_sample->ratio() : 1.0f);
 		const float delta = freq * ratio * m_ftab;
 
+		m_sinc = (m_sample ? m_sample->sinc(delta) : nullptr);
+
 		m_index  = uint32_t(m_phase);
 		m_alpha  = m_phase - float(m_index);
 		m_phase += delta;
 
+		m_xfade = nullptr;
+
 		if (m_loop && m_sample) {
-			const uint32_t xfade = m_sample->loopCrossFade(); // nframes.
-			if (xfade > 0) {
-				const float xfade1 = float(xfade); // nframes.
-				if (m_phase >= m_loop_phase2 - xfade1) {
-					if (//m_sample->isOver(m_index) ||
-						m_phase >= m_loop_phase2) {
-						m_phase -= m_loop_phase1 * ::ceilf(delta / m_loop_phase1);
-						if (m_phase < m_phase0)
-							m_phase = m_phase0;
-					}
-					if (m_phase1 > 0.0f) {
-						m_index1 = int(m_phase1);
-						m_alpha1 = m_phase1 - float(m_index1);
-						m_phase1 += delta;
-						m_xgain1 -= delta / xfade1;
-						if (m_xgain1 < 0.0f)
-							m_xgain1 = 0.0f;
-					} else {
-						m_phase1 = m_phase - m_loop_phase1;
-						if (m_phase1 < m_phase0)
-							m_phase1 = m_phase0;
-						m_xgain1 = 1.0f;
-					}
+			// baked loop cross-fade seam (if it still applies)...
+			const samplv1_sample::LoopXFade *xfade
+				= m_sample->loopXFade(m_itab);
+			if (xfade && xfade->frames
+				&& xfade->phase1 == m_loop_phase1
+				&& xfade->phase2 == m_loop_phase2) {
+				if (m_phase >= m_loop_phase2)
+					loop_wrap(delta);
+				if (m_index >= xfade->start
+					&& float(m_index) < m_loop_phase2) {
+					m_xfade  = xfade;
+					m_xindex = m_index - xfade->start;
 				}
-				else
-				if (m_phase1 > 0.0f) {
-					m_phase1 = 0.0f;
-					m_index1 = 0;
-					m_alpha1 = 0.0f;
-					m_xgain1 = 1.0f;
-				}
-			}
-			else
-			if (m_phase >= m_loop_phase2) {
-				m_phase -= m_loop_phase1 * ::ceilf(delta / m_loop_phase1);
-				if (m_phase < m_phase0)
-					m_phase = m_phase0;
+				if (m_index1 > 0)
+					loop_xfade_reset();
 			}
+			else loop_xfade_next(delta);
 		}
 	}
 
@@ -358,29 +590,130 @@ public:
 		if (isOver())
 			return 0.0f;
 
-		float ret = m_xgain1 * interp(k, m_index, m_alpha);
-		if (m_index1 > 0)
-			ret += (1.0f - m_xgain1) * interp(k, m_index1, m_alpha1);
+		if (m_xfade)
+			return interp_xfade(m_xfade->frames[k] + m_xindex, m_alpha);
 
-		return ret;
+		// runtime loop cross-fade (no matching baked seam)...
+		if (m_index1 > 0) {
+			return m_xgain1 * interp(k, m_index, m_alpha)
+				+ (1.0f - m_xgain1) * interp(k, m_index1, m_alpha1);
+		}
+
+		return interp(k, m_index, m_alpha);
 	}
 
 	// predicate.
 	bool isOver() const
-		{ return !m_loop && (m_sample ? m_sample->isOver(m_index) : true); }
+		{ return !m_loop && (m_sample ? m_sample->isOver(m_itab, m_index) : true); }
 
 protected:
 
+	// loop wrap-around.
+	void loop_wrap(float delta)
+	{
+		m_phase -= m_loop_phase1 * ::ceilf(delta / m_loop_phase1);
+		if (m_phase < m_phase0)
+			m_phase = m_phase0;
+	}
+
+	// runtime loop cross-fade (two-phase, gain blended).
+	void loop_xfade_next(float delta)
+	{
+		float xfade1 = float(m_sample->loopCrossFade()
+			>> m_sample->tshift(m_itab)); // nframes.
+		if (xfade1 > m_loop_phase1)
+			xfade1 = m_loop_phase1;
+		if (xfade1 < 1.0f) {
+			if (m_phase >= m_loop_phase2)
+				loop_wrap(delta);
+			if (m_index1 > 0)
+				loop_xfade_reset();
+			return;
+		}
+		if (m_phase >= m_loop_phase2 - xfade1) {
+			if (m_phase >= m_loop_phase2)
+				loop_wrap(delta);
+			if (m_phase1 > 0.0f) {
+				m_index1 = uint32_t(m_phase1);
+				m_alpha1 = m_phase1 - float(m_index1);
+				m_phase1 += delta;
+				m_xgain1 -= delta / xfade1;
+				if (m_xgain1 < 0.0f)
+					m_xgain1 = 0.0f;
+			} else {
+				m_phase1 = m_phase - m_loop_phase1;
+				if (m_phase1 < m_phase0)
+					m_phase1 = m_phase0;
+				m_xgain1 = 1.0f;
+			}
+		}
+		else
+		if (m_phase1 > 0.0f)
+			loop_xfade_reset();
+	}
+
+	void loop_xfade_reset()
+	{
+		m_phase1 = 0.0f;
+		m_index1 = 0;
+		m_alpha1 = 0.0f;
+		m_xgain1 = 1.0f;
+	}
+
 	// sample (cubic interpolate).
 	float interp(uint16_t k, uint32_t index, float alpha) const
 	{
-		const float *frames = m_sample->frames(m_itab, k);
+		const int16_t *frames16 = m_sample->frames16(m_itab, k);
 
-		const float x0 = frames[index];
-		const float x1 = frames[index + 1];
-		const float x2 = frames[index + 2];
-		const float x3 = frames[index + 3];
+		if (m_sinc) {
+			if (frames16) {
+				return m_sample->scale16(m_itab)
+					* interp_sinc(frames16 + index, alpha);
+			}
+			return interp_sinc(m_sample->frames(m_itab, k) + index, alpha);
+		}
+
+		float x0, x1, x2, x3;
+
+		if (frames16) {
+			const float scale = m_sample->scale16(m_itab);
+		#if defined(__SSE2__)
+			// widen the 4 taps at once...
+			__m128i vi = _mm_loadl_epi64((const __m128i *) (frames16 + index));
+			vi = _mm_srai_epi32(_mm_unpacklo_epi16(vi, vi), 16);
+			float xs[4];
+			_mm_storeu_ps(xs, _mm_mul_ps(_mm_cvtepi32_ps(vi), _mm_set1_ps(scale)));
+			x0 = xs[0]; x1 = xs[1]; x2 = xs[2]; x3 = xs[3];
+		#else
+			x0 = scale * float(frames16[index]);
+			x1 = scale * float(frames16[index + 1]);
+			x2 = scale * float(frames16[index + 2]);
+			x3 = scale * float(frames16[index + 3]);
+		#endif
+		} else {
+			const float *frames = m_sample->frames(m_itab, k);
+			x0 = frames[index];
+			x1 = frames[index + 1];
+			x2 = frames[index + 2];
+			x3 = frames[index + 3];
+		}
+
+		return interp_cubic(x0, x1, x2, x3, alpha);
+	}
 
+	// sample (baked loop cross-fade seam).
+	float interp_xfade(const float *frames, float alpha) const
+	{
+		if (m_sinc)
+			return interp_sinc(frames, alpha);
+
+		return interp_cubic(frames[0], frames[1], frames[2], frames[3], alpha);
+	}
+
+	// cubic interpolation kernel.
+	static float interp_cubic(
+		float x0, float x1, float x2, float x3, float alpha)
+	{
 		const float c1 = (x2 - x0) * 0.5f;
 		const float b1 = (x1 - x2);
 		const float b2 = (c1 + b1);
@@ -390,6 +723,30 @@ protected:
 		return (((c3 * alpha) - c2) * alpha + c1) * alpha + x1;
 	}
 
+	// sample (band-limited sinc interpolate).
+	template <typename T>
+	float interp_sinc(const T *frames, float alpha) const
+	{
+		const uint32_t hl = m_sinc->hl;
+		const uint32_t np = m_sinc->np;
+		const uint32_t ph = uint32_t(alpha * float(np) + 0.5f);
+
+		const float *c1 = m_sinc->ctab + hl * ph;
+		const float *c2 = m_sinc->ctab + hl * (np - ph);
+
+		// centered on x1 (index + 1), as the cubic above...
+		const T *p1 = frames + 1 - (hl - 1);
+		const T *p2 = frames + 1 + hl + 1;
+
+		float ret = 0.0f;
+		for (uint32_t i = 0; i < hl; ++i) {
+			--p2;
+			ret += float(p1[i]) * c1[i] + float(p2[0]) * c2[i];
+		}
+
+		return ret;
+	}
+
 private:
 
 	// iterator variables.
@@ -398,6 +755,8 @@ private:
 	uint16_t m_itab;
 	float    m_ftab;
 
+	const samplv1_resampler::Table *m_sinc;
+
 	float    m_phase0;
 	float    m_phase;
 	uint32_t m_index;
@@ -407,6 +766,9 @@ private:
 	float    m_loop_phase1;
 	float    m_loop_phase2;
 
+	const samplv1_sample::LoopXFade *m_xfade;
+	uint32_t m_xindex;
+
 	float    m_phase1;
 	uint32_t m_index1;
 	float    m_alpha1;
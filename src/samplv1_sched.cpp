@@ -1,7 +1,7 @@
 // samplv1_sched.cpp
 //
 /****************************************************************************
-   Copyright (C) 2012-2019, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
 
    This program is free software; you can redistribute it and/or
    modify it under the terms of the GNU General Public License
@@ -21,59 +21,127 @@
 
 #include "samplv1_sched.h"
 
-#include <QThread>
-#include <QMutex>
-#include <QWaitCondition>
+#include <map>
+#include <list>
 
-#include <QHash>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <sys/resource.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+
+//-------------------------------------------------------------------------
+// samplv1_sched_sem - real-time safe wake-up (counting semaphore).
+//
+
+class samplv1_sched_sem
+{
+public:
+
+	samplv1_sched_sem() { ::sem_init(&m_sem, 0, 0); }
+	~samplv1_sched_sem() { ::sem_destroy(&m_sem); }
+
+	// signal (async-signal and RT safe).
+	void post() { ::sem_post(&m_sem); }
+
+	// wait until signaled.
+	void wait() { while (::sem_wait(&m_sem) != 0) {} }
+
+private:
+
+	sem_t m_sem;
+};
 
 
 //-------------------------------------------------------------------------
 // samplv1_sched_thread - worker/schedule thread decl.
 //
 
-class samplv1_sched_thread : public QThread
+class samplv1_sched_thread
 {
 public:
 
 	// ctor.
-	samplv1_sched_thread(uint32_t nsize = 32);
+	samplv1_sched_thread(uint32_t nsize = 1024);
 
 	// dtor.
 	~samplv1_sched_thread();
 
+	// start thread (relative priority: -1=low, 0=normal, +1=high).
+	bool start(int prio = 0);
+
 	// schedule processing and wake from wait condition.
-	void schedule(samplv1_sched *sched);
+	bool schedule(samplv1_sched *sched);
+
+	// overflow counter.
+	uint32_t overflows() const
+		{ return m_overflows.load(std::memory_order_relaxed); }
 
 protected:
 
 	// main thread executive.
 	void run();
 
-private:
+	// apply relative nice value (non real-time policies).
+	void renice();
 
-	// sync queue instance reference.
-	uint32_t m_nsize;
-	uint32_t m_nmask;
+	// thread entry point.
+	static void *run_thread(void *arg);
+
+private:
 
-	samplv1_sched **m_items;
+	// thread handle.
+	pthread_t m_thread;
 
-	volatile uint32_t m_iread;
-	volatile uint32_t m_iwrite;
+	// sync queue instance reference.
+	samplv1_sched_queue<samplv1_sched *> m_items;
 
 	// whether the thread is logically running.
-	volatile bool m_running;
+	std::atomic<bool> m_running;
+
+	// relative nice value, if any.
+	int m_nice;
 
 	// thread synchronization objects.
-	QMutex m_mutex;
-	QWaitCondition m_cond;
+	samplv1_sched_sem m_sem;
+
+	// overflow counter.
+	std::atomic<uint32_t> m_overflows;
 };
 
 
-static samplv1_sched_thread *g_sched_thread = nullptr;
+// worker/schedule thread pool classes.
+enum samplv1_sched_class { Heavy = 0, Light = 1, NumClasses = 2 };
+
+// maximum number of heavy-duty worker threads.
+const uint32_t MAX_SCHED_THREADS = 4;
+
+static samplv1_sched_thread *g_sched_threads[NumClasses][MAX_SCHED_THREADS];
+static uint32_t g_sched_nthreads[NumClasses] = { 0, 0 };
 static uint32_t g_sched_refcount = 0;
 
-static QHash<samplv1 *, QList<samplv1_sched::Notifier *> > g_sched_notifiers;
+// pending heavy-duty jobs, per instance (hashed; collisions just
+// make dependent light jobs go the ordered way, conservatively).
+const uint32_t MAX_SCHED_PENDING = 64;
+
+static std::atomic<uint32_t> g_sched_pending[MAX_SCHED_PENDING];
+
+// notifiers registry (copy-on-write, read from any worker thread).
+typedef std::map<samplv1 *, std::list<samplv1_sched::Notifier *> > samplv1_sched_notifiers;
+
+static std::atomic<samplv1_sched_notifiers *> g_sched_notifiers(nullptr);
+static std::atomic<uint32_t> g_sched_notifiers_readers(0);
+static pthread_mutex_t g_sched_notifiers_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// nice value step for each relative priority unit (non real-time).
+const int SCHED_NICE_STEP = 4;
 
 
 //-------------------------------------------------------------------------
@@ -81,20 +149,9 @@ static QHash<samplv1 *, QList<samplv1_sched::Notifier *> > g_sched_notifiers;
 //
 
 // ctor.
-samplv1_sched_thread::samplv1_sched_thread ( uint32_t nsize ) : QThread()
+samplv1_sched_thread::samplv1_sched_thread ( uint32_t nsize )
+	: m_items(nsize), m_running(false), m_nice(0), m_overflows(0)
 {
-	m_nsize = (4 << 1);
-	while (m_nsize < nsize)
-		m_nsize <<= 1;
-	m_nmask = (m_nsize - 1);
-	m_items = new samplv1_sched * [m_nsize];
-
-	m_iread  = 0;
-	m_iwrite = 0;
-
-	::memset(m_items, 0, m_nsize * sizeof(samplv1_sched *));
-
-	m_running = false;
 }
 
 
@@ -102,60 +159,208 @@ samplv1_sched_thread::samplv1_sched_thread ( uint32_t nsize ) : QThread()
 samplv1_sched_thread::~samplv1_sched_thread (void)
 {
 	// fake sync and wait
-	if (m_running && isRunning()) do {
-		if (m_mutex.tryLock()) {
-			m_running = false;
-			m_cond.wakeAll();
-			m_mutex.unlock();
-		}
-	} while (!wait(100));
-
-	delete [] m_items;
+	if (m_running) {
+		m_running = false;
+		m_sem.post();
+		::pthread_join(m_thread, nullptr);
+	}
 }
 
 
-// schedule processing and wake from wait condition.
-void samplv1_sched_thread::schedule ( samplv1_sched *sched )
+// start thread (relative priority: -1=low, 0=normal, +1=high).
+bool samplv1_sched_thread::start ( int prio )
 {
-	if (!sched->sync_wait()) {
-		const uint32_t w = (m_iwrite + 1) & m_nmask;
-		if (w != m_iread) {
-			m_items[m_iwrite] = sched;
-			m_iwrite = w;
+	pthread_attr_t attr;
+	::pthread_attr_init(&attr);
+
+	// try a relative priority within the inherited policy range,
+	// otherwise (SCHED_OTHER) a relative nice value will do...
+	struct sched_param param;
+	int policy = SCHED_OTHER;
+	m_nice = 0;
+	if (prio && ::pthread_getschedparam(::pthread_self(), &policy, &param) == 0) {
+		if (policy == SCHED_FIFO || policy == SCHED_RR) {
+			const int pmin = ::sched_get_priority_min(policy);
+			const int pmax = ::sched_get_priority_max(policy);
+			param.sched_priority += prio;
+			if (param.sched_priority >= pmin
+				&& param.sched_priority <= pmax) {
+				::pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+				::pthread_attr_setschedpolicy(&attr, policy);
+				::pthread_attr_setschedparam(&attr, &param);
+			}
 		}
+		else m_nice = -prio * SCHED_NICE_STEP;
 	}
 
-	if (m_mutex.tryLock()) {
-		m_cond.wakeAll();
-		m_mutex.unlock();
+	m_running = true;
+
+	int ret = ::pthread_create(&m_thread, &attr, run_thread, this);
+	if (ret != 0) {
+		// fallback to plain default attributes...
+		ret = ::pthread_create(&m_thread, nullptr, run_thread, this);
+		if (ret != 0)
+			m_running = false;
 	}
+
+	::pthread_attr_destroy(&attr);
+
+	return (ret == 0);
 }
 
 
-// main thread executive.
-void samplv1_sched_thread::run (void)
+// thread entry point.
+void *samplv1_sched_thread::run_thread ( void *arg )
 {
-	m_mutex.lock();
+	samplv1_sched_thread *sched_thread
+		= static_cast<samplv1_sched_thread *> (arg);
+	sched_thread->renice();
+	sched_thread->run();
+	return nullptr;
+}
 
-	m_running = true;
 
+// apply relative nice value (non real-time policies).
+void samplv1_sched_thread::renice (void)
+{
+#if defined(__linux__)
+	// linux: the nice value is a per-thread attribute;
+	// raising priority may fail when not privileged.
+	if (m_nice == 0)
+		return;
+	const id_t tid = id_t(::syscall(SYS_gettid));
+	errno = 0;
+	const int nice0 = ::getpriority(PRIO_PROCESS, tid);
+	if (errno == 0)
+		::setpriority(PRIO_PROCESS, tid, nice0 + m_nice);
+#endif
+}
+
+
+// schedule processing and wake from wait condition.
+bool samplv1_sched_thread::schedule ( samplv1_sched *sched )
+{
+	const bool ret = m_items.push(sched);
+	if (ret)
+		m_sem.post();
+	else
+		m_overflows.fetch_add(1, std::memory_order_relaxed);
+
+	return ret;
+}
+
+
+// main thread executive.
+void samplv1_sched_thread::run (void)
+{
 	while (m_running) {
 		// do whatever we must...
-		uint32_t r = m_iread;
-		while (r != m_iwrite) {
-			samplv1_sched *sched = m_items[r];
-			if (sched) {
+		samplv1_sched *sched = nullptr;
+		while (m_items.pop(sched)) {
+			if (sched)
 				sched->sync_process();
-				m_items[r] = nullptr;
-			}
-			++r &= m_nmask;
 		}
-		m_iread = r;
 		// wait for sync...
-		m_cond.wait(&m_mutex);
+		m_sem.wait();
+	}
+}
+
+
+//-------------------------------------------------------------------------
+// samplv1_sched_thread - worker/schedule thread pool.
+//
+
+// sched type priority class mapper.
+static samplv1_sched_class samplv1_sched_class_type ( samplv1_sched::Type stype )
+{
+	switch (stype) {
+	case samplv1_sched::Sample:
+	case samplv1_sched::Programs:
+		// slow I/O and/or DSP jobs...
+		return Heavy;
+	case samplv1_sched::Controls:
+	case samplv1_sched::Controller:
+	case samplv1_sched::MidiIn:
+	default:
+		// latency sensitive jobs...
+		return Light;
 	}
+}
+
 
-	m_mutex.unlock();
+// whether a light job must keep order after any pending heavy ones
+// of the same instance (eg. controllers after a program change).
+static bool samplv1_sched_ordered_type ( samplv1_sched::Type stype )
+{
+	return (stype == samplv1_sched::Controls
+		|| stype == samplv1_sched::Controller);
+}
+
+
+// start all worker threads.
+static void samplv1_sched_threads_start (void)
+{
+	const long ncpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+	uint32_t nheavy = (ncpus > 0 ? uint32_t(ncpus) >> 1 : 0);
+	if (nheavy < 1)
+		nheavy = 1;
+	else
+	if (nheavy > MAX_SCHED_THREADS)
+		nheavy = MAX_SCHED_THREADS;
+
+	g_sched_nthreads[Heavy] = nheavy;
+	g_sched_nthreads[Light] = 1;
+
+	for (uint32_t i = 0; i < MAX_SCHED_PENDING; ++i)
+		g_sched_pending[i].store(0);
+
+	for (uint32_t i = 0; i < g_sched_nthreads[Heavy]; ++i) {
+		samplv1_sched_thread *sched_thread = new samplv1_sched_thread();
+		sched_thread->start(-1);
+		g_sched_threads[Heavy][i] = sched_thread;
+	}
+
+	for (uint32_t i = 0; i < g_sched_nthreads[Light]; ++i) {
+		samplv1_sched_thread *sched_thread = new samplv1_sched_thread();
+		sched_thread->start(+1);
+		g_sched_threads[Light][i] = sched_thread;
+	}
+}
+
+
+// stop all worker threads.
+static void samplv1_sched_threads_stop (void)
+{
+	for (int c = 0; c < NumClasses; ++c) {
+		for (uint32_t i = 0; i < g_sched_nthreads[c]; ++i) {
+			delete g_sched_threads[c][i];
+			g_sched_threads[c][i] = nullptr;
+		}
+		g_sched_nthreads[c] = 0;
+	}
+}
+
+
+// worker thread for a given instance and priority class:
+// same instance always maps to the same thread, preserving order.
+static samplv1_sched_thread *samplv1_sched_thread_find (
+	samplv1 *pSampl, samplv1_sched::Type stype )
+{
+	const samplv1_sched_class sclass = samplv1_sched_class_type(stype);
+	const uint32_t nthreads = g_sched_nthreads[sclass];
+	if (nthreads < 1)
+		return nullptr;
+
+	const uintptr_t h = (uintptr_t(pSampl) >> 4);
+	return g_sched_threads[sclass][h % nthreads];
+}
+
+
+// pending heavy-duty jobs counter for a given instance.
+static std::atomic<uint32_t> *samplv1_sched_pending_find ( samplv1 *pSampl )
+{
+	const uintptr_t h = (uintptr_t(pSampl) >> 4);
+	return &g_sched_pending[h % MAX_SCHED_PENDING];
 }
 
 
@@ -165,37 +370,28 @@ void samplv1_sched_thread::run (void)
 
 // ctor.
 samplv1_sched::samplv1_sched ( samplv1 *pSampl, Type stype, uint32_t nsize )
-	: m_pSampl(pSampl), m_stype(stype), m_sync_wait(false)
+	: m_pSampl(pSampl), m_stype(stype), m_items(nsize),
+		m_sync_wait(false), m_overflows(0)
 {
-	m_nsize = (4 << 1);
-	while (m_nsize < nsize)
-		m_nsize <<= 1;
-	m_nmask = (m_nsize - 1);
-	m_items = new int [m_nsize];
-
-	m_iread  = 0;
-	m_iwrite = 0;
+	if (++g_sched_refcount == 1)
+		samplv1_sched_threads_start();
 
-	::memset(m_items, 0, m_nsize * sizeof(int));
+	m_sched_thread = samplv1_sched_thread_find(m_pSampl, m_stype);
+	m_sched_pending = samplv1_sched_pending_find(m_pSampl);
 
-	if (++g_sched_refcount == 1 && g_sched_thread == nullptr) {
-		g_sched_thread = new samplv1_sched_thread();
-		g_sched_thread->start();
-	}
+	// heavy-duty thread to keep order after, if any...
+	m_sched_after = nullptr;
+	if (samplv1_sched_ordered_type(m_stype))
+		m_sched_after = samplv1_sched_thread_find(m_pSampl, Programs);
+	m_sched_heavy = (samplv1_sched_class_type(m_stype) == Heavy);
 }
 
 
 // dtor (virtual).
 samplv1_sched::~samplv1_sched (void)
 {
-	delete [] m_items;
-
-	if (--g_sched_refcount == 0) {
-		if (g_sched_thread) {
-			delete g_sched_thread;
-			g_sched_thread = nullptr;
-		}
-	}
+	if (--g_sched_refcount == 0)
+		samplv1_sched_threads_stop();
 }
 
 
@@ -209,57 +405,128 @@ samplv1 *samplv1_sched::instance (void) const
 // schedule process.
 void samplv1_sched::schedule ( int sid )
 {
-	const uint32_t w = (m_iwrite + 1) & m_nmask;
-	if (w != m_iread) {
-		m_items[m_iwrite] = sid;
-		m_iwrite = w;
+	if (!m_items.push(sid))
+		m_overflows.fetch_add(1, std::memory_order_relaxed);
+
+	if (m_sched_thread && !sync_wait()) {
+		samplv1_sched_thread *sched_thread = m_sched_thread;
+		// heavy-duty jobs still pending for this instance?
+		// go right after those then, on the very same thread...
+		if (m_sched_after && m_sched_pending->load() > 0)
+			sched_thread = m_sched_after;
+		if (m_sched_heavy)
+			m_sched_pending->fetch_add(1);
+		// not queued? retry on next schedule...
+		if (!sched_thread->schedule(this)) {
+			if (m_sched_heavy)
+				m_sched_pending->fetch_sub(1);
+			m_sync_wait = false;
+		}
 	}
-
-	if (g_sched_thread)
-		g_sched_thread->schedule(this);
 }
 
 
 // test-and-set.
 bool samplv1_sched::sync_wait (void)
 {
-	const bool sync_wait = m_sync_wait;
-
-	if (!sync_wait)
-		m_sync_wait = true;
-
-	return sync_wait;
+	return m_sync_wait.exchange(true);
 }
 
 
 // scheduled processor.
 void samplv1_sched::sync_process (void)
 {
+	// clear pending flag first, so that
+	// any later schedule gets re-queued...
+	m_sync_wait = false;
+
 	// do whatever we must...
-	uint32_t r = m_iread;
-	while (r != m_iwrite) {
-		const int sid = m_items[r];
+	int sid = 0;
+	while (m_items.pop(sid)) {
 		process(sid);
 		sync_notify(m_pSampl, m_stype, sid);
-		m_items[r] = 0;
-		++r &= m_nmask;
 	}
-	m_iread = r;
 
-	m_sync_wait = false;
+	// done with this heavy-duty job...
+	if (m_sched_heavy)
+		m_sched_pending->fetch_sub(1);
+}
+
+
+// overflow counter (dropped schedule items).
+uint32_t samplv1_sched::overflows (void) const
+{
+	return m_overflows.load(std::memory_order_relaxed);
+}
+
+
+// overall overflow counter (static).
+uint32_t samplv1_sched::sync_overflows (void)
+{
+	uint32_t ret = 0;
+
+	for (int c = 0; c < NumClasses; ++c) {
+		for (uint32_t i = 0; i < g_sched_nthreads[c]; ++i)
+			ret += g_sched_threads[c][i]->overflows();
+	}
+
+	return ret;
 }
 
 
 // signal broadcast (static).
 void samplv1_sched::sync_notify ( samplv1 *pSampl, Type stype, int sid )
 {
-	if (g_sched_notifiers.contains(pSampl)) {
-		const QList<Notifier *>& list
-			= g_sched_notifiers.value(pSampl);
-		QListIterator<Notifier *> iter(list);
-		while (iter.hasNext())
-			iter.next()->notify(stype, sid);
+	++g_sched_notifiers_readers;
+
+	const samplv1_sched_notifiers *notifiers = g_sched_notifiers.load();
+	if (notifiers) {
+		samplv1_sched_notifiers::const_iterator iter
+			= notifiers->find(pSampl);
+		if (iter != notifiers->end()) {
+			const std::list<Notifier *>& list = iter->second;
+			std::list<Notifier *>::const_iterator list_iter = list.begin();
+			for ( ; list_iter != list.end(); ++list_iter)
+				(*list_iter)->notify(stype, sid);
+		}
+	}
+
+	--g_sched_notifiers_readers;
+}
+
+
+// notifiers registry update (copy-on-write; non real-time).
+static void samplv1_sched_notifiers_update (
+	samplv1 *pSampl, samplv1_sched::Notifier *pNotifier, bool bAdd )
+{
+	::pthread_mutex_lock(&g_sched_notifiers_mutex);
+
+	const samplv1_sched_notifiers *old_notifiers = g_sched_notifiers.load();
+	samplv1_sched_notifiers *notifiers = (old_notifiers
+		? new samplv1_sched_notifiers(*old_notifiers)
+		: new samplv1_sched_notifiers());
+
+	if (bAdd) {
+		(*notifiers)[pSampl].push_back(pNotifier);
+	} else {
+		samplv1_sched_notifiers::iterator iter = notifiers->find(pSampl);
+		if (iter != notifiers->end()) {
+			std::list<samplv1_sched::Notifier *>& list = iter->second;
+			list.remove(pNotifier);
+			if (list.empty())
+				notifiers->erase(iter);
+		}
 	}
+
+	g_sched_notifiers.store(notifiers);
+
+	// wait for any readers still on the old one...
+	while (g_sched_notifiers_readers.load() > 0)
+		::sched_yield();
+
+	delete old_notifiers;
+
+	::pthread_mutex_unlock(&g_sched_notifiers_mutex);
 }
 
 
@@ -271,19 +538,14 @@ void samplv1_sched::sync_notify ( samplv1 *pSampl, Type stype, int sid )
 samplv1_sched::Notifier::Notifier ( samplv1 *pSampl )
 	: m_pSampl(pSampl)
 {
-	g_sched_notifiers[pSampl].append(this);
+	samplv1_sched_notifiers_update(m_pSampl, this, true);
 }
 
 
 // dtor.
 samplv1_sched::Notifier::~Notifier (void)
 {
-	if (g_sched_notifiers.contains(m_pSampl)) {
-		QList<Notifier *>& list = g_sched_notifiers[m_pSampl];
-		list.removeAll(this);
-		if (list.isEmpty())
-			g_sched_notifiers.remove(m_pSampl);
-	}
+	samplv1_sched_notifiers_update(m_pSampl, this, false);
 }
 
 
@@ -1,7 +1,7 @@
 // samplv1_sched.h
 //
 /****************************************************************************
-   Copyright (C) 2012-2019, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
 
    This program is free software; you can redistribute it and/or
    modify it under the terms of the GNU General Public License
@@ -24,8 +24,98 @@
 
 #include <stdint.h>
 
+#include <atomic>
+
 // forward decls.
 class samplv1;
+class samplv1_sched_thread;
+
+
+//-------------------------------------------------------------------------
+// samplv1_sched_queue - bounded lock-free MPSC queue (wait-free consumer).
+//
+
+template<typename T>
+class samplv1_sched_queue
+{
+public:
+
+	// ctor.
+	samplv1_sched_queue(uint32_t nsize = 8)
+	{
+		m_nsize = (4 << 1);
+		while (m_nsize < nsize)
+			m_nsize <<= 1;
+		m_nmask = (m_nsize - 1);
+		m_items = new Item [m_nsize];
+
+		for (uint32_t i = 0; i < m_nsize; ++i)
+			m_items[i].seq.store(i, std::memory_order_relaxed);
+
+		m_iread = 0;
+		m_iwrite.store(0, std::memory_order_relaxed);
+	}
+
+	// dtor.
+	~samplv1_sched_queue()
+		{ delete [] m_items; }
+
+	// multiple producers (audio, worker and UI threads).
+	bool push(const T& data)
+	{
+		uint32_t w = m_iwrite.load(std::memory_order_relaxed);
+		for (;;) {
+			Item& item = m_items[w & m_nmask];
+			const uint32_t seq = item.seq.load(std::memory_order_acquire);
+			const int32_t diff = int32_t(seq - w);
+			if (diff == 0) {
+				if (m_iwrite.compare_exchange_weak(w, w + 1,
+						std::memory_order_relaxed)) {
+					item.data = data;
+					item.seq.store(w + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else
+			if (diff < 0)
+				return false; // full!
+			else
+				w = m_iwrite.load(std::memory_order_relaxed);
+		}
+	}
+
+	// single consumer (schedule thread).
+	bool pop(T& data)
+	{
+		const uint32_t r = m_iread;
+		Item& item = m_items[r & m_nmask];
+		const uint32_t seq = item.seq.load(std::memory_order_acquire);
+		if (int32_t(seq - (r + 1)) < 0)
+			return false; // empty.
+		data = item.data;
+		item.seq.store(r + m_nsize, std::memory_order_release);
+		m_iread = r + 1;
+		return true;
+	}
+
+private:
+
+	// queue slot.
+	struct Item
+	{
+		std::atomic<uint32_t> seq;
+		T data;
+	};
+
+	// instance variables.
+	uint32_t m_nsize;
+	uint32_t m_nmask;
+
+	Item *m_items;
+
+	uint32_t m_iread;
+	std::atomic<uint32_t> m_iwrite;
+};
 
 
 //-------------------------------------------------------------------------
@@ -57,6 +147,12 @@ public:
 	// scheduled processor.
 	void sync_process();
 
+	// overflow counter (dropped schedule items).
+	uint32_t overflows() const;
+
+	// overall overflow counter (static).
+	static uint32_t sync_overflows();
+
 	// (pure) virtual processor.
 	virtual void process(int sid) = 0;
 
@@ -91,16 +187,23 @@ private:
 
 	Type m_stype;
 
-	// sched queue instance reference.
-	uint32_t m_nsize;
-	uint32_t m_nmask;
+	// worker/schedule thread (by priority class).
+	samplv1_sched_thread *m_sched_thread;
 
-	int *m_items;
+	// heavy-duty thread to keep order after (if any).
+	samplv1_sched_thread *m_sched_after;
+
+	// pending heavy-duty jobs counter (per instance).
+	std::atomic<uint32_t> *m_sched_pending;
+
+	bool m_sched_heavy;
+
+	// sched queue instance reference.
+	samplv1_sched_queue<int> m_items;
 
-	volatile uint32_t m_iread;
-	volatile uint32_t m_iwrite;
+	std::atomic<bool> m_sync_wait;
 
-	volatile bool m_sync_wait;
+	std::atomic<uint32_t> m_overflows;
 };
 
 
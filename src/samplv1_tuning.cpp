@@ -1,7 +1,7 @@
 // samplv1_tuning.cpp
 //
 /****************************************************************************
-   Copyright (C) 2012-2018, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
 
    This program is free software; you can redistribute it and/or
    modify it under the terms of the GNU General Public License
@@ -45,12 +45,73 @@
 
 #include "samplv1_tuning.h"
 
-#include <QTextStream>
-#include <QFile>
+#include <fstream>
+#include <sstream>
+#include <locale>
 
+#include <stdlib.h>
+#include <ctype.h>
 #include <math.h>
 
 
+// Trim and collapse all inner whitespace into a single space.
+static std::string samplv1_tuning_simplified ( const std::string& line )
+{
+	std::string ret;
+
+	const size_t len = line.length();
+	for (size_t i = 0; i < len; ++i) {
+		if (::isspace((unsigned char) line[i])) {
+			if (!ret.empty() && ret[ret.length() - 1] != ' ')
+				ret += ' ';
+		}
+		else ret += line[i];
+	}
+
+	if (!ret.empty() && ret[ret.length() - 1] == ' ')
+		ret.erase(ret.length() - 1);
+
+	return ret;
+}
+
+
+// Extract the n-th field, given a separator character.
+static std::string samplv1_tuning_section (
+	const std::string& line, char sep, int n )
+{
+	size_t i = 0;
+	for ( ; n > 0; --n) {
+		i = line.find(sep, i);
+		if (i == std::string::npos)
+			return std::string();
+		++i;
+	}
+
+	const size_t j = line.find(sep, i);
+	return line.substr(i, j == std::string::npos ? j : j - i);
+}
+
+
+// Strict numeric conversions (whole field, C locale).
+static long samplv1_tuning_toLong ( const std::string& val, bool *ok )
+{
+	char *end = nullptr;
+	const long ret = ::strtol(val.c_str(), &end, 10);
+	*ok = (!val.empty() && end && *end == '\0');
+	return (*ok ? ret : 0);
+}
+
+static float samplv1_tuning_toFloat ( const std::string& val, bool *ok )
+{
+	std::istringstream ss(val);
+	ss.imbue(std::locale::classic());
+	float ret = 0.0f;
+	ss >> ret;
+	*ok = (!val.empty() && !ss.fail() && ss.eof());
+	return (*ok ? ret : 0.0f);
+}
+
+
 // Default ctor.
 samplv1_tuning::samplv1_tuning ( float refPitch, int refNote )
 {
@@ -88,13 +149,13 @@ void samplv1_tuning::updateBasePitch	(void)
 
 
 // Load custom Scala key-map file (.kbm)
-bool samplv1_tuning::loadKeyMapFile ( const QString& keyMapFile )
+bool samplv1_tuning::loadKeyMapFile ( const std::string& keyMapFile )
 {
-	QFile file(keyMapFile);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	std::ifstream fs(keyMapFile.c_str());
+	if (!fs.is_open())
 		return false;
 
-	QTextStream fs(&file);
+	std::string text;
 	int   mapSize      = -1;
 	int   firstNote    = -1;
 	int   lastNote     = -1;
@@ -102,80 +163,82 @@ bool samplv1_tuning::loadKeyMapFile ( const QString& keyMapFile )
 	int   refNote      = -1;
 	float refPitch     = 0.0f;
 	int   mapRepeatInc = -1;
-	QVector<int> mapping;
+	std::vector<int> mapping;
 
-	while (!fs.atEnd()) {
-		const QString& line
-			= fs.readLine().simplified();
+	while (std::getline(fs, text)) {
+		const std::string& line
+			= samplv1_tuning_simplified(text);
 		// Skip all-whitespace lines...
-		if (line.isEmpty())
+		if (line.empty())
 			continue;
 		// Skip comment lines...
 		if (line.at(0) == '!')
 			continue;
 		bool ok = false;
-		const QString& val
-			= line.section(' ', 0, 0);
+		const std::string& val
+			= samplv1_tuning_section(line, ' ', 0);
 		// An active range should be defined on this line...
 		if (line.at(0) == '<') {
 			// No overlap is checked for;
 			// it wouldn't hurt anything if ranges overlapped.
-			const int min = line.section(' ', 1, 1).toInt(&ok);
+			const int min = samplv1_tuning_toLong(
+				samplv1_tuning_section(line, ' ', 1), &ok);
 			if (!ok || min < 0)
 				return false;
 			ok = false;
-			const int max = line.section(' ', 2, 2).toInt(&ok);
+			const int max = samplv1_tuning_toLong(
+				samplv1_tuning_section(line, ' ', 2), &ok);
 			if (!ok || max < min || max > 127)
 				return false;
 		}
 		else
 		if (mapSize < 0) {
-			mapSize = val.toInt(&ok);
+			mapSize = samplv1_tuning_toLong(val, &ok);
 			if (!ok || mapSize < 0)
 				return false;
 		}
 		else
 		if (firstNote < 0) {
-			firstNote = val.toInt(&ok);
+			firstNote = samplv1_tuning_toLong(val, &ok);
 			if (!ok || firstNote < 0 || firstNote > 127)
 				return false;
 		}
 		else
 		if (lastNote < 0) {
-			lastNote = val.toInt(&ok);
+			lastNote = samplv1_tuning_toLong(val, &ok);
 			if (!ok || lastNote < 0 || lastNote > 127)
 				return false;
 		}
 		else
 		if (zeroNote < 0) {
-			zeroNote = val.toInt(&ok);
+			zeroNote = samplv1_tuning_toLong(val, &ok);
 			if (!ok || zeroNote < 0 || zeroNote > 127)
 				return false;
 		}
 		else
 		if (refNote < 0) {
-			refNote = val.toInt(&ok);
+			refNote = samplv1_tuning_toLong(val, &ok);
 			if (!ok || refNote < 0 || refNote > 127)
 				return false;
 		}
 		else
 		if (refPitch <= 0.0f) {
-			refPitch = val.toFloat(&ok);
+			refPitch = samplv1_tuning_toFloat(val, &ok);
 			if (!ok || refPitch < 0.001f)
 				return false;
 		}
 		else
 		if (mapRepeatInc < 0) {
-			mapRepeatInc = val.toInt(&ok);
+			mapRepeatInc = samplv1_tuning_toLong(val, &ok);
 			if (!ok || mapRepeatInc < 0)
 				return false;
 		}
 		else
-		if (line.at(0).toLower() == 'x') {
+		if (::tolower((unsigned char) line.at(0)) == 'x') {
 			mapping.push_back(-1); // unmapped key
 		}
 		else {
-			const int mapEntry = val.toInt(&ok);
+			const int mapEntry = samplv1_tuning_toLong(val, &ok);
 			if (!ok || mapEntry < 0)
 				return false;
 			mapping.push_back(mapEntry);
@@ -206,7 +269,7 @@ bool samplv1_tuning::loadKeyMapFile ( const QString& keyMapFile )
 	//if (mapping.size() > mapSize)
 	//	return false;
 
-	mapping.resize(mapSize);
+	mapping.resize(mapSize, 0);
 
 	// Check to make sure reference pitch is actually mapped
 	int refIndex = (refNote - zeroNote) % mapSize;
@@ -233,39 +296,40 @@ bool samplv1_tuning::loadKeyMapFile ( const QString& keyMapFile )
 
 
 // Load custom Scala scale file (.scl)
-bool samplv1_tuning::loadScaleFile ( const QString& scaleFile )
+bool samplv1_tuning::loadScaleFile ( const std::string& scaleFile )
 {
-	QFile file(scaleFile);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	std::ifstream fs(scaleFile.c_str());
+	if (!fs.is_open())
 		return false;
 
-	QTextStream fs(&file);
-	QString scaleDesc;
+	std::string text;
+	std::string scaleDesc;
 	int scaleSize = -1;
-	QVector<float> scale;
+	std::vector<float> scale;
 
-	while (!fs.atEnd()) {
-		const QString& line
-			= fs.readLine().simplified();
+	while (std::getline(fs, text)) {
+		const std::string& line
+			= samplv1_tuning_simplified(text);
 		// Skip all-whitespace lines after description...
-		if (line.isEmpty() && !scaleDesc.isEmpty())
+		if (line.empty() && !scaleDesc.empty())
 			continue;
 		// Skip comment lines
-		if (line.at(0) == '!')
+		if (!line.empty() && line.at(0) == '!')
 			continue;
-		if (scaleDesc.isEmpty())
+		if (scaleDesc.empty())
 			scaleDesc = line;
 		else
 		if (scaleSize < 0) {
 			bool ok = false;
-			scaleSize = line.section(' ', 0, 0).toInt(&ok);
+			scaleSize = samplv1_tuning_toLong(
+				samplv1_tuning_section(line, ' ', 0), &ok);
 			if (!ok || scaleSize < 0)
 				return false;
 		}
 		else scale.push_back(parseScaleLine(line));
 	}
 
-	if (scaleDesc.isEmpty() || scale.size() != scaleSize)
+	if (scaleDesc.empty() || int(scale.size()) != scaleSize)
 		return false;
 
 	m_scaleFile = scaleFile;
@@ -279,24 +343,27 @@ bool samplv1_tuning::loadScaleFile ( const QString& scaleFile )
 
 
 // Convert a single line of a Scala scale file to a frequency relative to 1/1.
-float samplv1_tuning::parseScaleLine ( const QString& line ) const
+float samplv1_tuning::parseScaleLine ( const std::string& line ) const
 {
 	bool ok = false;
 
-	if (line.contains('.')) {
+	if (line.find('.') != std::string::npos) {
 		// Treat as cents...
-		const float cents = line.section(' ', 0, 0).toFloat(&ok);
+		const float cents = samplv1_tuning_toFloat(
+			samplv1_tuning_section(line, ' ', 0), &ok);
 		if (!ok || cents < 0.001f)
 			return 0.0f;
 		else
 			return ::powf(2.0f, cents / 1200.0f);
 	} else {
 		// Treat as ratio...
-		const long n = line.section('/', 0, 0).toLong(&ok);
+		const long n = samplv1_tuning_toLong(
+			samplv1_tuning_section(line, '/', 0), &ok);
 		if (!ok || n < 0)
 			return 0.0f;
 		ok = false;
-		const long d = line.section('/', 1, 1).toLong(&ok);
+		const long d = samplv1_tuning_toLong(
+			samplv1_tuning_section(line, '/', 1), &ok);
 		if (!ok || d < 0)
 			return 0.0f;
 		else
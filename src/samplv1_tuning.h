@@ -1,7 +1,7 @@
 // samplv1_tuning.h
 //
 /****************************************************************************
-   Copyright (C) 2012-2018, rncbc aka Rui Nuno Capela. All rights reserved.
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
 
    This program is free software; you can redistribute it and/or
    modify it under the terms of the GNU General Public License
@@ -22,8 +22,9 @@
 #ifndef __samplv1_tuning_h
 #define __samplv1_tuning_h
 
-#include <QString>
-#include <QVector>
+#include <string>
+#include <vector>
+
 
 //-------------------------------------------------------------------------
 // TuningMap
@@ -64,34 +65,34 @@ public:
 	int   refNote()  const { return m_refNote;  }
 
 	// Load custom Scala key map file (.kbm)
-	bool loadKeyMapFile (const QString& filename);
+	bool loadKeyMapFile (const std::string& filename);
 
 	// Load custom Scala scale file (.scl)
-	bool loadScaleFile (const QString& filename);
+	bool loadScaleFile (const std::string& filename);
 
-	const QString& keyMapFile() const { return m_keyMapFile; }
+	const std::string& keyMapFile() const { return m_keyMapFile; }
 
-	const QString& scaleFile() const { return m_scaleFile;  }
-	const QString& scaleDesc() const { return m_scaleDesc;  }
+	const std::string& scaleFile() const { return m_scaleFile;  }
+	const std::string& scaleDesc() const { return m_scaleDesc;  }
 
 	// The main pitch/frequency (Hz) getter
 	float noteToPitch(int note) const;
 
 protected:
 
-	float parseScaleLine(const QString& line) const;
+	float parseScaleLine(const std::string& line) const;
 
 	void updateBasePitch();
 
 private:
 
 	// Instance member variables.
-	QString m_keyMapFile;
+	std::string m_keyMapFile;
 
-	QString m_scaleFile;
-	QString m_scaleDesc;
+	std::string m_scaleFile;
+	std::string m_scaleDesc;
 
-	QVector<float> m_scale;
+	std::vector<float> m_scale;
 
 	float m_refPitch;
 	int   m_refNote;
@@ -99,7 +100,7 @@ private:
 	int   m_mapRepeatInc;
 	float m_basePitch;
 
-	QVector<int> m_mapping;
+	std::vector<int> m_mapping;
 };
 
 
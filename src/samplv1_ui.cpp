@@ -156,12 +156,12 @@ bool samplv1_ui::isLoopZero (void) const
 
 bool samplv1_ui::loadPreset ( const QString& sFilename )
 {
-	return samplv1_param::loadPreset(m_pSampl, sFilename);
+	return samplv1_param::loadPreset(m_pSampl, sFilename.toUtf8().constData());
 }
 
 bool samplv1_ui::savePreset ( const QString& sFilename )
 {
-	return samplv1_param::savePreset(m_pSampl, sFilename);
+	return samplv1_param::savePreset(m_pSampl, sFilename.toUtf8().constData());
 }
 
 
@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include <mutex>
+
 
 //-------------------------------------------------------------------------
 // samplv1_wave - smoothed (integrating oversampled) wave table.
@@ -255,4 +257,134 @@ void samplv1_wave::reset_interp (void)
 }
 
 
+// init from two neighbour (precomputed) tables.
+void samplv1_wave::reset_mix ( Shape shape, float width,
+	const samplv1_wave *wave0, const samplv1_wave *wave1, float alpha )
+{
+	m_shape = shape;
+	m_width = width;
+
+	const float *table0 = wave0->m_table;
+	const float *table1 = wave1->m_table;
+
+	for (uint32_t i = 0; i < m_nsize; ++i) {
+		const float x0 = table0[i];
+		m_table[i] = x0 + alpha * (table1[i] - x0);
+	}
+
+	reset_interp();
+}
+
+
+//-------------------------------------------------------------------------
+// samplv1_wave_bank - precomputed shape/width wave table bank (shared).
+//
+
+static samplv1_wave_bank *g_wave_bank = nullptr;
+static uint32_t g_wave_bank_refcount = 0;
+
+static std::mutex g_wave_bank_mutex;
+
+
+// ctor.
+samplv1_wave_bank::samplv1_wave_bank ( uint32_t nsize, uint16_t nover )
+	: m_nsize(nsize)
+{
+	for (uint16_t i = 0; i < NUM_SHAPES; ++i) {
+		const samplv1_wave::Shape shape = samplv1_wave::Shape(i);
+		for (uint16_t j = 0; j < NUM_WIDTHS; ++j) {
+			const float width = float(j) / float(NUM_WIDTHS - 1);
+			samplv1_wave *wave = new samplv1_wave(m_nsize, nover);
+			wave->reset(shape, width);
+			m_waves[i][j] = wave;
+		}
+	}
+}
+
+
+// dtor.
+samplv1_wave_bank::~samplv1_wave_bank (void)
+{
+	for (uint16_t i = 0; i < NUM_SHAPES; ++i) {
+		for (uint16_t j = 0; j < NUM_WIDTHS; ++j)
+			delete m_waves[i][j];
+	}
+}
+
+
+// shared instance (per process).
+samplv1_wave_bank *samplv1_wave_bank::acquire ( uint32_t nsize )
+{
+	std::lock_guard<std::mutex> lock(g_wave_bank_mutex);
+
+	if (g_wave_bank && g_wave_bank->size() != nsize)
+		return nullptr;
+
+	if (++g_wave_bank_refcount == 1)
+		g_wave_bank = new samplv1_wave_bank(nsize, 0);
+
+	return g_wave_bank;
+}
+
+
+void samplv1_wave_bank::release ( samplv1_wave_bank *bank )
+{
+	if (bank == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(g_wave_bank_mutex);
+
+	if (bank != g_wave_bank)
+		return;
+
+	if (--g_wave_bank_refcount == 0) {
+		delete g_wave_bank;
+		g_wave_bank = nullptr;
+	}
+}
+
+
+//-------------------------------------------------------------------------
+// samplv1_wave_lf - hard/non-smoothed wave table (eg. LFO).
+//
+
+// init.test (real-time safe, from the shared bank).
+void samplv1_wave_lf::reset_test ( Shape shape, float width )
+{
+	if (shape == samplv1_wave::shape() && width == samplv1_wave::width())
+		return;
+
+	if (m_bank == nullptr) {
+		samplv1_wave::reset(shape, width);
+		return;
+	}
+
+	const uint16_t nwidths = samplv1_wave_bank::NUM_WIDTHS;
+
+	float w = width;
+	if (w < 0.0f)
+		w = 0.0f;
+	else
+	if (w > 1.0f)
+		w = 1.0f;
+	w *= float(nwidths - 1);
+
+	uint16_t i0 = uint16_t(w);
+	float alpha = w - float(i0);
+
+	// random shapes are seeded by width: no blending, nearest one.
+	if (shape == Rand || shape == Noise) {
+		if (alpha >= 0.5f && i0 < nwidths - 1)
+			++i0;
+		alpha = 0.0f;
+	}
+
+	const uint16_t i1 = (i0 < nwidths - 1 ? i0 + 1 : i0);
+
+	reset_mix(shape, width,
+		m_bank->wave(shape, i0),
+		m_bank->wave(shape, i1), alpha);
+}
+
+
 // end of samplv1_wave.cpp
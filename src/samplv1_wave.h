@@ -144,6 +144,10 @@ protected:
 	void reset_normalize();
 	void reset_interp();
 
+	// init from two neighbour (precomputed) tables.
+	void reset_mix(Shape shape, float width,
+		const samplv1_wave *wave0, const samplv1_wave *wave1, float alpha);
+
 	// Hal Chamberlain's pseudo-random linear congruential method.
 	uint32_t pseudo_srand ()
 		{ return (m_srand = (m_srand * 196314165) + 907633515); }
@@ -166,6 +170,44 @@ private:
 };
 
 
+//-------------------------------------------------------------------------
+// samplv1_wave_bank - precomputed shape/width wave table bank (shared).
+//
+
+class samplv1_wave_bank
+{
+public:
+
+	// bank dimensions.
+	static const uint16_t NUM_SHAPES = samplv1_wave::Noise + 1;
+	static const uint16_t NUM_WIDTHS = 33;
+
+	// ctor.
+	samplv1_wave_bank(uint32_t nsize, uint16_t nover);
+
+	// dtor.
+	~samplv1_wave_bank();
+
+	// table size (in frames)
+	uint32_t size() const
+		{ return m_nsize; }
+
+	// table accessor.
+	const samplv1_wave *wave(samplv1_wave::Shape shape, uint16_t iwidth) const
+		{ return m_waves[shape][iwidth]; }
+
+	// shared instance (per process).
+	static samplv1_wave_bank *acquire(uint32_t nsize);
+	static void release(samplv1_wave_bank *bank);
+
+private:
+
+	uint32_t m_nsize;
+
+	samplv1_wave *m_waves[NUM_SHAPES][NUM_WIDTHS];
+};
+
+
 //-------------------------------------------------------------------------
 // samplv1_wave_lf - hard/non-smoothed wave table (eg. LFO).
 //
@@ -176,7 +218,19 @@ public:
 
 	// ctor.
 	samplv1_wave_lf(uint32_t nsize = 1024)
-		: samplv1_wave(nsize, 0) {}
+		: samplv1_wave(nsize, 0),
+			m_bank(samplv1_wave_bank::acquire(nsize)) {}
+
+	// dtor.
+	~samplv1_wave_lf()
+		{ samplv1_wave_bank::release(m_bank); }
+
+	// init.test (real-time safe, from the shared bank).
+	void reset_test(Shape shape, float width);
+
+private:
+
+	samplv1_wave_bank *m_bank;
 };
 
 
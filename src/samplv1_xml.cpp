@@ -0,0 +1,515 @@
+// samplv1_xml.cpp
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "samplv1_xml.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+//-------------------------------------------------------------------------
+// samplv1_xml::Parser - plain recursive-descent parser.
+//
+
+class samplv1_xml::Parser
+{
+public:
+
+	// ctor.
+	Parser(const char *pszData, size_t nSize)
+		: m_data(pszData), m_end(pszData + nSize) {}
+
+	// document parser.
+	bool parse(samplv1_xml& root)
+	{
+		// prolog: declaration, doctype, comments...
+		if (!skip_misc())
+			return false;
+		if (!parse_element(root, 0))
+			return false;
+		// epilog: comments only...
+		return skip_misc() && m_data == m_end;
+	}
+
+protected:
+
+	// maximum element nesting depth.
+	enum { MAX_DEPTH = 64 };
+
+	bool at_end() const
+		{ return m_data >= m_end; }
+
+	bool looking_at(const char *pszText) const
+	{
+		const size_t len = ::strlen(pszText);
+		return size_t(m_end - m_data) >= len
+			&& ::strncmp(m_data, pszText, len) == 0;
+	}
+
+	bool skip_until(const char *pszText)
+	{
+		while (!at_end() && !looking_at(pszText))
+			++m_data;
+		if (at_end())
+			return false;
+		m_data += ::strlen(pszText);
+		return true;
+	}
+
+	void skip_space()
+	{
+		while (!at_end() && ::isspace((unsigned char) *m_data))
+			++m_data;
+	}
+
+	// skip declarations, processing instructions, comments and whitespace.
+	bool skip_misc()
+	{
+		for (;;) {
+			skip_space();
+			if (looking_at("<?")) {
+				if (!skip_until("?>"))
+					return false;
+			}
+			else
+			if (looking_at("<!--")) {
+				if (!skip_until("-->"))
+					return false;
+			}
+			else
+			if (looking_at("<!DOCTYPE")) {
+				int depth = 0;
+				for ( ; !at_end(); ++m_data) {
+					if (*m_data == '[')
+						++depth;
+					else
+					if (*m_data == ']')
+						--depth;
+					else
+					if (*m_data == '>' && depth < 1)
+						break;
+				}
+				if (at_end())
+					return false;
+				++m_data;
+			}
+			else break;
+		}
+		return true;
+	}
+
+	static bool is_name_char(char ch)
+	{
+		return ::isalnum((unsigned char) ch)
+			|| ch == '_' || ch == ':' || ch == '-' || ch == '.'
+			|| (ch & 0x80);
+	}
+
+	std::string parse_name()
+	{
+		const char *start = m_data;
+		while (!at_end() && is_name_char(*m_data))
+			++m_data;
+		return std::string(start, m_data - start);
+	}
+
+	// code point to UTF-8.
+	static void append_utf8(std::string& sOut, unsigned long ch)
+	{
+		if (ch < 0x80) {
+			sOut += char(ch);
+		}
+		else
+		if (ch < 0x800) {
+			sOut += char(0xc0 | (ch >> 6));
+			sOut += char(0x80 | (ch & 0x3f));
+		}
+		else
+		if (ch < 0x10000) {
+			sOut += char(0xe0 | (ch >> 12));
+			sOut += char(0x80 | ((ch >> 6) & 0x3f));
+			sOut += char(0x80 | (ch & 0x3f));
+		}
+		else
+		if (ch < 0x110000) {
+			sOut += char(0xf0 | (ch >> 18));
+			sOut += char(0x80 | ((ch >> 12) & 0x3f));
+			sOut += char(0x80 | ((ch >> 6) & 0x3f));
+			sOut += char(0x80 | (ch & 0x3f));
+		}
+	}
+
+	// character/entity reference.
+	bool parse_reference(std::string& sOut)
+	{
+		const char *start = ++m_data;
+		while (!at_end() && *m_data != ';')
+			++m_data;
+		if (at_end())
+			return false;
+		const std::string sRef(start, m_data - start);
+		++m_data;
+		if (sRef == "lt")
+			sOut += '<';
+		else
+		if (sRef == "gt")
+			sOut += '>';
+		else
+		if (sRef == "amp")
+			sOut += '&';
+		else
+		if (sRef == "quot")
+			sOut += '"';
+		else
+		if (sRef == "apos")
+			sOut += '\'';
+		else
+		if (sRef.length() > 1 && sRef[0] == '#') {
+			const bool bHex = (sRef[1] == 'x' || sRef[1] == 'X');
+			const char *pszNum = sRef.c_str() + (bHex ? 2 : 1);
+			char *end = nullptr;
+			const unsigned long ch = ::strtoul(pszNum, &end, bHex ? 16 : 10);
+			if (end == pszNum || *end != '\0')
+				return false;
+			append_utf8(sOut, ch);
+		}
+		else return false;
+		return true;
+	}
+
+	// attribute list, up to the start tag end.
+	bool parse_attributes(samplv1_xml& elem)
+	{
+		for (;;) {
+			skip_space();
+			if (at_end())
+				return false;
+			if (*m_data == '>' || *m_data == '/')
+				return true;
+			const std::string& sName = parse_name();
+			if (sName.empty())
+				return false;
+			skip_space();
+			if (at_end() || *m_data != '=')
+				return false;
+			++m_data;
+			skip_space();
+			if (at_end() || (*m_data != '"' && *m_data != '\''))
+				return false;
+			const char quote = *m_data++;
+			std::string sValue;
+			while (!at_end() && *m_data != quote) {
+				if (*m_data == '&') {
+					if (!parse_reference(sValue))
+						return false;
+				}
+				else sValue += *m_data++;
+			}
+			if (at_end())
+				return false;
+			++m_data;
+			elem.setAttribute(sName, sValue);
+		}
+	}
+
+	// element (recursive).
+	bool parse_element(samplv1_xml& elem, int depth)
+	{
+		if (depth > MAX_DEPTH || at_end() || *m_data != '<')
+			return false;
+		++m_data;
+
+		elem.m_sTagName = parse_name();
+		if (elem.m_sTagName.empty())
+			return false;
+
+		if (!parse_attributes(elem))
+			return false;
+
+		if (*m_data == '/') {
+			++m_data;
+			if (at_end() || *m_data != '>')
+				return false;
+			++m_data;
+			return true;
+		}
+
+		++m_data;
+
+		// content...
+		std::string sText;
+		while (!at_end()) {
+			if (looking_at("</")) {
+				append_text(elem, sText);
+				m_data += 2;
+				if (parse_name() != elem.m_sTagName)
+					return false;
+				skip_space();
+				if (at_end() || *m_data != '>')
+					return false;
+				++m_data;
+				return true;
+			}
+			else
+			if (looking_at("<!--")) {
+				append_text(elem, sText);
+				if (!skip_until("-->"))
+					return false;
+			}
+			else
+			if (looking_at("<![CDATA[")) {
+				m_data += 9;
+				const char *start = m_data;
+				if (!skip_until("]]>"))
+					return false;
+				sText.append(start, m_data - start - 3);
+				// CDATA sections are never whitespace-only text...
+				elem.m_sText += sText;
+				sText.clear();
+			}
+			else
+			if (looking_at("<?")) {
+				append_text(elem, sText);
+				if (!skip_until("?>"))
+					return false;
+			}
+			else
+			if (*m_data == '<') {
+				append_text(elem, sText);
+				samplv1_xml child;
+				if (!parse_element(child, depth + 1))
+					return false;
+				elem.m_children.push_back(child);
+			}
+			else
+			if (*m_data == '&') {
+				if (!parse_reference(sText))
+					return false;
+			}
+			else sText += *m_data++;
+		}
+
+		return false;
+	}
+
+	// character data, ignoring whitespace-only runs.
+	static void append_text(samplv1_xml& elem, std::string& sText)
+	{
+		const size_t len = sText.length();
+		for (size_t i = 0; i < len; ++i) {
+			if (!::isspace((unsigned char) sText[i])) {
+				elem.m_sText += sText;
+				break;
+			}
+		}
+		sText.clear();
+	}
+
+private:
+
+	// instance variables.
+	const char *m_data;
+	const char *m_end;
+};
+
+
+//-------------------------------------------------------------------------
+// samplv1_xml - minimal XML element tree (plain reader/writer).
+//
+
+// ctor.
+samplv1_xml::samplv1_xml ( const std::string& sTagName )
+	: m_sTagName(sTagName)
+{
+}
+
+
+// attribute accessors.
+void samplv1_xml::setAttribute (
+	const std::string& sName, const std::string& sValue )
+{
+	std::vector<std::pair<std::string, std::string> >::iterator iter
+		= m_attributes.begin();
+	for ( ; iter != m_attributes.end(); ++iter) {
+		if (iter->first == sName) {
+			iter->second = sValue;
+			return;
+		}
+	}
+
+	m_attributes.push_back(std::make_pair(sName, sValue));
+}
+
+
+std::string samplv1_xml::attribute (
+	const std::string& sName, const std::string& sDefault ) const
+{
+	std::vector<std::pair<std::string, std::string> >::const_iterator iter
+		= m_attributes.begin();
+	for ( ; iter != m_attributes.end(); ++iter) {
+		if (iter->first == sName)
+			return iter->second;
+	}
+
+	return sDefault;
+}
+
+
+// character data (all descendant text, as with DOM).
+std::string samplv1_xml::text (void) const
+{
+	std::string sText(m_sText);
+
+	List::const_iterator iter = m_children.begin();
+	for ( ; iter != m_children.end(); ++iter)
+		sText += iter->text();
+
+	return sText;
+}
+
+
+// child elements.
+samplv1_xml& samplv1_xml::appendChild ( const samplv1_xml& child )
+{
+	m_children.push_back(child);
+	return m_children.back();
+}
+
+
+// document parser (this becomes the document element).
+bool samplv1_xml::setContent ( const char *pszData, size_t nSize )
+{
+	*this = samplv1_xml();
+
+	if (pszData == nullptr || nSize < 1)
+		return false;
+
+	Parser parser(pszData, nSize);
+	if (!parser.parse(*this)) {
+		*this = samplv1_xml();
+		return false;
+	}
+
+	return true;
+}
+
+
+// document writer (optional document type name).
+std::string samplv1_xml::toString ( const char *pszDocType ) const
+{
+	std::string sOut;
+
+	if (pszDocType) {
+		sOut += "<!DOCTYPE ";
+		sOut += pszDocType;
+		sOut += ">\n";
+	}
+
+	write(sOut, 0);
+
+	return sOut;
+}
+
+
+// writer implementation.
+void samplv1_xml::write ( std::string& sOut, int iIndent ) const
+{
+	sOut.append(iIndent, ' ');
+	sOut += '<';
+	sOut += m_sTagName;
+
+	std::vector<std::pair<std::string, std::string> >::const_iterator iter
+		= m_attributes.begin();
+	for ( ; iter != m_attributes.end(); ++iter) {
+		sOut += ' ';
+		sOut += iter->first;
+		sOut += "=\"";
+		sOut += escaped(iter->second, true);
+		sOut += '"';
+	}
+
+	if (m_sText.empty() && m_children.empty()) {
+		sOut += "/>\n";
+		return;
+	}
+
+	sOut += '>';
+	sOut += escaped(m_sText, false);
+
+	if (!m_children.empty()) {
+		sOut += '\n';
+		List::const_iterator child_iter = m_children.begin();
+		for ( ; child_iter != m_children.end(); ++child_iter)
+			child_iter->write(sOut, iIndent + 1);
+		sOut.append(iIndent, ' ');
+	}
+
+	sOut += "</";
+	sOut += m_sTagName;
+	sOut += ">\n";
+}
+
+
+std::string samplv1_xml::escaped ( const std::string& sText, bool bAttr )
+{
+	std::string sOut;
+
+	const size_t len = sText.length();
+	for (size_t i = 0; i < len; ++i) {
+		const char ch = sText[i];
+		switch (ch) {
+		case '<':
+			sOut += "&lt;";
+			break;
+		case '>':
+			sOut += "&gt;";
+			break;
+		case '&':
+			sOut += "&amp;";
+			break;
+		case '"':
+			if (bAttr)
+				sOut += "&quot;";
+			else
+				sOut += ch;
+			break;
+		case '\n':
+		case '\r':
+		case '\t':
+			if (bAttr) {
+				sOut += "&#";
+				sOut += std::to_string(int(ch));
+				sOut += ';';
+			}
+			else sOut += ch;
+			break;
+		default:
+			sOut += ch;
+			break;
+		}
+	}
+
+	return sOut;
+}
+
+
+// end of samplv1_xml.cpp
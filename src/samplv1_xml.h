@@ -0,0 +1,95 @@
+// samplv1_xml.h
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __samplv1_xml_h
+#define __samplv1_xml_h
+
+#include <string>
+#include <vector>
+#include <utility>
+
+
+//-------------------------------------------------------------------------
+// samplv1_xml - minimal XML element tree (plain reader/writer).
+//
+
+class samplv1_xml
+{
+public:
+
+	// ctor.
+	samplv1_xml(const std::string& sTagName = std::string());
+
+	// tag name accessors.
+	const std::string& tagName() const
+		{ return m_sTagName; }
+	bool isNull() const
+		{ return m_sTagName.empty(); }
+
+	// attribute accessors.
+	void setAttribute(const std::string& sName, const std::string& sValue);
+	std::string attribute(const std::string& sName,
+		const std::string& sDefault = std::string()) const;
+
+	// character data (all descendant text, as with DOM).
+	void setText(const std::string& sText)
+		{ m_sText = sText; }
+	std::string text() const;
+
+	// child elements.
+	typedef std::vector<samplv1_xml> List;
+
+	samplv1_xml& appendChild(const samplv1_xml& child);
+	const List& childNodes() const
+		{ return m_children; }
+
+	// document parser (this becomes the document element).
+	bool setContent(const char *pszData, size_t nSize);
+
+	// document writer (optional document type name).
+	std::string toString(const char *pszDocType = nullptr) const;
+
+protected:
+
+	// parser implementation.
+	class Parser;
+
+	// writer implementation.
+	void write(std::string& sOut, int iIndent) const;
+
+	static std::string escaped(const std::string& sText, bool bAttr);
+
+private:
+
+	// instance variables.
+	std::string m_sTagName;
+
+	std::vector<std::pair<std::string, std::string> > m_attributes;
+
+	std::string m_sText;
+
+	List m_children;
+};
+
+
+#endif	// __samplv1_xml_h
+
+// end of samplv1_xml.h
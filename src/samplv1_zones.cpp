@@ -0,0 +1,200 @@
+// samplv1_zones.cpp
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#include "samplv1_zones.h"
+
+#include "samplv1_sample.h"
+
+#include <math.h>
+
+
+// convert note to frequency (hertz, same as samplv1_freq).
+static inline float samplv1_zones_freq ( int note )
+{
+	return (440.0f / 32.0f) * ::powf(2.0f, float(note - 9) / 12.0f);
+}
+
+
+//-------------------------------------------------------------------------
+// samplv1_zones - key/velocity zone map (pooled sample tables).
+//
+
+// ctor.
+samplv1_zones::samplv1_zones ( float srate, const samplv1_epoch *epoch )
+	: m_srate(srate), m_epoch(epoch), m_map(nullptr), m_serial(0), m_serial_ack(0)
+{
+}
+
+
+// dtor.
+samplv1_zones::~samplv1_zones (void)
+{
+	cleanup(true);
+
+	delete m_map.exchange(nullptr);
+
+	std::map<std::string, samplv1_sample *>::const_iterator iter
+		= m_samples.begin();
+	for ( ; iter != m_samples.end(); ++iter)
+		delete iter->second;
+
+	m_samples.clear();
+}
+
+
+// nominal sample-rate.
+void samplv1_zones::setSampleRate ( float srate )
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_srate = srate;
+
+	std::map<std::string, samplv1_sample *>::const_iterator iter
+		= m_samples.begin();
+	for ( ; iter != m_samples.end(); ++iter) {
+		samplv1_sample *sample = iter->second;
+		sample->setSampleRate(m_srate);
+		sample->reset(sample->freq());
+	}
+}
+
+
+// pooled sample table key (same file and setup, same tables).
+std::string samplv1_zones::sample_key ( const Zone& zone )
+{
+	return zone.filename
+		+ '|' + std::to_string(zone.octaves)
+		+ '|' + std::to_string(zone.root_key);
+}
+
+
+// zone map setup (not for the real-time thread).
+void samplv1_zones::setZones ( const Zones& zones )
+{
+	// the LV2 restore and program worker threads may race in here...
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// get rid of previously retired ones, first...
+	cleanup();
+
+	// sample tables: reuse the pooled ones, load the missing...
+	std::map<std::string, samplv1_sample *> samples;
+
+	Zones::const_iterator zone_iter = zones.begin();
+	for ( ; zone_iter != zones.end(); ++zone_iter) {
+		const Zone& zone = *zone_iter;
+		if (zone.filename.empty())
+			continue;
+		const std::string& key = sample_key(zone);
+		if (samples.find(key) != samples.end())
+			continue;
+		samplv1_sample *sample = nullptr;
+		std::map<std::string, samplv1_sample *>::iterator iter
+			= m_samples.find(key);
+		if (iter != m_samples.end()) {
+			sample = iter->second;
+			m_samples.erase(iter);
+		} else {
+			sample = new samplv1_sample(m_srate, m_epoch);
+			if (!sample->open(zone.filename.c_str(),
+					samplv1_zones_freq(zone.root_key), zone.octaves)) {
+				delete sample;
+				sample = nullptr;
+			}
+		}
+		if (sample)
+			samples.insert(std::make_pair(key, sample));
+	}
+
+	// build the new zone map, per key slots...
+	Map *map = new Map;
+
+	for (int key = 0; key < MAX_KEYS; ++key) {
+		map->index[key] = map->items.size();
+		for (zone_iter = zones.begin(); zone_iter != zones.end(); ++zone_iter) {
+			const Zone& zone = *zone_iter;
+			if (key < zone.key_low || key > zone.key_high)
+				continue;
+			std::map<std::string, samplv1_sample *>::const_iterator iter
+				= samples.find(sample_key(zone));
+			if (iter == samples.end())
+				continue;
+			Slot slot;
+			slot.vel_low  = zone.vel_low;
+			slot.vel_high = zone.vel_high;
+			slot.sample   = iter->second;
+			map->items.push_back(slot);
+		}
+	}
+
+	map->index[MAX_KEYS] = map->items.size();
+
+	// publish it; an empty map is no map at all...
+	if (map->items.empty()) {
+		delete map;
+		map = nullptr;
+	}
+
+	map = m_map.exchange(map, std::memory_order_acq_rel);
+
+	// the old map and unused sample tables may still be in use,
+	// retired until the audio thread acknowledges this serial...
+	const uint32_t serial = m_serial.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+	if (map)
+		m_map_gc.push_back({map, serial});
+
+	std::map<std::string, samplv1_sample *>::const_iterator iter
+		= m_samples.begin();
+	for ( ; iter != m_samples.end(); ++iter)
+		m_sample_gc.push_back({iter->second, serial});
+
+	m_samples.swap(samples);
+	m_zones = zones;
+}
+
+
+// retired maps and samples cleanup (acknowledged by the audio thread).
+void samplv1_zones::cleanup ( bool force )
+{
+	const uint32_t serial_ack = m_serial_ack.load(std::memory_order_acquire);
+
+	std::vector<MapGc>::iterator map_iter = m_map_gc.begin();
+	while (map_iter != m_map_gc.end()) {
+		if (force || int32_t(serial_ack - map_iter->serial) >= 0) {
+			delete map_iter->map;
+			map_iter = m_map_gc.erase(map_iter);
+		}
+		else ++map_iter;
+	}
+
+	std::vector<SampleGc>::iterator sample_iter = m_sample_gc.begin();
+	while (sample_iter != m_sample_gc.end()) {
+		if (force || int32_t(serial_ack - sample_iter->serial) >= 0) {
+			delete sample_iter->sample;
+			sample_iter = m_sample_gc.erase(sample_iter);
+		}
+		else ++sample_iter;
+	}
+}
+
+
+// end of samplv1_zones.cpp
@@ -0,0 +1,205 @@
+// samplv1_zones.h
+//
+/****************************************************************************
+   Copyright (C) 2012-2020, rncbc aka Rui Nuno Capela. All rights reserved.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+*****************************************************************************/
+
+#ifndef __samplv1_zones_h
+#define __samplv1_zones_h
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <atomic>
+#include <mutex>
+
+
+// forward decls.
+class samplv1_sample;
+class samplv1_epoch;
+
+
+//-------------------------------------------------------------------------
+// samplv1_zones - key/velocity zone map (pooled sample tables).
+//
+
+class samplv1_zones
+{
+public:
+
+	// zone descriptor.
+	struct Zone
+	{
+		Zone() : key_low(0), key_high(127), vel_low(1), vel_high(127),
+			root_key(60), octaves(0) {}
+
+		uint8_t  key_low;
+		uint8_t  key_high;
+		uint8_t  vel_low;
+		uint8_t  vel_high;
+		uint8_t  root_key;
+		uint16_t octaves;
+
+		std::string filename;
+	};
+
+	typedef std::vector<Zone> Zones;
+
+	// ctor.
+	samplv1_zones(float srate = 44100.0f, const samplv1_epoch *epoch = nullptr);
+
+	// dtor.
+	~samplv1_zones();
+
+	// nominal sample-rate.
+	void setSampleRate(float srate);
+	float sampleRate() const
+		{ return m_srate; }
+
+	// zone map setup (not for the real-time thread; serialized).
+	void setZones(const Zones& zones);
+	Zones zones() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_zones;
+	}
+
+	void clear()
+		{ setZones(Zones()); }
+
+	bool isEmpty() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_zones.empty();
+	}
+
+	// zone lookup (real-time thread, at note-on).
+	samplv1_sample *find(int key, int vel) const
+	{
+		const Map *map = m_map.load(std::memory_order_acquire);
+		if (map == nullptr || key < 0 || key >= MAX_KEYS)
+			return nullptr;
+
+		const Slot *items = map->items.data();
+		const uint32_t i2 = map->index[key + 1];
+		for (uint32_t i = map->index[key]; i < i2; ++i) {
+			const Slot& slot = items[i];
+			if (vel >= slot.vel_low && vel <= slot.vel_high)
+				return slot.sample;
+		}
+
+		return nullptr;
+	}
+
+	// whether a sample is in the current zone map (real-time thread).
+	bool contains(const samplv1_sample *sample) const
+	{
+		const Map *map = m_map.load(std::memory_order_acquire);
+		if (map == nullptr || sample == nullptr)
+			return false;
+
+		std::vector<Slot>::const_iterator iter = map->items.begin();
+		for ( ; iter != map->items.end(); ++iter) {
+			if (iter->sample == sample)
+				return true;
+		}
+
+		return false;
+	}
+
+	// zone map setup serial number (bumped on each publish).
+	uint32_t serial() const
+		{ return m_serial.load(std::memory_order_acquire); }
+
+	// real-time thread: done with anything retired up to serial
+	// (no voices left playing retired samples, old maps unseen).
+	void acknowledge(uint32_t serial)
+		{ m_serial_ack.store(serial, std::memory_order_release); }
+
+	bool isAcknowledged(uint32_t serial) const
+		{ return m_serial_ack.load(std::memory_order_acquire) == serial; }
+
+protected:
+
+	// pooled sample table key.
+	static std::string sample_key(const Zone& zone);
+
+	// retired maps and samples cleanup (acknowledged ones only).
+	void cleanup(bool force = false);
+
+private:
+
+	enum { MAX_KEYS = 128 };
+
+	// zone map slot (per key).
+	struct Slot
+	{
+		uint8_t vel_low;
+		uint8_t vel_high;
+
+		samplv1_sample *sample;
+	};
+
+	// zone map (immutable, once published).
+	struct Map
+	{
+		uint32_t index[MAX_KEYS + 1];
+
+		std::vector<Slot> items;
+	};
+
+	// instance variables.
+	float m_srate;
+
+	const samplv1_epoch *m_epoch;
+
+	Zones m_zones;
+
+	std::map<std::string, samplv1_sample *> m_samples;
+
+	std::atomic<Map *> m_map;
+
+	std::atomic<uint32_t> m_serial;
+	std::atomic<uint32_t> m_serial_ack;
+
+	mutable std::mutex m_mutex;
+
+	// retired (garbage) collection, per setup serial.
+	struct MapGc
+	{
+		Map     *map;
+		uint32_t serial;
+	};
+
+	struct SampleGc
+	{
+		samplv1_sample *sample;
+		uint32_t        serial;
+	};
+
+	std::vector<MapGc> m_map_gc;
+	std::vector<SampleGc> m_sample_gc;
+};
+
+
+#endif	// __samplv1_zones_h
+
+// end of samplv1_zones.h
@@ -1239,6 +1239,13 @@ void samplv1widget::updateSample ( samplv1_sample *pSample, bool bDirty )
 }
 
 
+// Sample waveform peak summary updater.
+void samplv1widget::updateSamplePeaks ( const samplv1_peaks *pPeaks )
+{
+	m_ui.Gen1Sample->setPeaks(pPeaks);
+}
+
+
 // Sample playback (direct note-on/off).
 void samplv1widget::playSample (void)
 {
@@ -1638,7 +1645,7 @@ void samplv1widget::updateSchedNotify ( int stype, int sid )
 	case samplv1_sched::Programs: {
 		samplv1_programs *pPrograms = pSamplUi->programs();
 		samplv1_programs::Prog *pProg = pPrograms->current_prog();
-		if (pProg) updateLoadPreset(pProg->name());
+		if (pProg) updateLoadPreset(QString::fromUtf8(pProg->name().c_str()));
 		break;
 	}
 	case samplv1_sched::Sample:
@@ -36,6 +36,8 @@ namespace Ui { class samplv1widget; }
 class samplv1widget_param;
 class samplv1widget_sched;
 
+class samplv1_peaks;
+
 class QGroupBox;
 
 
@@ -137,7 +139,7 @@ protected slots:
 	void loopRangeChanged();
 
 	// Notification updater.
-	void updateSchedNotify(int stype, int sid);
+	virtual void updateSchedNotify(int stype, int sid);
 
 	// MIDI In LED timeout.
 	void midiInLedTimeout();
@@ -185,6 +187,9 @@ protected:
 	// Sample updater.
 	void updateSample(samplv1_sample *pSample, bool bDirty = false);
 
+	// Sample waveform peak summary updater.
+	void updateSamplePeaks(const samplv1_peaks *pPeaks);
+
 	// Update offset/loop range change status.
 	void updateOffsetLoop(samplv1_sample *pSample, bool bDirty = false);
 
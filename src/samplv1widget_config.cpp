@@ -27,6 +27,7 @@
 #include "samplv1_ui.h"
 
 #include "samplv1_pshifter.h"
+#include "samplv1_sample.h"
 
 #include "samplv1_controls.h"
 #include "samplv1_programs.h"
@@ -69,6 +70,15 @@ samplv1widget_config::samplv1widget_config (
 	m_ui.PitchShiftTypeComboBox->addItem(tr("RubberBand"));
 #endif
 
+	// Sample interpolation types.
+	m_ui.SampleInterpTypeComboBox->addItem(tr("Cubic (octave tables)"));
+	m_ui.SampleInterpTypeComboBox->addItem(tr("Sinc (band-limited)"));
+	m_ui.SampleInterpTypeComboBox->addItem(tr("Mip-map (decimated)"));
+
+	// Sample storage types.
+	m_ui.SampleStorageTypeComboBox->addItem(tr("Float (32bit)"));
+	m_ui.SampleStorageTypeComboBox->addItem(tr("Integer (16bit)"));
+
 	// Note names.
 	QStringList notes;
 	for (int note = 0; note < 128; ++note)
@@ -96,6 +106,8 @@ samplv1widget_config::samplv1widget_config (
 		m_ui.FrameTimeFormatComboBox->setCurrentIndex(pConfig->iFrameTimeFormat);
 		m_ui.RandomizePercentSpinBox->setValue(pConfig->fRandomizePercent);
 		m_ui.PitchShiftTypeComboBox->setCurrentIndex(pConfig->iPitchShiftType);
+		m_ui.SampleInterpTypeComboBox->setCurrentIndex(pConfig->iSampleInterpType);
+		m_ui.SampleStorageTypeComboBox->setCurrentIndex(pConfig->iSampleStorageType);
 		// Custom display options (only for no-plugin forms)...
 		resetCustomColorThemes(pConfig->sCustomColorTheme);
 		resetCustomStyleThemes(pConfig->sCustomStyleTheme);
@@ -113,6 +125,7 @@ samplv1widget_config::samplv1widget_config (
 			m_ui.ProgramsEnabledCheckBox->setEnabled(bPlugin);
 			m_ui.ProgramsPreviewCheckBox->setEnabled(!bPlugin);
 			m_ui.ProgramsEnabledCheckBox->setChecked(pPrograms->enabled());
+			m_ui.ProgramsPreloadCheckBox->setChecked(pPrograms->preload());
 		}
 		// Initialize conveniency options...
 		loadComboBoxHistory(m_ui.TuningScaleFileComboBox);
@@ -171,6 +184,9 @@ samplv1widget_config::samplv1widget_config (
 	QObject::connect(m_ui.ProgramsEnabledCheckBox,
 		SIGNAL(toggled(bool)),
 		SLOT(programsEnabled(bool)));
+	QObject::connect(m_ui.ProgramsPreloadCheckBox,
+		SIGNAL(toggled(bool)),
+		SLOT(programsChanged()));
 
 	// Custom context menu...
 	m_ui.ControlsTreeWidget->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -243,6 +259,12 @@ samplv1widget_config::samplv1widget_config (
 	QObject::connect(m_ui.PitchShiftTypeComboBox,
 		SIGNAL(activated(int)),
 		SLOT(optionsChanged()));
+	QObject::connect(m_ui.SampleInterpTypeComboBox,
+		SIGNAL(activated(int)),
+		SLOT(optionsChanged()));
+	QObject::connect(m_ui.SampleStorageTypeComboBox,
+		SIGNAL(activated(int)),
+		SLOT(optionsChanged()));
 
 	// Dialog commands...
 	QObject::connect(m_ui.DialogButtonBox,
@@ -656,6 +678,8 @@ void samplv1widget_config::stabilize (void)
 
 	pItem = m_ui.ProgramsTreeWidget->currentItem();
 	bEnabled = (m_pSamplUi && m_pSamplUi->programs() != nullptr);
+	m_ui.ProgramsPreloadCheckBox->setEnabled(
+		bEnabled && m_ui.ProgramsEnabledCheckBox->isChecked());
 	m_ui.ProgramsPreviewCheckBox->setEnabled(
 		bEnabled && m_ui.ProgramsEnabledCheckBox->isChecked());
 	m_ui.ProgramsAddBankToolButton->setEnabled(bEnabled);
@@ -701,6 +725,8 @@ void samplv1widget_config::accept (void)
 			pConfig->fTuningRefPitch = float(m_ui.TuningRefPitchSpinBox->value());
 			pConfig->sTuningScaleFile = comboBoxCurrentItem(m_ui.TuningScaleFileComboBox);
 			pConfig->sTuningKeyMapFile = comboBoxCurrentItem(m_ui.TuningKeyMapFileComboBox);
+			// Engine core reads it back from file...
+			pConfig->save();
 		} else {
 			m_pSamplUi->setTuningEnabled(
 				m_ui.TuningEnabledCheckBox->isChecked());
@@ -738,6 +764,7 @@ void samplv1widget_config::accept (void)
 		samplv1_programs *pPrograms = m_pSamplUi->programs();
 		if (pPrograms) {
 			m_ui.ProgramsTreeWidget->savePrograms(pPrograms);
+			pPrograms->preload(m_ui.ProgramsPreloadCheckBox->isChecked());
 			pConfig->savePrograms(pPrograms);
 			// Reset dirty flag.
 			m_iDirtyPrograms = 0;
@@ -767,9 +794,13 @@ void samplv1widget_config::accept (void)
 			pConfig->sCustomStyleTheme.clear();
 		const int iOldFrameTimeFormat = pConfig->iFrameTimeFormat;
 		const int iOldPitchShiftType  = pConfig->iPitchShiftType;
+		const int iOldSampleInterpType = pConfig->iSampleInterpType;
+		const int iOldSampleStorageType = pConfig->iSampleStorageType;
 		pConfig->iFrameTimeFormat  = m_ui.FrameTimeFormatComboBox->currentIndex();
 		pConfig->fRandomizePercent = float(m_ui.RandomizePercentSpinBox->value());
 		pConfig->iPitchShiftType   = m_ui.PitchShiftTypeComboBox->currentIndex();
+		pConfig->iSampleInterpType = m_ui.SampleInterpTypeComboBox->currentIndex();
+		pConfig->iSampleStorageType = m_ui.SampleStorageTypeComboBox->currentIndex();
 		int iNeedRestart = 0;
 		if (pConfig->sCustomStyleTheme != sOldCustomStyleTheme) {
 			if (pConfig->sCustomStyleTheme.isEmpty()) {
@@ -796,6 +827,16 @@ void samplv1widget_config::accept (void)
 			samplv1_pshifter::setDefaultType(
 				samplv1_pshifter::Type(pConfig->iPitchShiftType));
 		}
+		if (pConfig->iSampleInterpType != iOldSampleInterpType) {
+			++iNeedRestart;
+			samplv1_sample::setDefaultInterp(
+				samplv1_sample::Interp(pConfig->iSampleInterpType));
+		}
+		if (pConfig->iSampleStorageType != iOldSampleStorageType) {
+			++iNeedRestart;
+			samplv1_sample::setDefaultStorage(
+				samplv1_sample::Storage(pConfig->iSampleStorageType));
+		}
 		// Show restart message if needed...
  		if (iNeedRestart > 0) {
 			QMessageBox::information(this,
@@ -155,14 +155,14 @@ void samplv1widget_control::setControls (
 
 	if (m_pControls) {
 		const samplv1_controls::Map& map = m_pControls->map();
-		samplv1_controls::Map::ConstIterator iter = map.constBegin();
-		const samplv1_controls::Map::ConstIterator& iter_end
-			= map.constEnd();
+		samplv1_controls::Map::const_iterator iter = map.begin();
+		const samplv1_controls::Map::const_iterator& iter_end
+			= map.end();
 		for ( ; iter != iter_end; ++iter) {
-			const samplv1_controls::Data& data = iter.value();
+			const samplv1_controls::Data& data = iter->second;
 			if (samplv1::ParamIndex(data.index) == m_index) {
 				flags = data.flags;
-				m_key = iter.key();
+				m_key = iter->first;
 				break;
 			}
 		}
@@ -503,7 +503,7 @@ QWidget *samplv1widget_controls::ItemDelegate::createEditor ( QWidget *pParent,
 		const QModelIndex& ctype_index = index.sibling(index.row(), 1);
 		const QString& sType = ctype_index.data().toString();
 		const samplv1_controls::Type ctype
-			= samplv1_controls::typeFromText(sType);
+			= samplv1_controls::typeFromText(sType.toUtf8().constData());
 		pEditor = controlParamComboBox(ctype, pParent);
 		break;
 	}
@@ -713,13 +713,13 @@ void samplv1widget_controls::loadControls ( samplv1_controls *pControls )
 	const QIcon icon(":/images/samplv1_control.png");
 	QList<QTreeWidgetItem *> items;
 	const samplv1_controls::Map& map = pControls->map();
-	samplv1_controls::Map::ConstIterator iter = map.constBegin();
-	const samplv1_controls::Map::ConstIterator& iter_end = map.constEnd();
+	samplv1_controls::Map::const_iterator iter = map.begin();
+	const samplv1_controls::Map::const_iterator& iter_end = map.end();
 	for ( ; iter != iter_end; ++iter) {
-		const samplv1_controls::Key& key = iter.key();
+		const samplv1_controls::Key& key = iter->first;
 		const samplv1_controls::Type ctype = key.type();
 		const unsigned short channel = key.channel();
-		const samplv1_controls::Data& data = iter.value();
+		const samplv1_controls::Data& data = iter->second;
 		const samplv1::ParamIndex index = samplv1::ParamIndex(data.index);
 		QTreeWidgetItem *pItem = new QTreeWidgetItem(this);
 	//	pItem->setIcon(0, icon);
@@ -741,7 +741,7 @@ void samplv1widget_controls::loadControls ( samplv1_controls *pControls )
 
 void samplv1widget_controls::saveControls ( samplv1_controls *pControls )
 {
-	pControls->clear();
+	samplv1_controls::Map map;
 
 	const int iItemCount = QTreeWidget::topLevelItemCount();
 	for (int iItem = 0 ; iItem < iItemCount; ++iItem) {
@@ -749,15 +749,17 @@ void samplv1widget_controls::saveControls ( samplv1_controls *pControls )
 		const unsigned short channel
 			= pItem->text(0).toInt();
 		const samplv1_controls::Type ctype
-			= samplv1_controls::typeFromText(pItem->text(1));
+			= samplv1_controls::typeFromText(pItem->text(1).toUtf8().constData());
 		samplv1_controls::Key key;
 		key.status = ctype | (channel & 0x1f);
 		key.param = pItem->data(2, Qt::UserRole).toInt();
 		samplv1_controls::Data data;
 		data.index = pItem->data(3, Qt::UserRole).toInt();
 		data.flags = pItem->data(3, Qt::UserRole + 1).toInt();
-		pControls->add_control(key, data);
+		map[key] = data;
 	}
+
+	pControls->set_map(map);
 }
 
 
@@ -802,7 +804,7 @@ void samplv1widget_controls::itemChangedSlot (
 		const bool bBlockSignals = QTreeWidget::blockSignals(true);
 		const QString& sType = pItem->text(1);
 		const samplv1_controls::Type ctype
-			= samplv1_controls::typeFromText(sType);
+			= samplv1_controls::typeFromText(sType.toUtf8().constData());
 		const int iParam = pItem->data(2, Qt::UserRole).toInt();
 		pItem->setText(2, controlParamName(ctype, iParam));
 		QTreeWidget::blockSignals(bBlockSignals);
@@ -25,6 +25,23 @@
 
 #include "samplv1widget_palette.h"
 
+#include "lv2/lv2plug.in/ns/ext/atom/util.h"
+#include "lv2/lv2plug.in/ns/ext/atom/forge.h"
+
+#ifdef CONFIG_LV2_PATCH
+#include "lv2/lv2plug.in/ns/ext/patch/patch.h"
+#endif
+
+#ifndef CONFIG_LV2_ATOM_FORGE_OBJECT
+#define lv2_atom_forge_object(forge, frame, id, otype) \
+		lv2_atom_forge_blank(forge, frame, id, otype)
+#endif
+
+#ifndef CONFIG_LV2_ATOM_FORGE_KEY
+#define lv2_atom_forge_key(forge, key) \
+		lv2_atom_forge_property_head(forge, key, 0)
+#endif
+
 #include <QApplication>
 #include <QFileInfo>
 #include <QDir>
@@ -54,11 +71,49 @@
 
 // Constructor.
 samplv1widget_lv2::samplv1widget_lv2 ( samplv1_lv2 *pSampl,
-	LV2UI_Controller controller, LV2UI_Write_Function write_function )
+	LV2UI_Controller controller, LV2UI_Write_Function write_function,
+	const LV2_Feature *const *features )
 	: samplv1widget()
 {
+	// Host URID mapping, for the waveform peak summary (atom) events...
+	m_urid_map = nullptr;
+
+	for (int i = 0; features && features[i]; ++i) {
+		if (::strcmp(features[i]->URI, LV2_URID__map) == 0) {
+			m_urid_map = (LV2_URID_Map *) features[i]->data;
+			break;
+		}
+	}
+
+	if (m_urid_map) {
+		m_urids.gen1_peaks = m_urid_map->map(
+			m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_PEAKS");
+		m_urids.gen1_peaks_info = m_urid_map->map(
+			m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_PEAKS_INFO");
+		m_urids.gen1_peaks_data = m_urid_map->map(
+			m_urid_map->handle, SAMPLV1_LV2_PREFIX "GEN1_PEAKS_DATA");
+		m_urids.atom_eventTransfer = m_urid_map->map(
+			m_urid_map->handle, LV2_ATOM__eventTransfer);
+		m_urids.atom_Blank = m_urid_map->map(
+			m_urid_map->handle, LV2_ATOM__Blank);
+		m_urids.atom_Object = m_urid_map->map(
+			m_urid_map->handle, LV2_ATOM__Object);
+		m_urids.atom_Vector = m_urid_map->map(
+			m_urid_map->handle, LV2_ATOM__Vector);
+		m_urids.atom_Int = m_urid_map->map(
+			m_urid_map->handle, LV2_ATOM__Int);
+		m_urids.atom_Chunk = m_urid_map->map(
+			m_urid_map->handle, LV2_ATOM__Chunk);
+	#ifdef CONFIG_LV2_PATCH
+		m_urids.patch_Get = m_urid_map->map(
+			m_urid_map->handle, LV2_PATCH__Get);
+		m_urids.patch_property = m_urid_map->map(
+			m_urid_map->handle, LV2_PATCH__property);
+	#endif
+	}
+
 	// Check whether under a dedicated application instance...
-	QApplication *pApp = samplv1_lv2::qapp_instance();
+	QApplication *pApp = samplv1_lv2ui::qapp_instance();
 	if (pApp) {
 		// Special style paths...
 		if (QDir(CONFIG_PLUGINSDIR).exists())
@@ -80,6 +135,7 @@ samplv1widget_lv2::samplv1widget_lv2 ( samplv1_lv2 *pSampl,
 	}
 
 	// Initialize (user) interface stuff...
+	m_pSampl = pSampl;
 	m_pSamplUi = new samplv1_lv2ui(pSampl, controller, write_function);
 
 #ifdef CONFIG_LV2_UI_EXTERNAL
@@ -92,28 +148,64 @@ samplv1widget_lv2::samplv1widget_lv2 ( samplv1_lv2 *pSampl,
 	// Initialise preset stuff...
 	clearPreset();
 
+	// Hold any restored sample in sight, before the initial update...
+	if (m_pSampl)
+		m_pSampl->restore_ack(this, m_pSampl->restore_serial());
+
 	// Initial update, always...
-	updateSample(m_pSamplUi->sample());
+	samplv1_ui *pSamplUi = ui_instance();
+	updateSample(pSamplUi ? pSamplUi->sample() : nullptr);
+
+	// Without instance-access, knobs wait on the peak summary, if any...
+	if (m_pSampl == nullptr) {
+#ifdef CONFIG_LV2_PATCH
+		activateParamKnobs(m_urid_map == nullptr);
+#else
+		activateParamKnobs(true);
+#endif
+	}
 
 	//resetParamValues();
 	resetParamKnobs();
 
 	// May initialize the scheduler/work notifier.
 	openSchedNotifier();
+
+	// Ask for the current waveform peak summary.
+	peaks_request();
 }
 
 
 // Destructor.
 samplv1widget_lv2::~samplv1widget_lv2 (void)
 {
+	updateSamplePeaks(nullptr);
+
+	// Restored samples no longer in sight...
+	if (m_pSampl)
+		m_pSampl->restore_detach(this);
+
 	delete m_pSamplUi;
 }
 
 
-// Synth engine accessor.
+// Synth engine accessor (nb. none without instance-access).
 samplv1_ui *samplv1widget_lv2::ui_instance (void) const
 {
-	return m_pSamplUi;
+	return (m_pSampl ? m_pSamplUi : nullptr);
+}
+
+
+// Notification updater (restored sample acknowledgement).
+void samplv1widget_lv2::updateSchedNotify ( int stype, int sid )
+{
+	// nb. serial taken before switching over to the current sample...
+	const uint32_t serial = (m_pSampl ? m_pSampl->restore_serial() : 0);
+
+	samplv1widget::updateSchedNotify(stype, sid);
+
+	if (m_pSampl && samplv1_sched::Type(stype) == samplv1_sched::Sample)
+		m_pSampl->restore_ack(this, serial);
 }
 
 
@@ -170,6 +262,96 @@ void samplv1widget_lv2::port_event ( uint32_t port_index,
 		const float fValue = *(float *) buffer;
 		setParamValue(index, fValue);
 	}
+	else
+	if (m_urid_map && format == m_urids.atom_eventTransfer
+		&& buffer_size >= sizeof(LV2_Atom_Object)) {
+		const LV2_Atom_Object *object = (const LV2_Atom_Object *) buffer;
+		if ((object->atom.type == m_urids.atom_Object ||
+			 object->atom.type == m_urids.atom_Blank) &&
+			object->body.otype == m_urids.gen1_peaks)
+			peaks_event(object);
+	}
+}
+
+
+// Waveform peak summary request (patch:Get).
+void samplv1widget_lv2::peaks_request (void)
+{
+#ifdef CONFIG_LV2_PATCH
+	if (m_urid_map == nullptr)
+		return;
+
+	uint8_t buffer[128];
+
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, m_urid_map);
+	lv2_atom_forge_set_buffer(&forge, buffer, sizeof(buffer));
+
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_object(&forge, &frame, 0, m_urids.patch_Get);
+	lv2_atom_forge_key(&forge, m_urids.patch_property);
+	lv2_atom_forge_urid(&forge, m_urids.gen1_peaks);
+	lv2_atom_forge_pop(&forge, &frame);
+
+	const LV2_Atom *atom = (const LV2_Atom *) buffer;
+	m_pSamplUi->write_function(samplv1_lv2::MidiIn,
+		lv2_atom_total_size(atom), m_urids.atom_eventTransfer, atom);
+#endif
+}
+
+
+// Waveform peak summary event (one chunk at a time).
+bool samplv1widget_lv2::peaks_event ( const LV2_Atom_Object *object )
+{
+	const LV2_Atom_Vector *info = nullptr;
+	const LV2_Atom *data = nullptr;
+
+	lv2_atom_object_get(object,
+		m_urids.gen1_peaks_info, (const LV2_Atom *) &info,
+		m_urids.gen1_peaks_data, &data, 0);
+
+	if (info == nullptr
+		|| info->atom.type != m_urids.atom_Vector
+		|| info->body.child_type != m_urids.atom_Int
+		|| info->body.child_size != sizeof(int32_t)
+		|| info->atom.size < sizeof(LV2_Atom_Vector_Body) + 5 * sizeof(int32_t))
+		return false;
+
+	const int32_t *values = (const int32_t *) (info + 1);
+	const uint32_t serial   = uint32_t(values[0]);
+	const uint16_t channels = uint16_t(values[1]);
+	const uint32_t frames   = uint32_t(values[2]);
+	const uint16_t level    = uint16_t(values[3]);
+	const uint32_t offset   = uint32_t(values[4]);
+
+	bool bUpdate = false;
+
+	// A brand new summary (sample changed)?
+	if (serial != m_peaks.serial()
+		|| channels != m_peaks.channels()
+		|| frames != m_peaks.frames()) {
+		m_peaks.reset(channels, frames, serial);
+		bUpdate = true;
+	}
+
+	// Assemble one chunk; refresh whenever a level gets complete...
+	if (data && data->type == m_urids.atom_Chunk && channels > 0) {
+		const uint32_t nbins = data->size / (channels << 1);
+		const bool bComplete = m_peaks.isComplete(level);
+		if (m_peaks.setChunk(level, offset,
+				(const int8_t *) LV2_ATOM_BODY_CONST(data), nbins)
+			&& !bComplete && m_peaks.isComplete(level))
+			bUpdate = true;
+	}
+
+	if (bUpdate) {
+		updateSamplePeaks(&m_peaks);
+		// Without instance-access, the summary tells of a loaded sample...
+		if (m_pSampl == nullptr)
+			activateParamKnobs(!m_peaks.isEmpty());
+	}
+
+	return true;
 }
 
 
@@ -24,6 +24,10 @@
 
 #include "samplv1widget.h"
 #include "samplv1_lv2ui.h"
+#include "samplv1_peaks.h"
+
+#include "lv2/lv2plug.in/ns/ext/urid/urid.h"
+#include "lv2/lv2plug.in/ns/ext/atom/atom.h"
 
 
 //-------------------------------------------------------------------------
@@ -36,7 +40,8 @@ public:
 
 	// Constructor.
 	samplv1widget_lv2(samplv1_lv2 *pSampl,
-		LV2UI_Controller controller, LV2UI_Write_Function write_function);
+		LV2UI_Controller controller, LV2UI_Write_Function write_function,
+		const LV2_Feature *const *features);
 
 	// Destructor.
 	~samplv1widget_lv2();
@@ -62,14 +67,43 @@ protected:
 	// Param methods.
 	void updateParam(samplv1::ParamIndex index, float fValue) const;
 
+	// Notification updater (restored sample acknowledgement).
+	void updateSchedNotify(int stype, int sid);
+
 	// Close event handler.
 	void closeEvent(QCloseEvent *pCloseEvent);
 
+	// Waveform peak summary request/event handlers.
+	void peaks_request();
+	bool peaks_event(const LV2_Atom_Object *object);
+
 private:
 
 	// Instance variables.
+	samplv1_lv2   *m_pSampl;
 	samplv1_lv2ui *m_pSamplUi;
 
+	LV2_URID_Map *m_urid_map;
+
+	struct lv2_urids
+	{
+		LV2_URID gen1_peaks;
+		LV2_URID gen1_peaks_info;
+		LV2_URID gen1_peaks_data;
+		LV2_URID atom_eventTransfer;
+		LV2_URID atom_Blank;
+		LV2_URID atom_Object;
+		LV2_URID atom_Vector;
+		LV2_URID atom_Int;
+		LV2_URID atom_Chunk;
+		LV2_URID patch_Get;
+		LV2_URID patch_property;
+
+	} m_urids;
+
+	// Waveform peak summary (as received).
+	samplv1_peaks m_peaks;
+
 #ifdef CONFIG_LV2_UI_EXTERNAL
 	LV2_External_UI_Host *m_external_host;
 #endif
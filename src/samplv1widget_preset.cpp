@@ -22,6 +22,7 @@
 #include "samplv1widget_preset.h"
 
 #include "samplv1_config.h"
+#include "samplv1_param.h"
 
 #include <QHBoxLayout>
 
@@ -235,7 +236,8 @@ void samplv1widget_preset::openPreset (void)
 
 	const QString  sExt(SAMPLV1_TITLE);
 	const QString& sTitle  = tr("Open Preset");
-	const QString& sFilter = tr("Preset files (*.%1)").arg(sExt);
+	const QString& sFilter = tr("Preset files (*.%1 *.%2)")
+		.arg(sExt).arg(SAMPLV1_PRESET_BIN_EXT);
 
 	QWidget *pParentWidget = nullptr;
 	QFileDialog::Options options;
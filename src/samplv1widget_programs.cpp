@@ -267,25 +267,25 @@ void samplv1widget_programs::loadPrograms ( samplv1_programs *pPrograms )
 	QList<QTreeWidgetItem *> items;
 	QTreeWidgetItem *pCurrentItem = nullptr;
 	const samplv1_programs::Banks& banks = pPrograms->banks();
-	samplv1_programs::Banks::ConstIterator bank_iter = banks.constBegin();
-	const samplv1_programs::Banks::ConstIterator& bank_end = banks.constEnd();
+	samplv1_programs::Banks::const_iterator bank_iter = banks.begin();
+	const samplv1_programs::Banks::const_iterator& bank_end = banks.end();
 	for ( ; bank_iter != bank_end; ++bank_iter) {
-		samplv1_programs::Bank *pBank = bank_iter.value();
+		samplv1_programs::Bank *pBank = bank_iter->second;
 		QTreeWidgetItem *pBankItem = new QTreeWidgetItem(this);
 		pBankItem->setIcon(0, QIcon(":/images/presetBankOpen.png"));
 		pBankItem->setText(0, QString::number(pBank->id()));
-		pBankItem->setText(1, pBank->name());
+		pBankItem->setText(1, QString::fromUtf8(pBank->name().c_str()));
 		pBankItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsEditable);
 		pBankItem->setData(0, Qt::UserRole, pBank->id());
 		const samplv1_programs::Progs& progs = pBank->progs();
-		samplv1_programs::Progs::ConstIterator prog_iter = progs.constBegin();
-		const samplv1_programs::Progs::ConstIterator& prog_end = progs.constEnd();
+		samplv1_programs::Progs::const_iterator prog_iter = progs.begin();
+		const samplv1_programs::Progs::const_iterator& prog_end = progs.end();
 		for ( ; prog_iter != prog_end; ++prog_iter) {
-			samplv1_programs::Prog *pProg = prog_iter.value();
+			samplv1_programs::Prog *pProg = prog_iter->second;
 			QTreeWidgetItem *pProgItem = new QTreeWidgetItem(pBankItem);
 			pProgItem->setIcon(1, QIcon(":/images/samplv1_preset.png"));
 			pProgItem->setText(0, QString::number(pProg->id()) + " =");
-			pProgItem->setText(1, pProg->name());
+			pProgItem->setText(1, QString::fromUtf8(pProg->name().c_str()));
 			pProgItem->setFlags(
 				Qt::ItemIsEnabled | Qt::ItemIsEditable | Qt::ItemIsSelectable);
 			pProgItem->setData(0, Qt::TextAlignmentRole,
@@ -313,13 +313,14 @@ void samplv1widget_programs::savePrograms ( samplv1_programs *pPrograms )
 		QTreeWidgetItem *pBankItem = QTreeWidget::topLevelItem(iBank);
 		uint16_t bank_id = pBankItem->data(0, Qt::UserRole).toInt();
 		const QString& bank_name = pBankItem->text(1).simplified();
-		samplv1_programs::Bank *pBank = pPrograms->add_bank(bank_id, bank_name);
+		samplv1_programs::Bank *pBank = pPrograms->add_bank(
+			bank_id, bank_name.toUtf8().constData());
 		const int iProgCount = pBankItem->childCount();
 		for (int iProg = 0 ; iProg < iProgCount; ++iProg) {
 			QTreeWidgetItem *pProgItem = pBankItem->child(iProg);
 			uint16_t prog_id = pProgItem->data(0, Qt::UserRole).toInt();
 			const QString& prog_name = pProgItem->text(1).simplified();
-			pBank->add_prog(prog_id, prog_name);
+			pBank->add_prog(prog_id, prog_name.toUtf8().constData());
 		}
 	}
 }
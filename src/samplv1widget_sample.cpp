@@ -23,6 +23,7 @@
 
 #include "samplv1_config.h"
 #include "samplv1_sample.h"
+#include "samplv1_peaks.h"
 
 #include "samplv1_ui.h"
 
@@ -40,6 +41,7 @@
 #include <QTimer>
 
 #include <QMouseEvent>
+#include <QWheelEvent>
 #include <QDragEnterEvent>
 #include <QDropEvent>
 
@@ -52,7 +54,8 @@
 // Constructor.
 samplv1widget_sample::samplv1widget_sample ( QWidget *pParent )
 	: QFrame(pParent), m_pSamplUi(nullptr),
-		m_pSample(nullptr), m_iChannels(0), m_ppPolyg(nullptr)
+		m_pSample(nullptr), m_pPeaks(nullptr),
+		m_iChannels(0), m_ppPolyg(nullptr)
 {
 	QFrame::setMouseTracking(true);
 	QFrame::setFocusPolicy(Qt::ClickFocus);
@@ -77,6 +80,9 @@ samplv1widget_sample::samplv1widget_sample ( QWidget *pParent )
 
 	m_iDirectNoteOn = -1;
 
+	m_iViewStart = m_iViewLength = 0;
+	m_iViewFrames = 0;
+
 	resetDragState();
 }
 
@@ -104,12 +110,11 @@ samplv1_ui *samplv1widget_sample::instance (void) const
 // Parameter accessors.
 void samplv1widget_sample::setSample ( samplv1_sample *pSample )
 {
-	if (m_pSample && m_ppPolyg) {
-		for (unsigned short k = 0; k < m_iChannels; ++k)
-			delete m_ppPolyg[k];
-		delete [] m_ppPolyg;
-		m_ppPolyg = 0;
-		m_iChannels = 0;
+	// Reset view whenever a different sample shows up...
+	const uint32_t nframes = (pSample ? pSample->length() : 0);
+	if (m_pSample != pSample || m_iViewFrames != nframes) {
+		m_iViewStart = m_iViewLength = 0;
+		m_iViewFrames = nframes;
 	}
 
 	m_pSample = pSample;
@@ -122,50 +127,66 @@ void samplv1widget_sample::setSample ( samplv1_sample *pSample )
 
 	m_pDragSample = nullptr;
 
+	updatePolyg();
+	updateToolTip();
+	update();
+}
+
+
+// Waveform polygons (re)builder.
+void samplv1widget_sample::updatePolyg (void)
+{
+	if (m_ppPolyg) {
+		for (unsigned short k = 0; k < m_iChannels; ++k)
+			delete m_ppPolyg[k];
+		delete [] m_ppPolyg;
+		m_ppPolyg = nullptr;
+		m_iChannels = 0;
+	}
+
+	const int w = width() & 0x7ffe; // force even.
+	const int w2 = (w >> 1);
+	const uint32_t iViewStart = viewStart();
+	const uint64_t iViewLength = viewLength();
+
+	// Peak summary, only whenever the sample frames are out of reach...
+	const samplv1_peaks *pPeaks = m_pPeaks;
+	if (pPeaks && (m_pSample || pPeaks->isEmpty()))
+		pPeaks = nullptr;
+
+	if (pPeaks)
+		m_iChannels = pPeaks->channels();
+	else
 	if (m_pSample)
 		m_iChannels = m_pSample->channels();
-	if (m_iChannels > 0 && m_ppPolyg == 0) {
+	if (m_iChannels > 0 && m_ppPolyg == nullptr) {
 		const int h = height();
-		const int w = width() & 0x7ffe; // force even.
-		const int w2 = (w >> 1);
-		const uint32_t nframes = m_pSample->length();
-		const uint32_t nperiod = nframes / w2;
 		const int h0 = h / m_iChannels;
 		const int h1 = (h0 >> 1);
 		int y0 = h1;
 		m_ppPolyg = new QPolygon* [m_iChannels];
 		for (uint16_t k = 0; k < m_iChannels; ++k) {
 			m_ppPolyg[k] = new QPolygon(w);
-			const float *pframes = m_pSample->frames(k);
-			float vmax = 0.0f;
-			float vmin = 0.0f;
-			int n = 0;
+			// One min/max peak pair per 2-pixel column...
+			uint32_t i1 = iViewStart;
 			int x = 1;
-			uint32_t j = 0;
-			for (uint32_t i = 0; i < nframes; ++i) {
-				const float v = *pframes++;
-				if (vmax < v || j == 0)
-					vmax = v;
-				if (vmin > v || j == 0)
-					vmin = v;
-				if (++j > nperiod) {
-					m_ppPolyg[k]->setPoint(n, x, y0 - int(vmax * h1));
-					m_ppPolyg[k]->setPoint(w - n - 1, x, y0 - int(vmin * h1));
-					vmax = vmin = 0.0f;
-					++n; x += 2; j = 0;
-				}
-			}
-			while (n < w2) {
-				m_ppPolyg[k]->setPoint(n, x, y0);
-				m_ppPolyg[k]->setPoint(w - n - 1, x, y0);
-				++n; x += 2;
+			for (int n = 0; n < w2; ++n) {
+				const uint32_t i2 = iViewStart
+					+ uint32_t((iViewLength * uint64_t(n + 1)) / uint64_t(w2));
+				float vmax = 0.0f;
+				float vmin = 0.0f;
+				if (pPeaks)
+					pPeaks->peak(k, i1, i2, vmin, vmax);
+				else
+					m_pSample->peak(k, i1, i2, vmin, vmax);
+				m_ppPolyg[k]->setPoint(n, x, y0 - int(vmax * h1));
+				m_ppPolyg[k]->setPoint(w - n - 1, x, y0 - int(vmin * h1));
+				i1 = i2;
+				x += 2;
 			}
 			y0 += h0;
 		}
 	}
-
-	updateToolTip();
-	update();
 }
 
 
@@ -175,6 +196,43 @@ samplv1_sample *samplv1widget_sample::sample (void) const
 }
 
 
+// Waveform peak summary (eg. out-of-process).
+void samplv1widget_sample::setPeaks ( const samplv1_peaks *pPeaks )
+{
+	// Reset view whenever a different waveform shows up...
+	if (m_pSample == nullptr) {
+		const uint32_t nframes = (pPeaks ? pPeaks->frames() : 0);
+		if (m_iViewFrames != nframes) {
+			m_iViewStart = m_iViewLength = 0;
+			m_iViewFrames = nframes;
+		}
+	}
+
+	m_pPeaks = pPeaks;
+
+	updatePolyg();
+	update();
+}
+
+const samplv1_peaks *samplv1widget_sample::peaks (void) const
+{
+	return m_pPeaks;
+}
+
+
+// Sample length (frames), either from sample or peaks.
+uint32_t samplv1widget_sample::frames (void) const
+{
+	if (m_pSample)
+		return m_pSample->length();
+	else
+	if (m_pPeaks)
+		return m_pPeaks->frames();
+	else
+		return 0;
+}
+
+
 void samplv1widget_sample::setSampleName ( const QString& sName )
 {
 	m_sName = sName;
@@ -274,35 +332,118 @@ uint32_t samplv1widget_sample::loopEnd (void) const
 }
 
 
+// View (zoom/scroll) window, in frames.
+void samplv1widget_sample::setView ( uint32_t iViewStart, uint32_t iViewLength )
+{
+	const uint32_t nframes = frames();
+	const uint32_t nmin = (QFrame::width() >> 3) + 1;
+
+	if (iViewLength < nmin)
+		iViewLength = nmin;
+	if (iViewLength >= nframes) {
+		// Whole sample in view...
+		iViewStart = iViewLength = 0;
+	}
+	else
+	if (iViewStart > nframes - iViewLength)
+		iViewStart = nframes - iViewLength;
+
+	if (m_iViewStart == iViewStart && m_iViewLength == iViewLength)
+		return;
+
+	m_iViewStart  = iViewStart;
+	m_iViewLength = iViewLength;
+
+	updatePolyg();
+	update();
+}
+
+
+uint32_t samplv1widget_sample::viewStart (void) const
+{
+	return m_iViewStart;
+}
+
+
+uint32_t samplv1widget_sample::viewLength (void) const
+{
+	if (m_iViewLength > 0)
+		return m_iViewLength;
+	else
+		return frames();
+}
+
+
+// Zoom in/out (around a given pixel), reset.
+void samplv1widget_sample::zoomIn ( int x )
+{
+	const int w = QFrame::width();
+	if (frames() < 1 || w < 1)
+		return;
+
+	const uint32_t n = framesFromPixel(x);
+	const uint32_t iViewLength = (viewLength() >> 1);
+	const uint32_t dn = (uint64_t(x) * uint64_t(iViewLength)) / uint64_t(w);
+	setView(n > dn ? n - dn : 0, iViewLength);
+}
+
+
+void samplv1widget_sample::zoomOut ( int x )
+{
+	const int w = QFrame::width();
+	if (frames() < 1 || w < 1 || m_iViewLength == 0)
+		return;
+
+	const uint32_t n = framesFromPixel(x);
+	const uint64_t iViewLength = (uint64_t(viewLength()) << 1);
+	if (iViewLength >= frames()) {
+		zoomReset();
+		return;
+	}
+	const uint32_t dn = (uint64_t(x) * iViewLength) / uint64_t(w);
+	setView(n > dn ? n - dn : 0, uint32_t(iViewLength));
+}
+
+
+void samplv1widget_sample::zoomReset (void)
+{
+	setView(0, 0);
+}
+
+
 // Sanitizer helper.
 int samplv1widget_sample::safeX ( int x ) const
 {
 	const int w = QFrame::width();
-	return (x < w ? x : w);
+	return (x < 0 ? 0 : (x < w ? x : w));
 }
 
 
-// Sanitized converters.
+// Sanitized converters (view relative).
 int samplv1widget_sample::pixelFromFrames ( uint32_t n ) const
 {
-	const uint32_t nframes = m_pSample->length();
+	const uint32_t nframes = viewLength();
 	if (nframes == 0)
 		return 0;
 
+	// Out of view points are kept just off the edges...
 	const int w = QFrame::width();
-	const int x = (uint64_t(w) * uint64_t(n)) / uint64_t(nframes);
-	return (x < w ? x : w);
+	if (n < m_iViewStart)
+		return -1;
+	const int x = (uint64_t(w) * uint64_t(n - m_iViewStart)) / uint64_t(nframes);
+	return (x < w ? x : w + 1);
 }
 
 
 uint32_t samplv1widget_sample::framesFromPixel ( int x ) const
 {
 	const int w = QFrame::width();
-	if (w == 0)
-		return 0;
+	if (w == 0 || x < 0)
+		return m_iViewStart;
 
-	const uint32_t nframes = m_pSample->length();
-	const uint32_t n = (uint64_t(x) * uint64_t(nframes)) / uint64_t(w);
+	const uint32_t nframes = frames();
+	const uint32_t n = m_iViewStart
+		+ uint32_t((uint64_t(x) * uint64_t(viewLength())) / uint64_t(w));
 	return (n < nframes ? n : nframes);
 }
 
@@ -310,7 +451,7 @@ uint32_t samplv1widget_sample::framesFromPixel ( int x ) const
 // Widget resize handler.
 void samplv1widget_sample::resizeEvent ( QResizeEvent * )
 {
-	setSample(m_pSample);	// reset polygon...
+	updatePolyg();	// reset polygon...
 }
 
 
@@ -615,7 +756,40 @@ void samplv1widget_sample::mouseDoubleClickEvent ( QMouseEvent */*pMouseEvent*/
 }
 
 
-// Trap for escape key.
+// Mouse wheel zoom (w/ Ctrl) or scroll (when zoomed in).
+void samplv1widget_sample::wheelEvent ( QWheelEvent *pWheelEvent )
+{
+	const int delta = (pWheelEvent->angleDelta().y() / 120);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+	const int x = int(pWheelEvent->position().x());
+#else
+	const int x = pWheelEvent->pos().x();
+#endif
+
+	if (m_pSample == nullptr || delta == 0) {
+		QFrame::wheelEvent(pWheelEvent);
+		return;
+	}
+
+	if (pWheelEvent->modifiers() & Qt::ControlModifier) {
+		if (delta > 0)
+			zoomIn(x);
+		else
+			zoomOut(x);
+	}
+	else
+	if (m_iViewLength > 0) {
+		const int64_t dn = int64_t(m_iViewLength >> 3) * delta;
+		int64_t iViewStart = int64_t(m_iViewStart) - dn;
+		if (iViewStart < 0)
+			iViewStart = 0;
+		setView(uint32_t(iViewStart), m_iViewLength);
+	}
+	else QFrame::wheelEvent(pWheelEvent);
+}
+
+
+// Trap for escape key (and zoom keys).
 void samplv1widget_sample::keyPressEvent ( QKeyEvent *pKeyEvent )
 {
 	switch (pKeyEvent->key()) {
@@ -624,6 +798,16 @@ void samplv1widget_sample::keyPressEvent ( QKeyEvent *pKeyEvent )
 		resetDragState();
 		update();
 		break;
+	case Qt::Key_Plus:
+	case Qt::Key_Equal:
+		zoomIn(QFrame::width() >> 1);
+		break;
+	case Qt::Key_Minus:
+		zoomOut(QFrame::width() >> 1);
+		break;
+	case Qt::Key_0:
+		zoomReset();
+		break;
 	default:
 		QFrame::keyPressEvent(pKeyEvent);
 		break;
@@ -688,7 +872,7 @@ void samplv1widget_sample::paintEvent ( QPaintEvent *pPaintEvent )
 
     painter.fillRect(rect, rgbDark);
 
-	if (m_pSample && m_ppPolyg) {
+	if (m_ppPolyg) {
 		const bool bEnabled = isEnabled();
 		const int w2 = (w << 1);
 		painter.setRenderHint(QPainter::Antialiasing, true);
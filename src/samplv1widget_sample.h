@@ -30,9 +30,11 @@
 // Forward decl.
 class samplv1_ui;
 class samplv1_sample;
+class samplv1_peaks;
 
 class QDragEnterEvent;
 class QDropEvent;
+class QWheelEvent;
 
 
 //----------------------------------------------------------------------------
@@ -57,6 +59,10 @@ public:
 	void setSample(samplv1_sample *pSample);
 	samplv1_sample *sample() const;
 
+	// Waveform peak summary (eg. out-of-process).
+	void setPeaks(const samplv1_peaks *pPeaks);
+	const samplv1_peaks *peaks() const;
+
 	void setSampleName(const QString& sName);
 	const QString& sampleName() const;
 
@@ -76,6 +82,16 @@ public:
 	uint32_t loopStart() const;
 	uint32_t loopEnd() const;
 
+	// View (zoom/scroll) window, in frames.
+	void setView(uint32_t iViewStart, uint32_t iViewLength);
+	uint32_t viewStart() const;
+	uint32_t viewLength() const;
+
+	// Zoom in/out (around a given pixel), reset.
+	void zoomIn(int x);
+	void zoomOut(int x);
+	void zoomReset();
+
 	// Direct note-on methods.
 	void directNoteOn();
 
@@ -122,6 +138,12 @@ protected:
 	int pixelFromFrames(uint32_t n) const;
 	uint32_t framesFromPixel(int x) const;
 
+	// Sample length (frames), either from sample or peaks.
+	uint32_t frames() const;
+
+	// Waveform polygons (re)builder.
+	void updatePolyg();
+
 	// Widget resize handler.
 	void resizeEvent(QResizeEvent *);
 
@@ -135,6 +157,9 @@ protected:
 
 	void mouseDoubleClickEvent(QMouseEvent *pMouseEvent);
 
+	// Mouse wheel zoom/scroll.
+	void wheelEvent(QWheelEvent *pWheelEvent);
+
 	// Trap for escape key.
 	void keyPressEvent(QKeyEvent *pKeyEvent);
 
@@ -157,11 +182,17 @@ private:
 	samplv1_ui *m_pSamplUi;
 
 	samplv1_sample *m_pSample;
+	const samplv1_peaks *m_pPeaks;
 	unsigned short m_iChannels;
 	QPolygon **m_ppPolyg;
 
 	QString m_sName;
 
+	// View (zoom/scroll) state.
+	uint32_t m_iViewStart;
+	uint32_t m_iViewLength;
+	uint32_t m_iViewFrames;
+
 	// Drag state.
 	enum DragState {
 		DragNone = 0, DragStart,
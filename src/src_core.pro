@@ -2,7 +2,7 @@
 #
 NAME = samplv1
 
-TARGET = $${NAME}
+TARGET = $${NAME}_core
 TEMPLATE = lib
 CONFIG += static
 
@@ -11,12 +11,14 @@ include(src_core.pri)
 HEADERS = \
 	config.h \
 	samplv1.h \
-	samplv1_config.h \
+	samplv1_ini.h \
+	samplv1_xml.h \
 	samplv1_filter.h \
 	samplv1_formant.h \
 	samplv1_pshifter.h \
 	samplv1_resampler.h \
 	samplv1_sample.h \
+	samplv1_peaks.h \
 	samplv1_wave.h \
 	samplv1_ramp.h \
 	samplv1_list.h \
@@ -24,23 +26,28 @@ HEADERS = \
 	samplv1_reverb.h \
 	samplv1_param.h \
 	samplv1_sched.h \
+	samplv1_epoch.h \
 	samplv1_tuning.h \
 	samplv1_programs.h \
-	samplv1_controls.h
+	samplv1_controls.h \
+	samplv1_zones.h
 
 SOURCES = \
 	samplv1.cpp \
-	samplv1_config.cpp \
+	samplv1_ini.cpp \
+	samplv1_xml.cpp \
 	samplv1_formant.cpp \
 	samplv1_pshifter.cpp \
 	samplv1_resampler.cpp \
 	samplv1_sample.cpp \
+	samplv1_peaks.cpp \
 	samplv1_wave.cpp \
 	samplv1_param.cpp \
 	samplv1_sched.cpp \
 	samplv1_tuning.cpp \
 	samplv1_programs.cpp \
-	samplv1_controls.cpp
+	samplv1_controls.cpp \
+	samplv1_zones.cpp
 
 
 unix {
@@ -50,5 +57,4 @@ unix {
 	UI_DIR      = .ui_core
 }
 
-QT -= gui
-QT += xml
+CONFIG -= qt
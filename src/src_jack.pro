@@ -6,8 +6,8 @@ TARGET = $${NAME}_jack
 TEMPLATE = app
 
 unix {
-	LIBS += -L. -l$${NAME} -l$${NAME}_ui
-	PRE_TARGETDEPS += lib$${NAME}.a lib$${NAME}_ui.a
+	LIBS += -L. -l$${NAME}_core -l$${NAME}_ui
+	PRE_TARGETDEPS += lib$${NAME}_core.a lib$${NAME}_ui.a
 }
 
 include(src_jack.pri)
@@ -82,4 +82,4 @@ unix {
 	CONFIG(release, debug|release):QMAKE_POST_LINK += strip $(TARGET)
 }
 
-QT += widgets xml
+QT += widgets
@@ -7,8 +7,8 @@ TEMPLATE = lib
 CONFIG += shared plugin
 
 unix {
-	LIBS += -L. -l$${NAME} -l$${NAME}_ui
-	PRE_TARGETDEPS += lib$${NAME}.a lib$${NAME}_ui.a
+	LIBS += -L. -l$${NAME}_core -l$${NAME}_ui
+	PRE_TARGETDEPS += lib$${NAME}_core.a lib$${NAME}_ui.a
 }
 
 include(src_lv2.pri)
@@ -72,5 +72,5 @@ unix {
 	QMAKE_CLEAN += $${TARGET_LV2}.so
 }
 
-QT += widgets xml
+QT += widgets
 
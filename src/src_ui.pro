@@ -7,14 +7,15 @@ TEMPLATE = lib
 CONFIG += static
 
 unix { 
-	LIBS += -L. -l$${NAME}
-	PRE_TARGETDEPS += lib$${NAME}.a
+	LIBS += -L. -l$${NAME}_core
+	PRE_TARGETDEPS += lib$${NAME}_core.a
 }
 
 include(src_ui.pri)
 
 HEADERS = \
 	config.h \
+	samplv1_config.h \
 	samplv1_ui.h \
 	samplv1widget.h \
 	samplv1widget_env.h \
@@ -33,6 +34,7 @@ HEADERS = \
 	samplv1widget_config.h
 
 SOURCES = \
+	samplv1_config.cpp \
 	samplv1_ui.cpp \
 	samplv1widget.cpp \
 	samplv1widget_env.cpp \
@@ -66,4 +68,4 @@ unix {
 	UI_DIR      = .ui_ui
 }
 
-QT += widgets xml
+QT += widgets